@@ -37,6 +37,25 @@
 #include "ns3/netanim-module.h"
 #include "ns3/propagation-loss-model.h"
 
+#include "urbano-attach-scheduler.h"
+#include "urbano-batched-mobility.h"
+#include "urbano-event-profiler.h"
+#include "urbano-flow-export.h"
+#include "urbano-flow-sampling.h"
+#include "urbano-interference-pruning.h"
+#include "urbano-kpi-recorder.h"
+#include "urbano-mpi-partition.h"
+#include "urbano-multiflow-apps.h"
+#include "urbano-phase-profiler.h"
+#include "urbano-sequential-stop.h"
+#include "urbano-propagation-loss.h"
+#include "urbano-shadowing-map.h"
+#include "urbano-spatial-index.h"
+#include "urbano-topology-builder.h"
+#include "urbano-traffic-mix.h"
+#include "urbano-warmup.h"
+#include "urbano-wrap-around.h"
+
 
 
 using namespace ns3;
@@ -60,6 +79,17 @@ std::vector<Vector> MakeHexGrid(uint32_t rows, uint32_t cols, double isd, double
     return pos;
 }
 
+// ---------- largura de banda (Hz) -> número de RBs LTE ----------
+uint16_t LteBandwidthToRb(double bandwidth)
+{
+    if (bandwidth <= 1.4e6) return 6;
+    if (bandwidth <= 3e6)   return 15;
+    if (bandwidth <= 5e6)   return 25;
+    if (bandwidth <= 10e6)  return 50;
+    if (bandwidth <= 15e6)  return 75;
+    return 100;
+}
+
 // ---------- gera 3 setores por site ----------
 void CreateTriSectorEnbs( Ptr<LteHelper> lte,
                           NodeContainer &sites,
@@ -97,14 +127,172 @@ void CreateTriSectorEnbs( Ptr<LteHelper> lte,
     }
 }
 
+// ---------- 3 setores por site, em lote (ver urbano-topology-builder.h) ----------
+// antena configurada uma vez por azimute e setores instalados em 3 grupos
+void CreateTriSectorEnbsBulk( Ptr<LteHelper> lte,
+                              NodeContainer &sites,
+                              NodeContainer &sectors,
+                              NetDeviceContainer &enbDevs )
+{
+    Config::SetDefault("ns3::ParabolicAntennaModel::Beamwidth", DoubleValue(70.0));
+
+    TriSectorLayout layout = MakeTriSectorLayout(GetPositions(sites), 0.0);
+    NodeContainer created;
+    created.Create(layout.positions.size());
+    InstallConstantPositions(created, layout.positions);
+    sectors.Add(created);
+
+    lte->SetEnbAntennaModelType("ns3::ParabolicAntennaModel");
+    enbDevs.Add(InstallGrouped(created, layout.sector,
+        [&](uint32_t s){ lte->SetEnbAntennaModelAttribute("Orientation", DoubleValue(120.0 * s)); },
+        [&](const NodeContainer &n){ return lte->InstallEnbDevice(n); }));
+}
+
 int main (int argc, char *argv[])
 {
     Time::SetResolution(Time::NS);
+    // com mpirun, cada rank simula um cluster de sites (ver urbano-mpi-partition.h)
+    UrbanoMpi::Init(&argc, &argv);
 
     uint32_t rows = 4, cols = 4;
     double isd = 600.0;
+    double areaX = 3000.0, areaY = 3000.0;   // recorte onde os UEs andam
     uint32_t ueCount = 6300;
     double simTime = 10.0;
+    double bandwidth = 20e6;   // 20 MHz = 100 RBs
+    uint32_t rngRun = 1;
+    std::string trafficApp = "mix";
+    // mix hora-cheia (% dos UEs), ver cabeçalho
+    double mixWeb = 40.0;
+    double mixVideo = 40.0;
+    double mixVoip = 20.0;
+
+    // cache de pathloss (desligado: com UEs andando o modo exato quase não acerta;
+    // ligue com pathlossGridRes > 0)
+    bool pathlossCache = false;
+    double pathlossGridRes = 0.0;
+
+    // sombreamento (ver urbano-shadowing-map.h): off ou map (campo correlacionado por site)
+    std::string shadowing = "off";
+    double shadowSigma = 7.0;
+    double shadowDecorrM = 50.0;
+    double shadowResM = 10.0;
+    double shadowSiteCorr = 0.5;
+
+    // poda de interferência por potência recebida (ver urbano-interference-pruning.h)
+    bool interferencePrune = false;
+    double pruneThresholdDb = -20.0;
+    double pruneMarginDb = 3.0;    // a estimativa já é limite superior aqui (antena parabólica <= 0 dB, sem desvanecimento)
+    double pruneMoveM = 10.0;
+
+    // KPIs em janelas (substitui o XML completo do FlowMonitor)
+    uint32_t kpiWindowMs = 100;
+    std::string kpiFile = "lte-urbano-kpi.csv";
+    bool kpiPerFlow = true;
+    bool flowmonXml = false;
+    bool flowmonColumnar = true;
+    bool flowmonHistograms = false;
+    std::string profileFile = "lte-urbano-profile.json";
+    bool eventProfile = false;
+    uint32_t eventProfileStride = 1;
+
+    // attach em ondas por setor (ver urbano-attach-scheduler.h)
+    std::string attachMode = "all";
+    uint32_t attachWaveSize = 8;
+    uint32_t attachWaveMs = 20;
+    uint32_t attachStartMs = 10;
+    bool idealRrc = true;
+    bool bulkBuild = true;
+
+    // toro hexagonal (ver urbano-wrap-around.h): 0 = grade plana rows x cols
+    uint32_t wrapAround = 0;
+
+    // warm-up antes do tráfego (2 s): full = simulado; fast = ver urbano-warmup.h
+    std::string warmup = "full";
+    uint32_t warmupGuardMs = 50;
+
+    // FlowMonitor por amostragem de UEs (ver urbano-flow-sampling.h): 1 = todos
+    double flowSample = 1.0;
+    uint32_t flowSampleRings = 3;
+
+    // parada sequencial (ver urbano-sequential-stop.h): 0 = roda o simTime inteiro
+    double stopRelHw = 0.0;
+    uint32_t stopBatchMs = 1000;
+    uint32_t stopMinBatches = 10;
+    std::string stopKpis = "thr,delay,loss";
+    bool stopPerSector = false;
+
+    // mobilidade dos UEs: walk = RandomWalk2d; batched = ver urbano-batched-mobility.h
+    std::string ueMobility = "walk";
+    uint32_t mobilityTickMs = 1000;
+    double mobilityNotifyM = 5.0;   // bem acima do passo de um tick (1 m/s x 1 s = 1 m): não notifica a cada tick
+
+    CommandLine cmd;
+    cmd.AddValue("ueCount", "Número de UEs", ueCount);
+    cmd.AddValue("simTime", "Duração da simulação (s)", simTime);
+    cmd.AddValue("rows", "Linhas da grade hexagonal de sites", rows);
+    cmd.AddValue("cols", "Colunas da grade hexagonal de sites", cols);
+    cmd.AddValue("isd", "Distância entre sites (m)", isd);
+    cmd.AddValue("areaX", "Largura (m) da área dos UEs", areaX);
+    cmd.AddValue("areaY", "Altura (m) da área dos UEs", areaY);
+    cmd.AddValue("bandwidth", "Largura de banda DL/UL (Hz)", bandwidth);
+    cmd.AddValue("rngRun", "Número de run do RNG (seed fixa = 1)", rngRun);
+    cmd.AddValue("trafficApp", "Mix hora-cheia Web/Vídeo/VoIP (mix), multi-fluxo CBR no PGW (multiflow) ou um OnOff por UE (onoff)", trafficApp);
+    cmd.AddValue("mixWeb", "% de UEs Web/TCP (rajadas 1–4 Mb a cada 3–6 s)", mixWeb);
+    cmd.AddValue("mixVideo", "% de UEs vídeo CBR 1 Mb/s", mixVideo);
+    cmd.AddValue("mixVoip", "% de UEs VoIP 24 kb/s @ 20 ms", mixVoip);
+    cmd.AddValue("pathlossCache", "Memoizar a perda LogDistance por par tx/rx", pathlossCache);
+    cmd.AddValue("pathlossGridRes", "Resolução (m) da grade do cache; 0 = exato por par (só pares parados)", pathlossGridRes);
+    cmd.AddValue("shadowing", "Sombreamento: off ou map (campo 2D correlacionado por site, consulta O(1) pela posição)", shadowing);
+    cmd.AddValue("shadowSigma", "Desvio padrão (dB) do sombreamento", shadowSigma);
+    cmd.AddValue("shadowDecorrM", "Distância de descorrelação (m) do sombreamento", shadowDecorrM);
+    cmd.AddValue("shadowResM", "Resolução (m) da grade do mapa de sombreamento", shadowResM);
+    cmd.AddValue("shadowSiteCorr", "Correlação do sombreamento entre sites", shadowSiteCorr);
+    cmd.AddValue("interferencePrune", "Não entregar sinais tx->rx com potência estimada abaixo de ruído + pruneThresholdDb", interferencePrune);
+    cmd.AddValue("pruneThresholdDb", "Potência recebida mínima relativa ao ruído (dB) na poda", pruneThresholdDb);
+    cmd.AddValue("pruneMarginDb", "Folga (dB) da estimativa da poda (ganho de antena, desvanecimento)", pruneMarginDb);
+    cmd.AddValue("pruneMoveM", "Deslocamento (m) do UE que reavalia seus candidatos na poda", pruneMoveM);
+    cmd.AddValue("kpiWindowMs", "Janela do registro de KPIs (ms de tempo simulado)", kpiWindowMs);
+    cmd.AddValue("kpiFile", "CSV append-only com as séries de KPI por janela", kpiFile);
+    cmd.AddValue("kpiPerFlow", "Registrar linhas por fluxo além das por setor", kpiPerFlow);
+    cmd.AddValue("flowmonXml", "Gravar também o XML completo do FlowMonitor no fim", flowmonXml);
+    cmd.AddValue("flowmonColumnar", "Gravar FlowStats/probes no formato colunar .ufsc", flowmonColumnar);
+    cmd.AddValue("flowmonHistograms", "Incluir histogramas no arquivo colunar", flowmonHistograms);
+    cmd.AddValue("profileFile", "Relatório JSON do profiler por fase", profileFile);
+    cmd.AddValue("eventProfile", "Escalonador instrumentado: custo por tipo de evento e tempo simulado/real", eventProfile);
+    cmd.AddValue("eventProfileStride", "Cronometrar 1 a cada N eventos no profiler de eventos", eventProfileStride);
+    cmd.AddValue("attachMode", "Attach de todos os UEs em t=0 (all) ou em ondas por setor (staged)", attachMode);
+    cmd.AddValue("attachWaveSize", "UEs por setor em cada onda de attach", attachWaveSize);
+    cmd.AddValue("attachWaveMs", "Intervalo (ms) entre ondas de attach", attachWaveMs);
+    cmd.AddValue("attachStartMs", "Instante (ms) da primeira onda de attach", attachStartMs);
+    cmd.AddValue("idealRrc", "RRC ideal (sem mensagens RRC pelo canal); false = RRC real", idealRrc);
+    cmd.AddValue("bulkBuild", "Setores em lote (urbano-topology-builder.h); false = um setor por vez", bulkBuild);
+    cmd.AddValue("wrapAround", "Sites do cluster wrap-around (7, 19, 21...): toro hexagonal sem borda, ignora rows/cols/areaX/areaY; 0 = grade plana", wrapAround);
+    cmd.AddValue("warmup", "Warm-up antes do tráfego: full (2 s simulados) ou fast (só até os UEs conectarem, mobilidade avançada analiticamente)", warmup);
+    cmd.AddValue("warmupGuardMs", "Folga (ms) entre a conexão do último UE e o início do tráfego no warm-up fast", warmupGuardMs);
+    cmd.AddValue("flowSample", "Fração dos UEs monitorados, estratificada por setor e anel de distância (KPIs da rede extrapolados com IC); 1 = FlowMonitor em todos", flowSample);
+    cmd.AddValue("flowSampleRings", "Anéis de distância ao site (até ISD/2) na estratificação da amostra", flowSampleRings);
+    cmd.AddValue("stopRelHw", "Parar quando a meia-largura relativa do IC 95% de todas as KPIs alvo ficar abaixo deste valor (simTime vira teto); 0 = desligado", stopRelHw);
+    cmd.AddValue("stopBatchMs", "Duração (ms) de cada lote das médias por lote", stopBatchMs);
+    cmd.AddValue("stopMinBatches", "Mínimo de lotes antes de testar a convergência", stopMinBatches);
+    cmd.AddValue("stopKpis", "KPIs alvo da parada: thr,delay,loss", stopKpis);
+    cmd.AddValue("stopPerSector", "Exigir convergência também em cada setor", stopPerSector);
+    cmd.AddValue("ueMobility", "Mobilidade dos UEs: walk (RandomWalk2d, um evento por perna) ou batched (estado em lote, posição sob demanda)", ueMobility);
+    cmd.AddValue("mobilityTickMs", "Período (ms) da atualização em lote da mobilidade batched", mobilityTickMs);
+    cmd.AddValue("mobilityNotifyM", "Deslocamento (m) que dispara CourseChange na mobilidade batched", mobilityNotifyM);
+    cmd.Parse(argc, argv);
+
+    const uint32_t rank = UrbanoMpi::Rank();
+    kpiFile = UrbanoMpi::FileName(kpiFile);
+    profileFile = UrbanoMpi::FileName(profileFile);
+
+    // tempo real/CPU/RSS/objetos/eventos por fase
+    PhaseProfiler prof("lte-urbano", profileFile);
+    if (eventProfile)
+    {
+        EnableEventProfiler("lte-urbano", eventProfileStride);
+    }
+    prof.Begin("helpers/epc");
 
     // ---- Config global LTE PHY (ns-3.40) ----
     Config::SetDefault("ns3::LteEnbPhy::TxPower", DoubleValue(46.0));
@@ -113,13 +301,36 @@ int main (int argc, char *argv[])
     Ptr<LteHelper> lte = CreateObject<LteHelper>();
     Ptr<PointToPointEpcHelper> epc = CreateObject<PointToPointEpcHelper>();
     lte->SetEpcHelper(epc);
+    lte->SetAttribute("UseIdealRrc", BooleanValue(idealRrc));
 
-    // banda 20 MHz
-    lte->SetEnbDeviceAttribute("DlBandwidth", UintegerValue(100));
-    lte->SetEnbDeviceAttribute("UlBandwidth", UintegerValue(100));
+    // banda (padrão 20 MHz = 100 RBs)
+    lte->SetEnbDeviceAttribute("DlBandwidth", UintegerValue(LteBandwidthToRb(bandwidth)));
+    lte->SetEnbDeviceAttribute("UlBandwidth", UintegerValue(LteBandwidthToRb(bandwidth)));
 
     // Pathloss model para ambiente urbano LTE
-    lte->SetPathlossModelType( LogDistancePropagationLossModel::GetTypeId() );
+    // (com cache: o LogDistance vira o modelo interno do CachedPropagationLossModel;
+    //  com wrap-around: Cached -> WrapAround -> LogDistance)
+    NS_ABORT_MSG_IF(wrapAround > 0 && UrbanoMpi::Size() > 1, "wrapAround não combina com partição MPI");
+    HexWrapAround wrap;
+    TypeId pathloss = LogDistancePropagationLossModel::GetTypeId();
+    if (wrapAround > 0)
+    {
+        wrap = HexWrapAround(wrapAround, isd);
+        Config::SetDefault("ns3::WrapAroundPropagationLossModel::Inner",
+                           StringValue("ns3::LogDistancePropagationLossModel"));
+        Config::SetDefault("ns3::WrapAroundPropagationLossModel::Sites", UintegerValue(wrapAround));
+        Config::SetDefault("ns3::WrapAroundPropagationLossModel::Isd", DoubleValue(isd));
+        pathloss = WrapAroundPropagationLossModel::GetTypeId();
+    }
+    if (pathlossCache)
+    {
+        Config::SetDefault("ns3::CachedPropagationLossModel::Inner",
+                           StringValue(pathloss.GetName()));
+        Config::SetDefault("ns3::CachedPropagationLossModel::GridResolution",
+                           DoubleValue(pathlossGridRes));
+        pathloss = CachedPropagationLossModel::GetTypeId();
+    }
+    lte->SetPathlossModelType(pathloss);
 
     // Exponente urbano (entre 3.5 e 4.0)
     Config::SetDefault("ns3::LogDistancePropagationLossModel::Exponent",
@@ -144,73 +355,249 @@ int main (int argc, char *argv[])
     
     // tornar simulações reprodutíveis (opcional)
     RngSeedManager::SetSeed(1);
-    RngSeedManager::SetRun(1);
+    RngSeedManager::SetRun(rngRun + 1000 * rank);   // rank 0 = execução serial
 
     // ---------- sites ----------
-    NodeContainer sites;
-    sites.Create(rows*cols);
+    prof.Begin("cell install");
+    auto centers = wrap.IsEnabled() ? wrap.GetSites(25.0) : MakeHexGrid(rows, cols, isd, 25.0);
+    Rectangle area = wrap.IsEnabled() ? wrap.GetBounds() : Rectangle(0, areaX, 0, areaY);
 
-    auto centers = MakeHexGrid(rows, cols, isd, 25.0);
+    // cluster de sites + região de UEs deste rank (1 rank = grade inteira)
+    SitePartition part = PartitionSites(centers, area, UrbanoMpi::Size(), ueCount)[rank];
 
-    {
-        MobilityHelper mh;
-        Ptr<ListPositionAllocator> alloc = CreateObject<ListPositionAllocator>();
-        for(auto &v: centers) alloc->Add(v);
-        mh.SetPositionAllocator(alloc);
-        mh.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-        mh.Install(sites);
-    }
+    NodeContainer sites;
+    sites.Create(part.sites.size());
+    std::vector<Vector> sitePos;
+    for(uint32_t s : part.sites) sitePos.push_back(centers[s]);
+    InstallConstantPositions(sites, sitePos);
 
     // ---------- setores ----------
     NodeContainer enbNodes;
     NetDeviceContainer enbDevs;
-    CreateTriSectorEnbs(lte, sites, enbNodes, enbDevs);
+    if (bulkBuild)
+    {
+        CreateTriSectorEnbsBulk(lte, sites, enbNodes, enbDevs);
+    }
+    else
+    {
+        CreateTriSectorEnbs(lte, sites, enbNodes, enbDevs);
+    }
+
+    // toro: a perda usa a imagem mais próxima; o ganho da antena de cada setor
+    // é corrigido para a direção dessa imagem
+    if (wrap.IsEnabled())
+    {
+        for (Ptr<SpectrumChannel> ch : {lte->GetDownlinkSpectrumChannel(), lte->GetUplinkSpectrumChannel()})
+        {
+            Ptr<WrapAroundPropagationLossModel> w =
+                FindPropagationLossModel<WrapAroundPropagationLossModel>(ch->GetPropagationLossModel());
+            for(uint32_t i=0; i<enbDevs.GetN(); i++)
+            {
+                Ptr<LteEnbNetDevice> enb = DynamicCast<LteEnbNetDevice>(enbDevs.Get(i));
+                w->AddAntenna(enb->GetNode()->GetObject<MobilityModel>(),
+                              DynamicCast<AntennaModel>(enb->GetPhy()->GetDownlinkSpectrumPhy()->GetAntenna()));
+            }
+        }
+        std::cout << "[WRAP] toro de " << centers.size() << " sites (" << enbDevs.GetN()
+                  << " setores, ISD " << isd << " m, " << wrap.GetArea() / 1e6 << " km²), "
+                  << part.ueCount << " UEs" << std::endl;
+    }
+
+    // sombreamento por mapa: um modelo na frente da cadeia de DL e outro na de UL
+    // (AddPropagationLossModel faz SetNext, então um objeto por canal), mesmo campo
+    NS_ABORT_MSG_IF(shadowing != "off" && shadowing != "map", "shadowing deve ser off ou map");
+    NS_ABORT_MSG_IF(shadowing == "map" && wrap.IsEnabled(),
+                    "shadowing=map não combina com wrapAround (o campo não é periódico no toro)");
+    Ptr<ShadowingMapPropagationLossModel> shadow;
+    if (shadowing == "map")
+    {
+        shadow = CreateObjectWithAttributes<ShadowingMapPropagationLossModel>(
+            "Sigma", DoubleValue(shadowSigma),
+            "DecorrelationDistance", DoubleValue(shadowDecorrM),
+            "Resolution", DoubleValue(shadowResM),
+            "InterSiteCorrelation", DoubleValue(shadowSiteCorr),
+            "Bounds", RectangleValue(part.region));
+        for(const Vector& c : sitePos) shadow->AddSite(c);
+        lte->GetDownlinkSpectrumChannel()->AddPropagationLossModel(shadow);
+        lte->GetUplinkSpectrumChannel()->AddPropagationLossModel(shadow->Share());
+    }
+
+    // poda: filtro em cada canal, com a cadeia de perda completa do canal
+    Ptr<ReceivedPowerTransmitFilter> pruneDl;
+    Ptr<ReceivedPowerTransmitFilter> pruneUl;
+    if (interferencePrune)
+    {
+        pruneDl = InstallInterferencePruning(lte->GetDownlinkSpectrumChannel(), pruneThresholdDb, pruneMarginDb, pruneMoveM);
+        pruneUl = InstallInterferencePruning(lte->GetUplinkSpectrumChannel(), pruneThresholdDb, pruneMarginDb, pruneMoveM);
+    }
 
     // ---------- UEs ----------
-    NodeContainer ueNodes; ueNodes.Create(ueCount);
+    prof.Begin("ue install");
+    NodeContainer ueNodes; ueNodes.Create(part.ueCount);
     internet.Install(ueNodes);
 
-    MobilityHelper ueMob;
-    ueMob.SetPositionAllocator("ns3::RandomRectanglePositionAllocator",
-        "X", StringValue("ns3::UniformRandomVariable[Min=0|Max=3000]"),
-        "Y", StringValue("ns3::UniformRandomVariable[Min=0|Max=3000]"));
-    ueMob.SetMobilityModel("ns3::RandomWalk2dMobilityModel",
-        "Bounds", RectangleValue(Rectangle(0,3000,0,3000)),
-        "Speed", StringValue("ns3::ConstantRandomVariable[Constant=1]"),
-        "Distance", DoubleValue(5.0));
-    ueMob.Install(ueNodes);
+    // posições sorteadas de uma vez (mesma sequência do MobilityHelper) e modelos numa passada
+    ObjectFactory uePos("ns3::RandomRectanglePositionAllocator");
+    uePos.Set("X", StringValue("ns3::UniformRandomVariable[Min=" + std::to_string(part.region.xMin) +
+                               "|Max=" + std::to_string(part.region.xMax) + "]"),
+              "Y", StringValue("ns3::UniformRandomVariable[Min=" + std::to_string(part.region.yMin) +
+                               "|Max=" + std::to_string(part.region.yMax) + "]"));
+    NS_ABORT_MSG_IF(ueMobility != "walk" && ueMobility != "batched", "ueMobility deve ser walk ou batched");
+    ObjectFactory ueModel(ueMobility == "batched" ? "ns3::BatchedRandomWalk2dMobilityModel"
+                                                  : "ns3::RandomWalk2dMobilityModel");
+    ueModel.Set("Bounds", RectangleValue(part.region),
+                "Speed", StringValue("ns3::ConstantRandomVariable[Constant=1]"),
+                "Distance", DoubleValue(5.0));
+    if (ueMobility == "batched")
+    {
+        Config::SetDefault("ns3::BatchedWalkEngine::UpdateInterval", TimeValue(MilliSeconds(mobilityTickMs)));
+        ueModel.Set("NotifyThreshold", DoubleValue(mobilityNotifyM));
+    }
+    if (wrap.IsEnabled())
+    {
+        // uniforme no hexágono do cluster; o passeio fica no quadrado envolvente
+        // (fora do hexágono a perda já é a da imagem)
+        InstallMobility(ueNodes, wrap.DrawPositions(ueNodes.GetN(), 0.0, CreateObject<UniformRandomVariable>()), ueModel);
+    }
+    else
+    {
+        InstallMobility(ueNodes, DrawPositions(uePos.Create<PositionAllocator>(), ueNodes.GetN()), ueModel);
+    }
 
     NetDeviceContainer ueDevs = lte->InstallUeDevice(ueNodes);
     Ipv4InterfaceContainer ueIfaces = epc->AssignUeIpv4Address(ueDevs);
 
-    // attach automático
-    lte->Attach(ueDevs);
+    // attach automático (seleção de célula pelo UE); em ondas, agrupado pelo setor
+    // de visada: site mais próximo + setor pelo azimute (0/120/240 graus)
+    prof.Begin("attach");
+    UniformGridIndex siteIndex = UniformGridIndex::FromNodes(sites, isd);
+    auto sectorOf = [&](uint32_t i) {
+        Vector up = ueNodes.Get(i)->GetObject<MobilityModel>()->GetPosition();
+        uint32_t s = siteIndex.Nearest(up);
+        Vector sp = siteIndex.GetPoint(s);
+        double az = std::atan2(up.y - sp.y, up.x - sp.x) * 180.0 / M_PI;
+        return 3 * s + static_cast<uint32_t>(std::lround((az < 0 ? az + 360.0 : az) / 120.0)) % 3;
+    };
+    StagedAttach attach(
+        ueDevs,
+        [&](uint32_t i) { lte->Attach(ueDevs.Get(i)); },
+        [](Ptr<NetDevice> d) { return DynamicCast<LteUeNetDevice>(d)->GetRrc(); });
+    if (attachMode == "staged")
+    {
+        attach.Staged(sectorOf, attachWaveSize, MilliSeconds(attachStartMs), MilliSeconds(attachWaveMs));
+    }
+    else
+    {
+        attach.Immediate();
+    }
+
+    // warm-up: no modo fast o Run vai só até a conexão e o tráfego é instalado depois
+    WarmupFastForward warm(Seconds(2.0), MilliSeconds(warmupGuardMs));
+    if (warmup == "fast")
+    {
+        prof.Begin("warmup");
+        warm.Run(attach, ueNodes);
+    }
+    const Time trafficStart = warm.GetTrafficStart();
+    const Time trafficStop = trafficStart + Seconds(simTime - 2.0);
 
     // ---------- Aplicações ----------
+    prof.Begin("apps");
     uint16_t port = 9000;
     ApplicationContainer apps;
 
-    for(uint32_t i=0; i<ueNodes.GetN(); i++)
+    TrafficMixConfig mixCfg;
+    mixCfg.webShare = mixWeb / 100.0;
+    mixCfg.videoShare = mixVideo / 100.0;
+    mixCfg.voipShare = mixVoip / 100.0;
+    mixCfg.videoPktSize = 600;
+    TrafficMix mix(mixCfg);
+
+    if (trafficApp == "mix")
     {
-        PacketSinkHelper sink("ns3::UdpSocketFactory",
-                              InetSocketAddress(Ipv4Address::GetAny(), port));
-        apps.Add(sink.Install(ueNodes.Get(i)));
+        apps = mix.Install(pgw, ueNodes, ueIfaces, port);
+    }
+    else if (trafficApp == "multiflow")
+    {
+        // um único cliente no PGW + sink leve por UE (mesma taxa/tamanho e ciclo on/off do OnOff)
+        apps = InstallMultiFlowTraffic(pgw, ueNodes, ueIfaces, port, DataRate("1Mb/s"), 600);
+    }
+    else
+    {
+        for(uint32_t i=0; i<ueNodes.GetN(); i++)
+        {
+            PacketSinkHelper sink("ns3::UdpSocketFactory",
+                                  InetSocketAddress(Ipv4Address::GetAny(), port));
+            apps.Add(sink.Install(ueNodes.Get(i)));
 
-        OnOffHelper onoff("ns3::UdpSocketFactory",
-                          InetSocketAddress(ueIfaces.GetAddress(i), port));
-        onoff.SetAttribute("DataRate", DataRateValue(DataRate("1Mb/s")));
-        onoff.SetAttribute("PacketSize", UintegerValue(600));
-        apps.Add(onoff.Install(pgw));
+            OnOffHelper onoff("ns3::UdpSocketFactory",
+                              InetSocketAddress(ueIfaces.GetAddress(i), port));
+            onoff.SetAttribute("DataRate", DataRateValue(DataRate("1Mb/s")));
+            onoff.SetAttribute("PacketSize", UintegerValue(600));
+            apps.Add(onoff.Install(pgw));
 
-        port++;
+            port++;
+        }
     }
 
-    apps.Start(Seconds(2.0));
-    apps.Stop(Seconds(simTime));
+    apps.Start(trafficStart - Simulator::Now());
+    apps.Stop(trafficStop - Simulator::Now());
 
     // ---------- FlowMonitor ----------
+    prof.Begin("flowmon");
     FlowMonitorHelper fm;
-    Ptr<FlowMonitor> monitor = fm.InstallAll();
+    Ptr<FlowMonitor> monitor;
+    // o registro em janelas só precisa dos contadores: sem XML/histogramas no
+    // fim, monitor enxuto (um bin por histograma, sondas só nas pontas)
+    const bool leanMonitor = !flowmonXml && !flowmonHistograms;
+    if (leanMonitor)
+    {
+        NarrowFlowMonitor(fm);
+    }
+    // amostra: estrato = setor de visada x anel de distância ao site mais próximo
+    FlowSample sample(ueNodes, ueIfaces, sectorOf,
+                      [&](uint32_t i) {
+                          Vector up = ueNodes.Get(i)->GetObject<MobilityModel>()->GetPosition();
+                          Vector sp = siteIndex.GetPoint(siteIndex.Nearest(up));
+                          return std::hypot(up.x - sp.x, up.y - sp.y);
+                      },
+                      isd / (2.0 * flowSampleRings), flowSampleRings);
+    if (flowSample < 1.0)
+    {
+        sample.Draw(flowSample, CreateObject<UniformRandomVariable>());
+        monitor = sample.Install(fm, pgw);
+    }
+    else if (leanMonitor)
+    {
+        monitor = InstallEndpointFlowMonitor(fm, pgw, ueNodes);
+    }
+    else
+    {
+        monitor = fm.InstallAll();
+    }
+
+    KpiWindowRecorder kpi(monitor,
+                          DynamicCast<Ipv4FlowClassifier>(fm.GetClassifier()),
+                          kpiFile,
+                          MilliSeconds(kpiWindowMs),
+                          kpiPerFlow);
+    kpi.SetSectorResolver(MakeCellIdResolver(ueIfaces, ueDevs, [](Ptr<NetDevice> d) -> uint16_t {
+        return DynamicCast<LteUeNetDevice>(d)->GetRrc()->GetCellId();
+    }));
+    kpi.Start(trafficStart);
+
+    // médias por lote sobre as janelas do registro de KPIs
+    SequentialStopConfig stopCfg;
+    stopCfg.relHalfWidth = stopRelHw;
+    stopCfg.batchWindows = std::max<uint32_t>(1, stopBatchMs / kpiWindowMs);
+    stopCfg.minBatches = stopMinBatches;
+    stopCfg.kpis = stopKpis;
+    stopCfg.perSector = stopPerSector;
+    SequentialStop stop(stopCfg, UrbanoMpi::FileName("lte-urbano-stop.csv"));
+    if (stopRelHw > 0)
+    {
+        stop.Attach(kpi);
+    }
 
     // ---------- NetAnim (ns-3.40: NÃO usar Ptr) ----------
     //AnimationInterface anim("lte-urbano.xml");
@@ -226,11 +613,89 @@ int main (int argc, char *argv[])
     //    anim.UpdateNodeSize(ueNodes.Get(i),7,7);
     //}
 
-    Simulator::Stop(Seconds(simTime));
+    Simulator::Stop(trafficStop - Simulator::Now());
+    prof.Begin("run");
     Simulator::Run();
+    prof.Begin("export");
+    // janela medida: até simTime ou até a parada sequencial
+    const Time measured = Simulator::Now() - trafficStart;
+    ProfilingScheduler::Report();
+    attach.Report();
+    if (stopRelHw > 0)
+    {
+        stop.Report();
+    }
+    BatchedWalkEngine::Report();
+
+    if (pathlossCache)
+    {
+        const char* dir[] = {"DL", "UL"};
+        Ptr<SpectrumChannel> ch[] = {lte->GetDownlinkSpectrumChannel(), lte->GetUplinkSpectrumChannel()};
+        for (int k = 0; k < 2; k++)
+        {
+            Ptr<CachedPropagationLossModel> c =
+                FindPropagationLossModel<CachedPropagationLossModel>(ch[k]->GetPropagationLossModel());
+            if (c)
+            {
+                std::cout << "[PATHLOSS] cache " << dir[k] << ": hit rate " << 100.0 * c->GetHitRate()
+                          << "% (" << c->GetHits() << " hits, " << c->GetMisses() << " misses, "
+                          << c->GetCacheSize() << " entradas)" << std::endl;
+            }
+        }
+    }
+
+    if (shadow)
+    {
+        shadow->Report();
+    }
+    if (interferencePrune)
+    {
+        pruneDl->Report("DL");
+        pruneUl->Report("UL");
+    }
+
+    kpi.Finish();
+    if (flowSample < 1.0)
+    {
+        sample.Report(monitor,
+                      DynamicCast<Ipv4FlowClassifier>(fm.GetClassifier()),
+                      measured,
+                      UrbanoMpi::FileName("lte-urbano-sample.csv"));
+    }
+    if (trafficApp == "mix")
+    {
+        mix.Report(monitor,
+                   DynamicCast<Ipv4FlowClassifier>(fm.GetClassifier()),
+                   measured,
+                   UrbanoMpi::FileName("lte-urbano-classes.csv"));
+    }
+    // exportação final: ambos os caminhos são cronometrados para comparação
+    if (flowmonXml)
+    {
+        TimedExport("xml", UrbanoMpi::FileName("lte-urbano-metrics.xml"), [&]() {
+            monitor->SerializeToXmlFile(UrbanoMpi::FileName("lte-urbano-metrics.xml"), true, true);
+        });
+    }
+    if (flowmonColumnar)
+    {
+        TimedExport("columnar", UrbanoMpi::FileName("lte-urbano-metrics.ufsc"), [&]() {
+            WriteFlowStatsColumnar(monitor,
+                                   DynamicCast<Ipv4FlowClassifier>(fm.GetClassifier()),
+                                   UrbanoMpi::FileName("lte-urbano-metrics.ufsc"),
+                                   flowmonHistograms);
+        });
+    }
 
-    monitor->SerializeToXmlFile("lte-urbano-metrics.xml", true, true);
+    ReportMpiTotals(monitor,
+                    prof.GetWallS({"helpers/epc", "cell install", "ue install", "attach", "apps", "flowmon"}),
+                    prof.GetWallS({"warmup", "run"}),
+                    part.sites.size(),
+                    part.ueCount,
+                    measured.GetSeconds());
 
+    prof.Begin("destroy");
     Simulator::Destroy();
+    prof.Finish();
+    UrbanoMpi::Finalize();
     return 0;
 }
@@ -11,6 +11,22 @@
 #include "ns3/ideal-beamforming-helper.h"
 #include "ns3/nr-point-to-point-epc-helper.h"
 
+#include "urbano-attach-scheduler.h"
+#include "urbano-beam-cache.h"
+#include "urbano-event-profiler.h"
+#include "urbano-fast-phy.h"
+#include "urbano-flow-export.h"
+#include "urbano-flow-sampling.h"
+#include "urbano-kpi-recorder.h"
+#include "urbano-multiflow-apps.h"
+#include "urbano-phase-profiler.h"
+#include "urbano-sequential-stop.h"
+#include "urbano-spatial-index.h"
+#include "urbano-topology-builder.h"
+#include "urbano-traffic-mix.h"
+
+#include <chrono>
+
 using namespace ns3;
 
 // ---------- utilitário de log colorido ----------
@@ -20,11 +36,15 @@ using namespace ns3;
 #define RED    "\033[1;31m"
 #define RESET  "\033[0m"
 
+// marca de etapa no console; tempo real desde o início do processo (o detalhamento
+// por fase, com CPU/RSS/eventos, fica no profiler)
+static const auto g_start = std::chrono::steady_clock::now();
+
 void PrintStep(std::string step)
 {
     std::cout << GREEN << "[DEBUG]" << RESET
               << " " << step
-              << YELLOW << " (" << (clock() / (double)CLOCKS_PER_SEC)
+              << YELLOW << " (" << std::chrono::duration<double>(std::chrono::steady_clock::now() - g_start).count()
               << "s tempo real)" << RESET << std::endl;
 }
 
@@ -94,6 +114,25 @@ void CreateTriSectorGnbs(Ptr<NrHelper> nr,
     }
 }
 
+// ---------- mesmos 3 setores por site, em lote (ver urbano-topology-builder.h) ----------
+void CreateTriSectorGnbsBulk(Ptr<NrHelper> nr,
+                             const BandwidthPartInfoPtrVector &bwps,
+                             NodeContainer &sites,
+                             NodeContainer &gnbNodes,
+                             NetDeviceContainer &gnbDevs)
+{
+    const double offset = 3.0;
+    PrintStep("Criando setores por site (em lote)");
+
+    // mesma configuração em todos os setores: um único InstallGnbDevice
+    TriSectorLayout layout = MakeTriSectorLayout(GetPositions(sites), offset);
+    NodeContainer created;
+    created.Create(layout.positions.size());
+    InstallConstantPositions(created, layout.positions);
+    gnbNodes.Add(created);
+    gnbDevs.Add(nr->InstallGnbDevice(created, bwps));
+}
+
 int main(int argc, char *argv[])
 {
     Time::SetResolution(Time::NS);
@@ -104,22 +143,92 @@ int main(int argc, char *argv[])
     double simTime = 5.0;
     double centralFreq = 28e9;  // 28 GHz
     double bandwidth = 100e6;   // 100 MHz (6G urbano balanceado)
+    uint32_t rngRun = 1;
+    std::string trafficApp = "multiflow";
+    // mix hora-cheia (% dos UEs), ver urbano-traffic-mix.h
+    double mixWeb = 40.0;
+    double mixVideo = 40.0;
+    double mixVoip = 20.0;
+    bool spatialIndex = true;
+    bool fastPhy = false;                           // ver urbano-fast-phy.h
+    std::string fastPhyCache = "nr-fastphy.tbl";
+    bool beamCache = false;                         // ver urbano-beam-cache.h
+    double beamCacheDeg = 1.0;
+    std::string profileFile = "nr-6g-urbano-lite-profile.json";
+    bool eventProfile = false;
+    uint32_t eventProfileStride = 1;
+    std::string attachMode = "all";
+    uint32_t attachWaveSize = 8;
+    uint32_t attachWaveMs = 20;
+    bool idealRrc = true;
+    double flowSample = 1.0;
+    uint32_t flowSampleRings = 3;
+    double stopRelHw = 0.0;       // parada sequencial; 0 = roda o simTime inteiro
+    uint32_t stopBatchMs = 500;
+    uint32_t stopMinBatches = 6;
+    std::string stopKpis = "thr,delay,loss";
+    bool bulkBuild = true;
 
     CommandLine cmd;
     cmd.AddValue("ueCount", "Número de UEs", ueCount);
     cmd.AddValue("simTime", "Duração da simulação (s)", simTime);
+    cmd.AddValue("rows", "Linhas da grade hexagonal de sites", rows);
+    cmd.AddValue("cols", "Colunas da grade hexagonal de sites", cols);
+    cmd.AddValue("isd", "Distância entre sites (m)", isd);
+    cmd.AddValue("bandwidth", "Largura de banda do canal (Hz)", bandwidth);
+    cmd.AddValue("rngRun", "Número de run do RNG (seed fixa = 1)", rngRun);
+    cmd.AddValue("trafficApp", "Mix hora-cheia Web/Vídeo/VoIP (mix), multi-fluxo CBR no PGW (multiflow) ou um OnOff por UE (onoff)", trafficApp);
+    cmd.AddValue("mixWeb", "% de UEs Web/TCP (rajadas 1–4 Mb a cada 3–6 s)", mixWeb);
+    cmd.AddValue("mixVideo", "% de UEs vídeo CBR 1 Mb/s", mixVideo);
+    cmd.AddValue("mixVoip", "% de UEs VoIP 24 kb/s @ 20 ms", mixVoip);
+    cmd.AddValue("spatialIndex", "Attach ao setor mais próximo via índice em grade", spatialIndex);
+    cmd.AddValue("fastPhy", "Decodificação de TB e CQI por tabela (SINR efetivo -> BLER por MCS) em vez do modelo de erro exato", fastPhy);
+    cmd.AddValue("fastPhyCache", "Arquivo de onde as tabelas do fast PHY são lidas / onde são gravadas; vazio = recalcula a cada rodada", fastPhyCache);
+    cmd.AddValue("beamCache", "Reusar o par de feixes gNB/UE até o UE mudar mais que beamCacheDeg visto do gNB (UEs parados: sempre acerta)", beamCache);
+    cmd.AddValue("beamCacheDeg", "Variação angular (graus) que invalida o feixe guardado", beamCacheDeg);
+    cmd.AddValue("profileFile", "Relatório JSON do profiler por fase", profileFile);
+    cmd.AddValue("eventProfile", "Escalonador instrumentado: custo por tipo de evento e tempo simulado/real", eventProfile);
+    cmd.AddValue("eventProfileStride", "Cronometrar 1 a cada N eventos no profiler de eventos", eventProfileStride);
+    cmd.AddValue("attachMode", "Attach de todos os UEs em t=0 (all) ou em ondas por setor (staged)", attachMode);
+    cmd.AddValue("attachWaveSize", "UEs por setor em cada onda de attach", attachWaveSize);
+    cmd.AddValue("attachWaveMs", "Intervalo (ms) entre ondas de attach", attachWaveMs);
+    cmd.AddValue("idealRrc", "RRC ideal (sem mensagens RRC pelo canal); false = RRC real", idealRrc);
+    cmd.AddValue("flowSample", "Fração dos UEs monitorados, estratificada por setor e anel de distância (KPIs da rede extrapolados com IC); 1 = PGW + todos os UEs", flowSample);
+    cmd.AddValue("flowSampleRings", "Anéis de distância ao setor (até ISD/2) na estratificação da amostra", flowSampleRings);
+    cmd.AddValue("stopRelHw", "Parar quando a meia-largura relativa do IC 95% de todas as KPIs alvo ficar abaixo deste valor (simTime vira teto); 0 = desligado", stopRelHw);
+    cmd.AddValue("stopBatchMs", "Duração (ms) de cada lote das médias por lote", stopBatchMs);
+    cmd.AddValue("stopMinBatches", "Mínimo de lotes antes de testar a convergência", stopMinBatches);
+    cmd.AddValue("stopKpis", "KPIs alvo da parada: thr,delay,loss", stopKpis);
+    cmd.AddValue("bulkBuild", "Setores em lote (urbano-topology-builder.h); false = um setor por vez", bulkBuild);
     cmd.Parse(argc, argv);
 
     RngSeedManager::SetSeed(1);
-    RngSeedManager::SetRun(1);
+    RngSeedManager::SetRun(rngRun);
+
+    // tempo real/CPU/RSS/objetos/eventos por fase (tempo real, não clock())
+    PhaseProfiler prof("nr-6g-urbano-lite", profileFile);
+    if (eventProfile)
+    {
+        EnableEventProfiler("nr-6g-urbano-lite", eventProfileStride);
+    }
 
     // ---------- Inicialização ----------
     PrintStep("Inicializando helpers e EPC");
+    prof.Begin("helpers/epc");
     Ptr<NrHelper> nr = CreateObject<NrHelper>();
     Ptr<NrPointToPointEpcHelper> epc = CreateObject<NrPointToPointEpcHelper>();
     nr->SetEpcHelper(epc);
+    nr->SetAttribute("UseIdealRrc", BooleanValue(idealRrc));
 
-    Ptr<IdealBeamformingHelper> bf = CreateObject<IdealBeamformingHelper>();
+    Ptr<IdealBeamformingHelper> bf;
+    if (beamCache)
+    {
+        bf = CreateObjectWithAttributes<CachedIdealBeamformingHelper>("AngularThreshold", DoubleValue(beamCacheDeg));
+    }
+    else
+    {
+        bf = CreateObject<IdealBeamformingHelper>();
+    }
     nr->SetBeamformingHelper(bf);
 
     Ptr<Node> pgw = epc->GetPgwNode();
@@ -128,6 +237,7 @@ int main(int argc, char *argv[])
 
     // ---------- Banda ----------
     PrintStep("Configurando banda e modelo de propagação");
+    prof.Begin("band init");
     CcBwpCreator ccBwp;
     CcBwpCreator::SimpleOperationBandConf bandConf;
     bandConf.m_centralFrequency = centralFreq;
@@ -158,28 +268,39 @@ int main(int argc, char *argv[])
     BandwidthPartInfoPtrVector allBwps = CcBwpCreator::GetAllBwps(bands);
     nr->InitializeOperationBand(&band);
     nr->SetSchedulerTypeId(TypeId::LookupByName("ns3::NrMacSchedulerTdmaPF"));
+    if (fastPhy)
+    {
+        // tabelas geradas a partir do modelo de erro padrão (NrLteMiErrorModel)
+        Config::SetDefault("ns3::NrFastPhyErrorModel::CacheFile", StringValue(fastPhyCache));
+        nr->SetDlErrorModel("ns3::NrFastPhyErrorModel");
+        nr->SetUlErrorModel("ns3::NrFastPhyErrorModel");
+    }
 
     // ---------- Sites ----------
     PrintStep("Criando sites e mobilidade");
+    prof.Begin("cell install");
     NodeContainer sites; sites.Create(rows * cols);
     auto centers = MakeHexGrid(rows, cols, isd);
-    MobilityHelper mh;
-    Ptr<ListPositionAllocator> alloc = CreateObject<ListPositionAllocator>();
-    for (auto &v : centers) alloc->Add(v);
-    mh.SetPositionAllocator(alloc);
-    mh.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-    mh.Install(sites);
+    InstallConstantPositions(sites, centers);
 
     // ---------- gNBs ----------
     NodeContainer gnbNodes;
     NetDeviceContainer gnbDevs;
-    CreateTriSectorGnbs(nr, allBwps, sites, gnbNodes, gnbDevs);
+    if (bulkBuild)
+    {
+        CreateTriSectorGnbsBulk(nr, allBwps, sites, gnbNodes, gnbDevs);
+    }
+    else
+    {
+        CreateTriSectorGnbs(nr, allBwps, sites, gnbNodes, gnbDevs);
+    }
     PrintStep("Atualizando configuração dos gNBs");
     for (auto it = gnbDevs.Begin(); it != gnbDevs.End(); ++it)
         DynamicCast<NrGnbNetDevice>(*it)->UpdateConfig();
 
     // ---------- UEs ----------
     PrintStep("Criando UEs");
+    prof.Begin("ue install");
     NodeContainer ueNodes; ueNodes.Create(ueCount);
     internet.Install(ueNodes);
     MobilityHelper ueMob;
@@ -200,49 +321,175 @@ int main(int argc, char *argv[])
 
     // ---------- Attach ----------
     PrintStep("Attach dos UEs");
-    nr->AttachToClosestEnb(ueDevs, gnbDevs);
+    prof.Begin("attach");
+    // índice só quando pedido; sem ele, setor mais próximo por busca linear
+    UniformGridIndex gnbIndex;
+    if (spatialIndex)
+    {
+        gnbIndex = UniformGridIndex::FromNodes(gnbNodes, isd);
+    }
+    auto nearestGnb = [&](uint32_t i) {
+        Vector up = ueNodes.Get(i)->GetObject<MobilityModel>()->GetPosition();
+        return spatialIndex ? gnbIndex.Nearest(up) : NearestNode(gnbNodes, up);
+    };
+    StagedAttach attach(
+        ueDevs,
+        [&](uint32_t i) {
+            if (spatialIndex)
+            {
+                nr->AttachToEnb(ueDevs.Get(i), gnbDevs.Get(nearestGnb(i)));
+            }
+            else
+            {
+                nr->AttachToClosestEnb(NetDeviceContainer(ueDevs.Get(i)), gnbDevs);
+            }
+        },
+        [](Ptr<NetDevice> d) { return DynamicCast<NrUeNetDevice>(d)->GetRrc(); });
+    if (attachMode == "staged")
+    {
+        // apps começam em 0.1 s: primeira onda já em t=0
+        attach.Staged(nearestGnb, attachWaveSize, Seconds(0), MilliSeconds(attachWaveMs));
+    }
+    else
+    {
+        attach.Immediate();
+    }
 
     // ---------- Aplicações ----------
     PrintStep("Instalando aplicações");
+    prof.Begin("apps");
     uint16_t port = 9000;
     ApplicationContainer apps;
 
-    for (uint32_t i = 0; i < ueNodes.GetN(); i++)
+    TrafficMixConfig mixCfg;
+    mixCfg.webShare = mixWeb / 100.0;
+    mixCfg.videoShare = mixVideo / 100.0;
+    mixCfg.voipShare = mixVoip / 100.0;
+    mixCfg.videoPktSize = 512;
+    TrafficMix mix(mixCfg);
+
+    if (trafficApp == "mix")
     {
-        PacketSinkHelper sink("ns3::UdpSocketFactory",
-                              InetSocketAddress(Ipv4Address::GetAny(), port));
-        apps.Add(sink.Install(ueNodes.Get(i)));
+        apps = mix.Install(pgw, ueNodes, ueIfaces, port);
+    }
+    else if (trafficApp == "multiflow")
+    {
+        // um único cliente no PGW + sink leve por UE (mesma taxa/tamanho e ciclo on/off do OnOff)
+        apps = InstallMultiFlowTraffic(pgw, ueNodes, ueIfaces, port, DataRate("1Mb/s"), 512);
+    }
+    else
+    {
+        for (uint32_t i = 0; i < ueNodes.GetN(); i++)
+        {
+            PacketSinkHelper sink("ns3::UdpSocketFactory",
+                                  InetSocketAddress(Ipv4Address::GetAny(), port));
+            apps.Add(sink.Install(ueNodes.Get(i)));
 
-        OnOffHelper onoff("ns3::UdpSocketFactory",
-                          InetSocketAddress(ueIfaces.GetAddress(i), port));
-        onoff.SetAttribute("DataRate", DataRateValue(DataRate("1Mb/s")));
-        onoff.SetAttribute("PacketSize", UintegerValue(512));
-        apps.Add(onoff.Install(pgw));
+            OnOffHelper onoff("ns3::UdpSocketFactory",
+                              InetSocketAddress(ueIfaces.GetAddress(i), port));
+            onoff.SetAttribute("DataRate", DataRateValue(DataRate("1Mb/s")));
+            onoff.SetAttribute("PacketSize", UintegerValue(512));
+            apps.Add(onoff.Install(pgw));
 
-        port++;
+            port++;
+        }
     }
     apps.Start(Seconds(0.1));
     apps.Stop(Seconds(simTime));
 
     // ---------- FlowMonitor ----------
     PrintStep("Iniciando FlowMonitor (somente nós relevantes)");
+    prof.Begin("flowmon");
     FlowMonitorHelper fm;
-    // Instala apenas no PGW e nos UEs para reduzir overhead
-    NodeContainer monitorNodes;
-    monitorNodes.Add(pgw);
-    monitorNodes.Add(ueNodes);
-    Ptr<FlowMonitor> monitor = fm.Install(monitorNodes);
+    Ptr<FlowMonitor> monitor;
+    // amostra estratificada (setor mais próximo x anel de distância), ver urbano-flow-sampling.h
+    FlowSample sample(ueNodes, ueIfaces, nearestGnb,
+                      [&](uint32_t i) {
+                          Vector up = ueNodes.Get(i)->GetObject<MobilityModel>()->GetPosition();
+                          Vector gp = gnbNodes.Get(nearestGnb(i))->GetObject<MobilityModel>()->GetPosition();
+                          return std::hypot(up.x - gp.x, up.y - gp.y);
+                      },
+                      isd / (2.0 * flowSampleRings), flowSampleRings);
+    if (flowSample < 1.0)
+    {
+        sample.Draw(flowSample, CreateObject<UniformRandomVariable>());
+        monitor = sample.Install(fm, pgw);
+    }
+    else
+    {
+        // Instala apenas no PGW e nos UEs para reduzir overhead
+        NodeContainer monitorNodes;
+        monitorNodes.Add(pgw);
+        monitorNodes.Add(ueNodes);
+        monitor = fm.Install(monitorNodes);
+    }
+
+    // parada sequencial: registro de KPIs em janelas de 100 ms só quando ligada
+    std::unique_ptr<KpiWindowRecorder> kpi;
+    SequentialStopConfig stopCfg;
+    stopCfg.relHalfWidth = stopRelHw;
+    stopCfg.batchWindows = std::max<uint32_t>(1, stopBatchMs / 100);
+    stopCfg.minBatches = stopMinBatches;
+    stopCfg.kpis = stopKpis;
+    SequentialStop stop(stopCfg, "nr-6g-urbano-lite-stop.csv");
+    if (stopRelHw > 0)
+    {
+        kpi = std::make_unique<KpiWindowRecorder>(monitor,
+                                                  DynamicCast<Ipv4FlowClassifier>(fm.GetClassifier()),
+                                                  "nr-6g-urbano-lite-kpi.csv",
+                                                  MilliSeconds(100),
+                                                  false);
+        kpi->SetSectorResolver(MakeCellIdResolver(ueIfaces, ueDevs, [](Ptr<NetDevice> d) -> uint16_t {
+            return DynamicCast<NrUeNetDevice>(d)->GetRrc()->GetCellId();
+        }));
+        kpi->Start(Seconds(0.1));
+        stop.Attach(*kpi);
+    }
 
     // ---------- Execução ----------
     PrintStep("Rodando simulação");
+    prof.Begin("run");
     // agenda logger de progresso para verificar que a simulação está avançando
     Simulator::Schedule(Seconds(0.0), &PrintSimProgress);
     Simulator::Stop(Seconds(simTime));
     Simulator::Run();
 
     PrintStep("Exportando resultados");
+    prof.Begin("export");
+    const Time measured = Simulator::Now() - Seconds(0.1);
+    ProfilingScheduler::Report();
+    attach.Report();
+    NrFastPhyErrorModel::Report();
+    if (Ptr<CachedIdealBeamformingHelper> bc = DynamicCast<CachedIdealBeamformingHelper>(bf))
+    {
+        bc->Report();
+    }
+    if (kpi)
+    {
+        stop.Report();
+        kpi->Finish();
+    }
     // Evite escrever per-probe/histogramas pesados durante debug; ative apenas quando precisar
     monitor->SerializeToXmlFile("nr-6g-urbano-lite-debug.flowmon", false, false);
+    // resumo colunar compacto (lido por urbano_flowstats.py / urbano_sweep.py)
+    WriteFlowStatsColumnar(monitor,
+                           DynamicCast<Ipv4FlowClassifier>(fm.GetClassifier()),
+                           "nr-6g-urbano-lite-metrics.ufsc",
+                           false);
+    if (trafficApp == "mix")
+    {
+        mix.Report(monitor,
+                   DynamicCast<Ipv4FlowClassifier>(fm.GetClassifier()),
+                   measured,
+                   "nr-6g-urbano-lite-classes.csv");
+    }
+    if (flowSample < 1.0)
+    {
+        sample.Report(monitor,
+                      DynamicCast<Ipv4FlowClassifier>(fm.GetClassifier()),
+                      measured,
+                      "nr-6g-urbano-lite-sample.csv");
+    }
     uint32_t txPackets = 0, rxPackets = 0;
     double delaySum = 0;
 
@@ -261,7 +508,9 @@ int main(int argc, char *argv[])
     else
         std::cout << RED << "Nenhum pacote recebido (possível limitação de tempo ou acoplamento)" << RESET << std::endl;
 
+    prof.Begin("destroy");
     Simulator::Destroy();
+    prof.Finish();
 
     PrintStep("Simulação finalizada com sucesso");
     return 0;
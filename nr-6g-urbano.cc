@@ -13,6 +13,27 @@
 #include "ns3/ideal-beamforming-helper.h"
 #include "ns3/nr-point-to-point-epc-helper.h"
 
+#include "urbano-attach-scheduler.h"
+#include "urbano-batched-mobility.h"
+#include "urbano-beam-cache.h"
+#include "urbano-event-profiler.h"
+#include "urbano-fast-phy.h"
+#include "urbano-flow-export.h"
+#include "urbano-flow-sampling.h"
+#include "urbano-interference-pruning.h"
+#include "urbano-kpi-recorder.h"
+#include "urbano-mpi-partition.h"
+#include "urbano-multiflow-apps.h"
+#include "urbano-phase-profiler.h"
+#include "urbano-sequential-stop.h"
+#include "urbano-shadowing-map.h"
+#include "urbano-spatial-index.h"
+#include "urbano-topology-builder.h"
+#include "urbano-traffic-mix.h"
+#include "urbano-warmup.h"
+
+#include <chrono>
+
 using namespace ns3;
 
 // ---------- grade hexagonal ----------
@@ -73,34 +94,196 @@ void CreateTriSectorGnbs(Ptr<NrHelper> nr,
     }
 }
 
+// ---------- 3 setores (com offset), em lote (ver urbano-topology-builder.h) ----------
+void CreateTriSectorGnbsBulk(Ptr<NrHelper> nr,
+                             const BandwidthPartInfoPtrVector &bwps,
+                             NodeContainer &sites,
+                             NodeContainer &gnbNodes,
+                             NetDeviceContainer &gnbDevs)
+{
+    // mesma configuração em todos os setores: um único InstallGnbDevice
+    TriSectorLayout layout = MakeTriSectorLayout(GetPositions(sites), 1.0);
+    NodeContainer created;
+    created.Create(layout.positions.size());
+    InstallConstantPositions(created, layout.positions);
+    gnbNodes.Add(created);
+    gnbDevs.Add(nr->InstallGnbDevice(created, bwps));
+}
+
 int main(int argc, char *argv[])
 {
     Time::SetResolution(Time::NS);
+    // under mpirun each rank simulates one site cluster (see urbano-mpi-partition.h)
+    UrbanoMpi::Init(&argc, &argv);
 
     // parâmetros (ajustáveis)
     uint32_t rows = 4, cols = 4;   // 16 sites
     uint32_t ueCount = 1500;       // **reduzido por segurança** — aumente em etapas
     double isd = 600.0;
+    double areaX = 3000.0, areaY = 3000.0; // UE area
     double simTime = 10.0;
 
     // 6G-like
     double centralFreq = 28e9;
     double bandwidth   = 400e6;
 
+    uint32_t rngRun = 1;
+    std::string trafficApp = "multiflow";
+    double mixWeb = 40.0;
+    double mixVideo = 40.0;
+    double mixVoip = 20.0;
+    bool spatialIndex = true;
+
+    // shadowing: link = 3GPP per-link state, map = see urbano-shadowing-map.h, off
+    std::string shadowing = "link";
+    double shadowSigma = 6.0;      // UMa NLOS
+    double shadowDecorrM = 50.0;
+    double shadowResM = 10.0;
+    double shadowSiteCorr = 0.5;
+
+    // interference pruning by received power (see urbano-interference-pruning.h)
+    bool interferencePrune = false;
+    double pruneThresholdDb = -20.0;
+    double pruneMarginDb = 30.0;   // beamforming gain (gNB + UE arrays) is not in the estimate
+    double pruneMoveM = 10.0;
+
+    // fast PHY: SINR->BLER tables instead of the exact error model (see urbano-fast-phy.h)
+    bool fastPhy = false;
+    std::string fastPhyCache = "nr-fastphy.tbl";
+    bool phyTraces = false;
+
+    // beam cache per gNB/UE pair (see urbano-beam-cache.h)
+    bool beamCache = false;
+    double beamCacheDeg = 1.0;
+
+    // KPIs em janelas (substitui o XML completo do FlowMonitor)
+    uint32_t kpiWindowMs = 100;
+    std::string kpiFile = "nr-6g-urbano-kpi.csv";
+    bool kpiPerFlow = true;
+    bool flowmonXml = false;
+    bool flowmonColumnar = true;
+    bool flowmonHistograms = false;
+    std::string profileFile = "nr-6g-urbano-profile.json";
+    bool eventProfile = false;
+    uint32_t eventProfileStride = 1;
+
+    // staged attach waves per sector (see urbano-attach-scheduler.h)
+    std::string attachMode = "all";
+    uint32_t attachWaveSize = 8;
+    uint32_t attachWaveMs = 20;
+    uint32_t attachStartMs = 10;
+    bool idealRrc = true;
+    bool bulkBuild = true;
+
+    // warm-up before traffic (2 s): full = simulated; fast = see urbano-warmup.h
+    std::string warmup = "full";
+    uint32_t warmupGuardMs = 50;
+
+    // FlowMonitor on a stratified UE sample (see urbano-flow-sampling.h): 1 = all
+    double flowSample = 1.0;
+    uint32_t flowSampleRings = 3;
+
+    // sequential stopping (see urbano-sequential-stop.h): 0 = run the whole simTime
+    double stopRelHw = 0.0;
+    uint32_t stopBatchMs = 1000;
+    uint32_t stopMinBatches = 10;
+    std::string stopKpis = "thr,delay,loss";
+    bool stopPerSector = false;
+
+    // UE mobility: walk = RandomWalk2d; batched = see urbano-batched-mobility.h
+    std::string ueMobility = "walk";
+    uint32_t mobilityTickMs = 1000;
+    double mobilityNotifyM = 5.0;   // well above one tick's step (1 m/s x 1 s = 1 m): no notification every tick
+
     CommandLine cmd;
     cmd.AddValue("ueCount", "Number of UEs", ueCount);
+    cmd.AddValue("simTime", "Simulation time (s)", simTime);
+    cmd.AddValue("rows", "Hex grid rows (sites)", rows);
+    cmd.AddValue("cols", "Hex grid columns (sites)", cols);
+    cmd.AddValue("isd", "Inter-site distance (m)", isd);
+    cmd.AddValue("areaX", "Width (m) of the UE area", areaX);
+    cmd.AddValue("areaY", "Height (m) of the UE area", areaY);
+    cmd.AddValue("bandwidth", "Channel bandwidth (Hz)", bandwidth);
+    cmd.AddValue("rngRun", "RNG run number (seed fixed at 1)", rngRun);
+    cmd.AddValue("trafficApp", "Traffic generator: busy-hour Web/Video/VoIP mix (mix), one multi-flow CBR app on the PGW (multiflow) or one OnOff per UE (onoff)", trafficApp);
+    cmd.AddValue("mixWeb", "Share (%) of Web/TCP UEs (1-4 Mb bursts every 3-6 s)", mixWeb);
+    cmd.AddValue("mixVideo", "Share (%) of 1 Mb/s CBR video UEs", mixVideo);
+    cmd.AddValue("mixVoip", "Share (%) of 24 kb/s @ 20 ms VoIP UEs", mixVoip);
+    cmd.AddValue("spatialIndex", "Use the grid index for collision nudge and closest-cell attach", spatialIndex);
+    cmd.AddValue("shadowing", "Shadowing: link (3GPP, state per gNB-UE pair), map (correlated 2D field per site, O(1) lookup by position) or off", shadowing);
+    cmd.AddValue("shadowSigma", "Shadowing standard deviation (dB) for the map", shadowSigma);
+    cmd.AddValue("shadowDecorrM", "Shadowing decorrelation distance (m) for the map", shadowDecorrM);
+    cmd.AddValue("shadowResM", "Shadowing map grid resolution (m)", shadowResM);
+    cmd.AddValue("shadowSiteCorr", "Shadowing correlation between sites for the map", shadowSiteCorr);
+    cmd.AddValue("interferencePrune", "Skip tx->rx signals whose estimated received power is below noise + pruneThresholdDb", interferencePrune);
+    cmd.AddValue("pruneThresholdDb", "Minimum received power relative to noise (dB) for pruning", pruneThresholdDb);
+    cmd.AddValue("pruneMarginDb", "Margin (dB) added to the pruning estimate (beamforming gain, fading)", pruneMarginDb);
+    cmd.AddValue("pruneMoveM", "UE displacement (m) that re-evaluates its pruning candidates", pruneMoveM);
+    cmd.AddValue("fastPhy", "Table lookup for TB decoding and CQI (effective SINR -> BLER per MCS) instead of the exact error model", fastPhy);
+    cmd.AddValue("fastPhyCache", "File the fast-PHY tables are loaded from / saved to; empty = rebuild every run", fastPhyCache);
+    cmd.AddValue("phyTraces", "Write the NR per-TB reception trace (RxPacketTrace.txt: size, MCS, rv, SINR, corrupt, TBLER); used by urbano_fastphy_bench.py", phyTraces);
+    cmd.AddValue("beamCache", "Reuse each gNB/UE beam pair until the UE moves more than beamCacheDeg as seen from the gNB", beamCache);
+    cmd.AddValue("beamCacheDeg", "Angular change (deg) that invalidates a cached beam pair", beamCacheDeg);
+    cmd.AddValue("kpiWindowMs", "KPI window length (ms of simulated time)", kpiWindowMs);
+    cmd.AddValue("kpiFile", "Append-only CSV with the windowed KPI series", kpiFile);
+    cmd.AddValue("kpiPerFlow", "Also record per-flow rows besides per-sector rows", kpiPerFlow);
+    cmd.AddValue("flowmonXml", "Also write the full FlowMonitor XML at the end", flowmonXml);
+    cmd.AddValue("flowmonColumnar", "Write FlowStats/probes to the columnar .ufsc file", flowmonColumnar);
+    cmd.AddValue("flowmonHistograms", "Include histograms in the columnar file", flowmonHistograms);
+    cmd.AddValue("profileFile", "Per-phase profiler JSON report", profileFile);
+    cmd.AddValue("eventProfile", "Instrumented scheduler: cost per event type and sim/wall time ratio", eventProfile);
+    cmd.AddValue("eventProfileStride", "Time 1 out of N events in the event profiler", eventProfileStride);
+    cmd.AddValue("attachMode", "Attach all UEs at t=0 (all) or in per-sector waves (staged)", attachMode);
+    cmd.AddValue("attachWaveSize", "UEs per sector in each attach wave", attachWaveSize);
+    cmd.AddValue("attachWaveMs", "Interval (ms) between attach waves", attachWaveMs);
+    cmd.AddValue("attachStartMs", "Time (ms) of the first attach wave", attachStartMs);
+    cmd.AddValue("idealRrc", "Ideal RRC (no RRC messages over the air); false = real RRC", idealRrc);
+    cmd.AddValue("bulkBuild", "Build sectors in bulk (urbano-topology-builder.h); false = one sector at a time", bulkBuild);
+    cmd.AddValue("warmup", "Pre-traffic warm-up: full (2 s simulated) or fast (run only until UEs connect, mobility advanced analytically)", warmup);
+    cmd.AddValue("warmupGuardMs", "Gap (ms) between the last UE connecting and traffic start in fast warm-up", warmupGuardMs);
+    cmd.AddValue("flowSample", "Fraction of UEs monitored, stratified by sector and distance ring (network KPIs extrapolated with CIs); 1 = FlowMonitor on all", flowSample);
+    cmd.AddValue("flowSampleRings", "Distance rings (up to ISD/2) used to stratify the sample", flowSampleRings);
+    cmd.AddValue("stopRelHw", "Stop once the relative 95% CI half-width of every target KPI is below this value (simTime becomes a cap); 0 = off", stopRelHw);
+    cmd.AddValue("stopBatchMs", "Length (ms) of each batch for batch means", stopBatchMs);
+    cmd.AddValue("stopMinBatches", "Minimum batches before testing convergence", stopMinBatches);
+    cmd.AddValue("stopKpis", "Target KPIs for stopping: thr,delay,loss", stopKpis);
+    cmd.AddValue("stopPerSector", "Also require convergence in every sector", stopPerSector);
+    cmd.AddValue("ueMobility", "UE mobility: walk (RandomWalk2d, one event per leg) or batched (batched state, positions on demand)", ueMobility);
+    cmd.AddValue("mobilityTickMs", "Period (ms) of the batched mobility update", mobilityTickMs);
+    cmd.AddValue("mobilityNotifyM", "Displacement (m) that fires CourseChange with batched mobility", mobilityNotifyM);
     cmd.Parse(argc, argv);
 
+    const uint32_t rank = UrbanoMpi::Rank();
+    kpiFile = UrbanoMpi::FileName(kpiFile);
+    profileFile = UrbanoMpi::FileName(profileFile);
+
     // reproducibilidade
     RngSeedManager::SetSeed(1);
-    RngSeedManager::SetRun(1);
+    RngSeedManager::SetRun(rngRun + 1000 * rank); // rank 0 = serial run
+
+    // wall/CPU/RSS/objects/events per phase
+    PhaseProfiler prof("nr-6g-urbano", profileFile);
+    if (eventProfile)
+    {
+        EnableEventProfiler("nr-6g-urbano", eventProfileStride);
+    }
+    prof.Begin("helpers/epc");
 
     // Helpers
     Ptr<NrHelper> nr = CreateObject<NrHelper>();
     Ptr<NrPointToPointEpcHelper> epc = CreateObject<NrPointToPointEpcHelper>();
     nr->SetEpcHelper(epc);
+    nr->SetAttribute("UseIdealRrc", BooleanValue(idealRrc));
 
-    Ptr<IdealBeamformingHelper> bf = CreateObject<IdealBeamformingHelper>();
+    Ptr<IdealBeamformingHelper> bf;
+    if (beamCache)
+    {
+        bf = CreateObjectWithAttributes<CachedIdealBeamformingHelper>("AngularThreshold", DoubleValue(beamCacheDeg));
+    }
+    else
+    {
+        bf = CreateObject<IdealBeamformingHelper>();
+    }
     nr->SetBeamformingHelper(bf);
 
     // Core / internet
@@ -109,6 +292,7 @@ int main(int argc, char *argv[])
     internet.Install(pgw);
 
     // BAND / BWP
+    prof.Begin("band init");
     CcBwpCreator ccBwp;
     CcBwpCreator::SimpleOperationBandConf bandConf;
     bandConf.m_centralFrequency = centralFreq;
@@ -123,40 +307,97 @@ int main(int argc, char *argv[])
     BandwidthPartInfoPtrVector allBwps = CcBwpCreator::GetAllBwps(bands);
 
     // Inicializa modelos (propagação / fading / canal)
+    NS_ABORT_MSG_IF(shadowing != "link" && shadowing != "map" && shadowing != "off",
+                    "shadowing must be link, map or off");
+    Config::SetDefault("ns3::ThreeGppPropagationLossModel::ShadowingEnabled",
+                       BooleanValue(shadowing == "link"));
     nr->InitializeOperationBand(&band);
 
     // Scheduler + atributos leves
     nr->SetSchedulerTypeId(TypeId::LookupByName("ns3::NrMacSchedulerTdmaPF"));
-    nr->SetPathlossAttribute("ShadowingEnabled", BooleanValue(true));
+    nr->SetPathlossAttribute("ShadowingEnabled", BooleanValue(shadowing == "link"));
+    if (fastPhy)
+    {
+        // tables generated from the default error model (NrLteMiErrorModel)
+        Config::SetDefault("ns3::NrFastPhyErrorModel::CacheFile", StringValue(fastPhyCache));
+        nr->SetDlErrorModel("ns3::NrFastPhyErrorModel");
+        nr->SetUlErrorModel("ns3::NrFastPhyErrorModel");
+    }
 
     // SITES
-    NodeContainer sites; sites.Create(rows * cols);
+    prof.Begin("cell install");
     auto centers = MakeHexGrid(rows, cols, isd);
-    MobilityHelper mh;
-    Ptr<ListPositionAllocator> alloc = CreateObject<ListPositionAllocator>();
-    for (auto &v : centers) alloc->Add(v);
-    mh.SetPositionAllocator(alloc);
-    mh.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-    mh.Install(sites);
+    // this rank's site cluster and UE region (1 rank = whole grid)
+    SitePartition part = PartitionSites(centers, Rectangle(0, areaX, 0, areaY),
+                                        UrbanoMpi::Size(), ueCount)[rank];
+    NodeContainer sites; sites.Create(part.sites.size());
+    std::vector<Vector> sitePos;
+    for (uint32_t s : part.sites) sitePos.push_back(centers[s]);
+    InstallConstantPositions(sites, sitePos);
 
     // GNBs
     NodeContainer gnbNodes;
     NetDeviceContainer gnbDevs;
-    CreateTriSectorGnbs(nr, allBwps, sites, gnbNodes, gnbDevs);
+    if (bulkBuild)
+    {
+        CreateTriSectorGnbsBulk(nr, allBwps, sites, gnbNodes, gnbDevs);
+    }
+    else
+    {
+        CreateTriSectorGnbs(nr, allBwps, sites, gnbNodes, gnbDevs);
+    }
+
+    // shadowing map: one model in front of each BWP channel chain (AddPropagationLossModel
+    // relinks the model with SetNext), all sharing the same fields
+    Ptr<ShadowingMapPropagationLossModel> shadow;
+    if (shadowing == "map")
+    {
+        shadow = CreateObjectWithAttributes<ShadowingMapPropagationLossModel>(
+            "Sigma", DoubleValue(shadowSigma),
+            "DecorrelationDistance", DoubleValue(shadowDecorrM),
+            "Resolution", DoubleValue(shadowResM),
+            "InterSiteCorrelation", DoubleValue(shadowSiteCorr),
+            "Bounds", RectangleValue(part.region));
+        for (const Vector& c : sitePos) shadow->AddSite(c);
+        for (size_t i = 0; i < allBwps.size(); i++)
+        {
+            allBwps[i].get()->m_channel->AddPropagationLossModel(i == 0 ? shadow : shadow->Share());
+        }
+    }
+
+    // interference pruning: one filter per BWP channel, estimated with the channel's loss chain
+    std::vector<Ptr<ReceivedPowerTransmitFilter>> prune;
+    if (interferencePrune)
+    {
+        for (const auto& bwp : allBwps)
+        {
+            prune.push_back(InstallInterferencePruning(bwp.get()->m_channel, pruneThresholdDb, pruneMarginDb, pruneMoveM));
+        }
+    }
 
     // UEs
-    NodeContainer ueNodes; ueNodes.Create(ueCount);
+    prof.Begin("ue install");
+    NodeContainer ueNodes; ueNodes.Create(part.ueCount);
     internet.Install(ueNodes);
 
-    MobilityHelper ueMob;
-    ueMob.SetPositionAllocator("ns3::RandomRectanglePositionAllocator",
-                               "X", StringValue("ns3::UniformRandomVariable[Min=0|Max=3000]"),
-                               "Y", StringValue("ns3::UniformRandomVariable[Min=0|Max=3000]"));
-    ueMob.SetMobilityModel("ns3::RandomWalk2dMobilityModel",
-                           "Bounds", RectangleValue(Rectangle(0, 3000, 0, 3000)),
-                           "Speed", StringValue("ns3::ConstantRandomVariable[Constant=1]"),
-                           "Distance", DoubleValue(5.0));
-    ueMob.Install(ueNodes);
+    // positions drawn in one go (same sequence as MobilityHelper), models in one pass
+    ObjectFactory uePos("ns3::RandomRectanglePositionAllocator");
+    uePos.Set("X", StringValue("ns3::UniformRandomVariable[Min=" + std::to_string(part.region.xMin) +
+                               "|Max=" + std::to_string(part.region.xMax) + "]"),
+              "Y", StringValue("ns3::UniformRandomVariable[Min=" + std::to_string(part.region.yMin) +
+                               "|Max=" + std::to_string(part.region.yMax) + "]"));
+    NS_ABORT_MSG_IF(ueMobility != "walk" && ueMobility != "batched", "ueMobility must be walk or batched");
+    ObjectFactory ueModel(ueMobility == "batched" ? "ns3::BatchedRandomWalk2dMobilityModel"
+                                                  : "ns3::RandomWalk2dMobilityModel");
+    ueModel.Set("Bounds", RectangleValue(part.region),
+                "Speed", StringValue("ns3::ConstantRandomVariable[Constant=1]"),
+                "Distance", DoubleValue(5.0));
+    if (ueMobility == "batched")
+    {
+        Config::SetDefault("ns3::BatchedWalkEngine::UpdateInterval", TimeValue(MilliSeconds(mobilityTickMs)));
+        ueModel.Set("NotifyThreshold", DoubleValue(mobilityNotifyM));
+    }
+    InstallMobility(ueNodes, DrawPositions(uePos.Create<PositionAllocator>(), ueNodes.GetN()), ueModel);
 
     // Install devices
     NetDeviceContainer ueDevs = nr->InstallUeDevice(ueNodes, allBwps);
@@ -170,14 +411,38 @@ int main(int argc, char *argv[])
     {
         DynamicCast<NrUeNetDevice>(*it)->UpdateConfig();
     }
+    if (phyTraces)
+    {
+        // one fixed file name per process: not split per MPI rank
+        NS_ABORT_MSG_IF(UrbanoMpi::Size() > 1, "phyTraces is not supported with MPI partitioning");
+        nr->EnableTransportBlockTrace();
+    }
 
+    prof.Begin("attach");
     // SANITY CHECK: evita posições exatamente iguais entre UE e gNB
     // se distância < eps (0.1m), aplica nudge pequeno
     const double eps = 0.1;
+    auto setupStart = std::chrono::steady_clock::now();
+    // índice só quando pedido; sem ele, setor mais próximo por busca linear
+    UniformGridIndex gnbIndex;
+    if (spatialIndex)
+    {
+        gnbIndex = UniformGridIndex::FromNodes(gnbNodes, isd);
+    }
     for (uint32_t ui = 0; ui < ueNodes.GetN(); ++ui)
     {
         Ptr<MobilityModel> um = ueNodes.Get(ui)->GetObject<MobilityModel>();
         Vector up = um->GetPosition();
+        if (spatialIndex)
+        {
+            size_t hits = gnbIndex.Within(up, eps).size();
+            for (size_t k = 0; k < hits; ++k)
+            {
+                double jitter = 0.5 + (0.5 * (double) (std::rand() % 100) / 100.0);
+                um->SetPosition(Vector(up.x + jitter, up.y + jitter, up.z));
+            }
+            continue;
+        }
         for (uint32_t gi = 0; gi < gnbNodes.GetN(); ++gi)
         {
             Ptr<MobilityModel> gm = gnbNodes.Get(gi)->GetObject<MobilityModel>();
@@ -198,37 +463,213 @@ int main(int argc, char *argv[])
     // endereçamento
     Ipv4InterfaceContainer ueIfaces = epc->AssignUeIpv4Address(ueDevs);
 
-    // Attach
-    nr->AttachToClosestEnb(ueDevs, gnbDevs);
+    // Attach ao setor mais próximo (mesmo critério do AttachToClosestEnb),
+    // todos já ou em ondas por setor
+    auto nearestGnb = [&](uint32_t ui) {
+        Vector up = ueNodes.Get(ui)->GetObject<MobilityModel>()->GetPosition();
+        return spatialIndex ? gnbIndex.Nearest(up) : NearestNode(gnbNodes, up);
+    };
+    StagedAttach attach(
+        ueDevs,
+        [&](uint32_t ui) {
+            if (spatialIndex)
+            {
+                nr->AttachToEnb(ueDevs.Get(ui), gnbDevs.Get(nearestGnb(ui)));
+            }
+            else
+            {
+                nr->AttachToClosestEnb(NetDeviceContainer(ueDevs.Get(ui)), gnbDevs);
+            }
+        },
+        [](Ptr<NetDevice> d) { return DynamicCast<NrUeNetDevice>(d)->GetRrc(); });
+    if (attachMode == "staged")
+    {
+        attach.Staged(nearestGnb, attachWaveSize, MilliSeconds(attachStartMs), MilliSeconds(attachWaveMs));
+    }
+    else
+    {
+        attach.Immediate();
+    }
+    std::cout << "[SETUP] nudge + attach de " << ueNodes.GetN() << " UEs em " << gnbNodes.GetN()
+              << " setores: "
+              << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - setupStart).count()
+              << " ms (" << (spatialIndex ? "índice espacial" : "força bruta") << ")" << std::endl;
+
+    // warm-up: em fast o Run vai só até a conexão e o tráfego é instalado depois
+    WarmupFastForward warm(Seconds(2.0), MilliSeconds(warmupGuardMs));
+    if (warmup == "fast")
+    {
+        prof.Begin("warmup");
+        warm.Run(attach, ueNodes);
+    }
+    const Time trafficStart = warm.GetTrafficStart();
+    const Time trafficStop = trafficStart + Seconds(simTime - 2.0);
 
     // Aplicações: menos estresse por UE
+    prof.Begin("apps");
     ApplicationContainer apps;
     uint16_t port = 9000;
-    for (uint32_t i = 0; i < ueNodes.GetN(); i++)
+
+    TrafficMixConfig mixCfg;
+    mixCfg.webShare = mixWeb / 100.0;
+    mixCfg.videoShare = mixVideo / 100.0;
+    mixCfg.voipShare = mixVoip / 100.0;
+    mixCfg.videoPktSize = 512;
+    TrafficMix mix(mixCfg);
+
+    if (trafficApp == "mix")
+    {
+        apps = mix.Install(pgw, ueNodes, ueIfaces, port);
+    }
+    else if (trafficApp == "multiflow")
+    {
+        // um único cliente no PGW + sink leve por UE (mesma taxa/tamanho e ciclo on/off do OnOff)
+        apps = InstallMultiFlowTraffic(pgw, ueNodes, ueIfaces, port, DataRate("1Mb/s"), 512);
+    }
+    else
     {
-        PacketSinkHelper sink("ns3::UdpSocketFactory",
-                              InetSocketAddress(Ipv4Address::GetAny(), port));
-        apps.Add(sink.Install(ueNodes.Get(i)));
+        for (uint32_t i = 0; i < ueNodes.GetN(); i++)
+        {
+            PacketSinkHelper sink("ns3::UdpSocketFactory",
+                                  InetSocketAddress(Ipv4Address::GetAny(), port));
+            apps.Add(sink.Install(ueNodes.Get(i)));
 
-        OnOffHelper onoff("ns3::UdpSocketFactory",
-                          InetSocketAddress(ueIfaces.GetAddress(i), port));
-        onoff.SetAttribute("DataRate", DataRateValue(DataRate("1Mb/s"))); // mais leve
-        onoff.SetAttribute("PacketSize", UintegerValue(512));
-        apps.Add(onoff.Install(pgw));
+            OnOffHelper onoff("ns3::UdpSocketFactory",
+                              InetSocketAddress(ueIfaces.GetAddress(i), port));
+            onoff.SetAttribute("DataRate", DataRateValue(DataRate("1Mb/s"))); // mais leve
+            onoff.SetAttribute("PacketSize", UintegerValue(512));
+            apps.Add(onoff.Install(pgw));
 
-        port++;
+            port++;
+        }
     }
-    apps.Start(Seconds(2.0));
-    apps.Stop(Seconds(simTime));
+    apps.Start(trafficStart - Simulator::Now());
+    apps.Stop(trafficStop - Simulator::Now());
 
     // FlowMonitor
+    prof.Begin("flowmon");
     FlowMonitorHelper fm;
-    Ptr<FlowMonitor> monitor = fm.InstallAll();
+    Ptr<FlowMonitor> monitor;
+    // o registro em janelas só precisa dos contadores: sem XML/histogramas no
+    // fim, monitor enxuto (um bin por histograma, sondas só nas pontas)
+    const bool leanMonitor = !flowmonXml && !flowmonHistograms;
+    if (leanMonitor)
+    {
+        NarrowFlowMonitor(fm);
+    }
+    // amostra: estrato = setor mais próximo x anel de distância a ele
+    FlowSample sample(ueNodes, ueIfaces, nearestGnb,
+                      [&](uint32_t ui) {
+                          Vector up = ueNodes.Get(ui)->GetObject<MobilityModel>()->GetPosition();
+                          Vector gp = gnbNodes.Get(nearestGnb(ui))->GetObject<MobilityModel>()->GetPosition();
+                          return std::hypot(up.x - gp.x, up.y - gp.y);
+                      },
+                      isd / (2.0 * flowSampleRings), flowSampleRings);
+    if (flowSample < 1.0)
+    {
+        sample.Draw(flowSample, CreateObject<UniformRandomVariable>());
+        monitor = sample.Install(fm, pgw);
+    }
+    else if (leanMonitor)
+    {
+        monitor = InstallEndpointFlowMonitor(fm, pgw, ueNodes);
+    }
+    else
+    {
+        monitor = fm.InstallAll();
+    }
+
+    KpiWindowRecorder kpi(monitor,
+                          DynamicCast<Ipv4FlowClassifier>(fm.GetClassifier()),
+                          kpiFile,
+                          MilliSeconds(kpiWindowMs),
+                          kpiPerFlow);
+    kpi.SetSectorResolver(MakeCellIdResolver(ueIfaces, ueDevs, [](Ptr<NetDevice> d) -> uint16_t {
+        return DynamicCast<NrUeNetDevice>(d)->GetRrc()->GetCellId();
+    }));
+    kpi.Start(trafficStart);
+
+    // médias por lote sobre as janelas do registro de KPIs
+    SequentialStopConfig stopCfg;
+    stopCfg.relHalfWidth = stopRelHw;
+    stopCfg.batchWindows = std::max<uint32_t>(1, stopBatchMs / kpiWindowMs);
+    stopCfg.minBatches = stopMinBatches;
+    stopCfg.kpis = stopKpis;
+    stopCfg.perSector = stopPerSector;
+    SequentialStop stop(stopCfg, UrbanoMpi::FileName("nr-6g-urbano-stop.csv"));
+    if (stopRelHw > 0)
+    {
+        stop.Attach(kpi);
+    }
 
-    Simulator::Stop(Seconds(simTime));
+    Simulator::Stop(trafficStop - Simulator::Now());
+    prof.Begin("run");
     Simulator::Run();
+    prof.Begin("export");
+    // janela medida: até simTime ou até a parada sequencial
+    const Time measured = Simulator::Now() - trafficStart;
+    ProfilingScheduler::Report();
+    attach.Report();
+    if (stopRelHw > 0)
+    {
+        stop.Report();
+    }
+    BatchedWalkEngine::Report();
+    NrFastPhyErrorModel::Report();
+    if (Ptr<CachedIdealBeamformingHelper> bc = DynamicCast<CachedIdealBeamformingHelper>(bf))
+    {
+        bc->Report();
+    }
+    if (shadow)
+    {
+        shadow->Report();
+    }
+    for (size_t i = 0; i < prune.size(); i++)
+    {
+        prune[i]->Report("BWP " + std::to_string(i));
+    }
 
-    monitor->SerializeToXmlFile("nr-6g-urbano-metrics.xml", true, true);
+    kpi.Finish();
+    if (flowSample < 1.0)
+    {
+        sample.Report(monitor,
+                      DynamicCast<Ipv4FlowClassifier>(fm.GetClassifier()),
+                      measured,
+                      UrbanoMpi::FileName("nr-6g-urbano-sample.csv"));
+    }
+    if (trafficApp == "mix")
+    {
+        mix.Report(monitor,
+                   DynamicCast<Ipv4FlowClassifier>(fm.GetClassifier()),
+                   measured,
+                   UrbanoMpi::FileName("nr-6g-urbano-classes.csv"));
+    }
+    // exportação final: ambos os caminhos são cronometrados para comparação
+    if (flowmonXml)
+    {
+        TimedExport("xml", UrbanoMpi::FileName("nr-6g-urbano-metrics.xml"), [&]() {
+            monitor->SerializeToXmlFile(UrbanoMpi::FileName("nr-6g-urbano-metrics.xml"), true, true);
+        });
+    }
+    if (flowmonColumnar)
+    {
+        TimedExport("columnar", UrbanoMpi::FileName("nr-6g-urbano-metrics.ufsc"), [&]() {
+            WriteFlowStatsColumnar(monitor,
+                                   DynamicCast<Ipv4FlowClassifier>(fm.GetClassifier()),
+                                   UrbanoMpi::FileName("nr-6g-urbano-metrics.ufsc"),
+                                   flowmonHistograms);
+        });
+    }
+    ReportMpiTotals(monitor,
+                    prof.GetWallS({"helpers/epc", "band init", "cell install", "ue install", "attach", "apps", "flowmon"}),
+                    prof.GetWallS({"warmup", "run"}),
+                    part.sites.size(),
+                    part.ueCount,
+                    measured.GetSeconds());
+
+    prof.Begin("destroy");
     Simulator::Destroy();
+    prof.Finish();
+    UrbanoMpi::Finalize();
     return 0;
 }
@@ -0,0 +1,657 @@
+// owc-channel.h
+// Canal e NetDevice ópticos sem fio (VLC/OWC) para vários enlaces num só Run.
+//  OwcChannel: meio compartilhado por luminárias e receptores. O ganho DC do
+//   enlace tx->rx é o LOS Lambertiano, calculado na hora a partir das posições
+//   (MobilityModel) e das orientações dos dois lados:
+//     H = (m+1) A / (2 pi d^2) cos^m(phi) cos(psi),  psi <= FOV (senão 0)
+//     m = -ln 2 / ln(cos(semi-ângulo de meia potência))
+//   (sem filtro óptico nem concentrador). SNR elétrico = (R H Pt)^2 / ruído e a
+//   taxa adaptada é min(MaxDataRate, B log2(1 + SNR/gap)), 0 abaixo de MinSnr.
+//  OwcNetDevice: cada quadro unicast sai na taxa adaptada do enlace até o
+//   destino naquele instante (broadcast/multicast, ex. ARP, na BroadcastDataRate
+//   e só para quem a decodifica); um quadro por vez por device, fila DropTail
+//   em pacotes. Não modela interferência entre luminárias nem acesso ao meio:
+//   cada transmissor é independente (full duplex).
+//  OwcHelper: instala os devices num canal comum; a orientação (Orientation)
+//   define quem é luminária (para baixo) e quem é receptor (para cima).
+
+#ifndef OWC_CHANNEL_H
+#define OWC_CHANNEL_H
+
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+
+#include <cmath>
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace ns3
+{
+
+class OwcNetDevice;
+
+class OwcChannel : public Channel
+{
+public:
+  static TypeId GetTypeId();
+
+  void Add(Ptr<OwcNetDevice> device);
+
+  std::size_t GetNDevices() const override
+  {
+    return m_devices.size();
+  }
+
+  Ptr<NetDevice> GetDevice(std::size_t i) const override;
+
+  // ganho DC LOS de tx para rx nas posições atuais (0 fora do FOV / atrás do LED)
+  double GetGain(Ptr<const OwcNetDevice> tx, Ptr<const OwcNetDevice> rx) const;
+
+  // SNR elétrico (linear) no receptor
+  double GetSnr(Ptr<const OwcNetDevice> tx, Ptr<const OwcNetDevice> rx) const;
+
+  // taxa adaptada (bit/s) do enlace; 0 se o SNR está abaixo de MinSnr
+  double GetRate(Ptr<const OwcNetDevice> tx, Ptr<const OwcNetDevice> rx) const;
+
+  Ptr<OwcNetDevice> Find(Mac48Address address) const;
+
+  // entrega o quadro aos receptores ao fim da transmissão (+ atraso de propagação)
+  void Send(Ptr<Packet> packet,
+            uint16_t protocol,
+            Mac48Address to,
+            Mac48Address from,
+            Ptr<OwcNetDevice> sender,
+            double rateBps,
+            Time txTime);
+
+private:
+  std::vector<Ptr<OwcNetDevice>> m_devices;
+  std::map<Mac48Address, Ptr<OwcNetDevice>> m_byAddress;
+  double m_bandwidth;
+  double m_snrGapDb;
+  double m_minSnrDb;
+};
+
+class OwcNetDevice : public NetDevice
+{
+public:
+  static TypeId GetTypeId()
+  {
+    static TypeId tid =
+        TypeId("ns3::OwcNetDevice")
+            .SetParent<NetDevice>()
+            .SetGroupName("Network")
+            .AddConstructor<OwcNetDevice>()
+            .AddAttribute("TxPower",
+                          "Potência óptica transmitida (W)",
+                          DoubleValue(1.0),
+                          MakeDoubleAccessor(&OwcNetDevice::m_txPower),
+                          MakeDoubleChecker<double>(0.0))
+            .AddAttribute("SemiAngle",
+                          "Semi-ângulo de meia potência do LED (graus)",
+                          DoubleValue(60.0),
+                          MakeDoubleAccessor(&OwcNetDevice::m_semiAngleDeg),
+                          MakeDoubleChecker<double>(1.0, 89.0))
+            .AddAttribute("Orientation",
+                          "Normal do LED/fotodetector (não precisa ser unitária)",
+                          VectorValue(Vector(0, 0, -1)),
+                          MakeVectorAccessor(&OwcNetDevice::m_orientation),
+                          MakeVectorChecker())
+            .AddAttribute("DetectorArea",
+                          "Área do fotodetector (m^2)",
+                          DoubleValue(1e-4),
+                          MakeDoubleAccessor(&OwcNetDevice::m_area),
+                          MakeDoubleChecker<double>(0.0))
+            .AddAttribute("FieldOfView",
+                          "Campo de visão do receptor (graus)",
+                          DoubleValue(70.0),
+                          MakeDoubleAccessor(&OwcNetDevice::m_fovDeg),
+                          MakeDoubleChecker<double>(0.0, 90.0))
+            .AddAttribute("Responsivity",
+                          "Responsividade do fotodetector (A/W)",
+                          DoubleValue(0.54),
+                          MakeDoubleAccessor(&OwcNetDevice::m_responsivity),
+                          MakeDoubleChecker<double>(0.0))
+            .AddAttribute("NoisePower",
+                          "Variância total do ruído (A^2)",
+                          DoubleValue(1e-14),
+                          MakeDoubleAccessor(&OwcNetDevice::m_noise),
+                          MakeDoubleChecker<double>(0.0))
+            .AddAttribute("MaxDataRate",
+                          "Teto da taxa adaptada",
+                          DataRateValue(DataRate("100Mbps")),
+                          MakeDataRateAccessor(&OwcNetDevice::m_maxRate),
+                          MakeDataRateChecker())
+            .AddAttribute("BroadcastDataRate",
+                          "Taxa dos quadros broadcast/multicast (ARP)",
+                          DataRateValue(DataRate("1Mbps")),
+                          MakeDataRateAccessor(&OwcNetDevice::m_broadcastRate),
+                          MakeDataRateChecker())
+            .AddAttribute("MaxQueuePackets",
+                          "Tamanho da fila de transmissão (pacotes)",
+                          UintegerValue(100),
+                          MakeUintegerAccessor(&OwcNetDevice::m_maxQueue),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("Mtu",
+                          "MTU (bytes)",
+                          UintegerValue(1500),
+                          MakeUintegerAccessor(&OwcNetDevice::m_mtu),
+                          MakeUintegerChecker<uint16_t>())
+            .AddTraceSource("MacTx",
+                            "Pacote aceito para transmissão",
+                            MakeTraceSourceAccessor(&OwcNetDevice::m_macTxTrace),
+                            "ns3::Packet::TracedCallback")
+            .AddTraceSource("MacRx",
+                            "Pacote entregue à camada de cima",
+                            MakeTraceSourceAccessor(&OwcNetDevice::m_macRxTrace),
+                            "ns3::Packet::TracedCallback")
+            .AddTraceSource("PhyTxBegin",
+                            "Início de transmissão: pacote, taxa (bit/s), SNR (dB)",
+                            MakeTraceSourceAccessor(&OwcNetDevice::m_phyTxBeginTrace),
+                            "ns3::OwcNetDevice::TxBeginCallback")
+            .AddTraceSource("PhyTxDrop",
+                            "Descartado: fila cheia, destino desconhecido ou fora de alcance",
+                            MakeTraceSourceAccessor(&OwcNetDevice::m_phyTxDropTrace),
+                            "ns3::Packet::TracedCallback");
+    return tid;
+  }
+
+  typedef void (*TxBeginCallback)(Ptr<const Packet> packet, double rateBps, double snrDb);
+
+  OwcNetDevice()
+    : m_ifIndex(0),
+      m_linkUp(false),
+      m_transmitting(false)
+  {
+  }
+
+  void SetChannel(Ptr<OwcChannel> channel)
+  {
+    m_channel = channel;
+    m_channel->Add(this);
+    m_linkUp = true;
+    m_linkChanged();
+  }
+
+  Vector GetPosition() const
+  {
+    return m_node->GetObject<MobilityModel>()->GetPosition();
+  }
+
+  Vector GetOrientation() const
+  {
+    return m_orientation;
+  }
+
+  double GetTxPower() const
+  {
+    return m_txPower;
+  }
+
+  // ordem Lambertiana m do LED
+  double GetLambertianOrder() const
+  {
+    return -std::log(2.0) / std::log(std::cos(m_semiAngleDeg * M_PI / 180.0));
+  }
+
+  double GetDetectorArea() const
+  {
+    return m_area;
+  }
+
+  double GetFieldOfView() const
+  {
+    return m_fovDeg * M_PI / 180.0;
+  }
+
+  double GetResponsivity() const
+  {
+    return m_responsivity;
+  }
+
+  double GetNoisePower() const
+  {
+    return m_noise;
+  }
+
+  DataRate GetMaxDataRate() const
+  {
+    return m_maxRate;
+  }
+
+  DataRate GetBroadcastDataRate() const
+  {
+    return m_broadcastRate;
+  }
+
+  void Receive(Ptr<Packet> packet, uint16_t protocol, Mac48Address to, Mac48Address from)
+  {
+    PacketType type;
+    if (to == m_address)
+    {
+      type = PACKET_HOST;
+    }
+    else if (to.IsBroadcast())
+    {
+      type = PACKET_BROADCAST;
+    }
+    else if (to.IsGroup())
+    {
+      type = PACKET_MULTICAST;
+    }
+    else
+    {
+      type = PACKET_OTHERHOST;
+    }
+    if (!m_promiscCallback.IsNull())
+    {
+      m_promiscCallback(this, packet, protocol, from, to, type);
+    }
+    if (type != PACKET_OTHERHOST && !m_rxCallback.IsNull())
+    {
+      m_macRxTrace(packet);
+      m_rxCallback(this, packet, protocol, from);
+    }
+  }
+
+  // ---------- NetDevice ----------
+  void SetIfIndex(const uint32_t index) override
+  {
+    m_ifIndex = index;
+  }
+
+  uint32_t GetIfIndex() const override
+  {
+    return m_ifIndex;
+  }
+
+  Ptr<Channel> GetChannel() const override
+  {
+    return m_channel;
+  }
+
+  void SetAddress(Address address) override
+  {
+    m_address = Mac48Address::ConvertFrom(address);
+  }
+
+  Address GetAddress() const override
+  {
+    return m_address;
+  }
+
+  bool SetMtu(const uint16_t mtu) override
+  {
+    m_mtu = mtu;
+    return true;
+  }
+
+  uint16_t GetMtu() const override
+  {
+    return m_mtu;
+  }
+
+  bool IsLinkUp() const override
+  {
+    return m_linkUp;
+  }
+
+  void AddLinkChangeCallback(Callback<void> callback) override
+  {
+    m_linkChanged.ConnectWithoutContext(callback);
+  }
+
+  bool IsBroadcast() const override
+  {
+    return true;
+  }
+
+  Address GetBroadcast() const override
+  {
+    return Mac48Address::GetBroadcast();
+  }
+
+  bool IsMulticast() const override
+  {
+    return true;
+  }
+
+  Address GetMulticast(Ipv4Address group) const override
+  {
+    return Mac48Address::GetMulticast(group);
+  }
+
+  Address GetMulticast(Ipv6Address addr) const override
+  {
+    return Mac48Address::GetMulticast(addr);
+  }
+
+  bool IsPointToPoint() const override
+  {
+    return false;
+  }
+
+  bool IsBridge() const override
+  {
+    return false;
+  }
+
+  bool Send(Ptr<Packet> packet, const Address& dest, uint16_t protocolNumber) override
+  {
+    return SendFrom(packet, m_address, dest, protocolNumber);
+  }
+
+  bool SendFrom(Ptr<Packet> packet,
+                const Address& source,
+                const Address& dest,
+                uint16_t protocolNumber) override
+  {
+    if (!m_linkUp || m_queue.size() >= m_maxQueue)
+    {
+      m_phyTxDropTrace(packet);
+      return false;
+    }
+    m_macTxTrace(packet);
+    m_queue.push_back({packet,
+                       Mac48Address::ConvertFrom(source),
+                       Mac48Address::ConvertFrom(dest),
+                       protocolNumber});
+    if (!m_transmitting)
+    {
+      StartTransmission();
+    }
+    return true;
+  }
+
+  Ptr<Node> GetNode() const override
+  {
+    return m_node;
+  }
+
+  void SetNode(Ptr<Node> node) override
+  {
+    m_node = node;
+  }
+
+  bool NeedsArp() const override
+  {
+    return true;
+  }
+
+  void SetReceiveCallback(NetDevice::ReceiveCallback cb) override
+  {
+    m_rxCallback = cb;
+  }
+
+  void SetPromiscReceiveCallback(NetDevice::PromiscReceiveCallback cb) override
+  {
+    m_promiscCallback = cb;
+  }
+
+  bool SupportsSendFrom() const override
+  {
+    return true;
+  }
+
+protected:
+  void DoDispose() override
+  {
+    m_channel = nullptr;
+    m_node = nullptr;
+    m_queue.clear();
+    m_rxCallback = NetDevice::ReceiveCallback();
+    m_promiscCallback = NetDevice::PromiscReceiveCallback();
+    NetDevice::DoDispose();
+  }
+
+private:
+  struct Frame
+  {
+    Ptr<Packet> packet;
+    Mac48Address from;
+    Mac48Address to;
+    uint16_t protocol;
+  };
+
+  // próximo quadro da fila, na taxa do enlace até o destino neste instante
+  void StartTransmission()
+  {
+    while (!m_queue.empty())
+    {
+      Frame f = m_queue.front();
+      m_queue.pop_front();
+      double rate = 0;
+      double snr = 0;
+      if (f.to.IsGroup())
+      {
+        rate = m_broadcastRate.GetBitRate();
+      }
+      else if (Ptr<OwcNetDevice> dst = m_channel->Find(f.to))
+      {
+        rate = m_channel->GetRate(this, dst);
+        snr = m_channel->GetSnr(this, dst);
+      }
+      if (rate <= 0)
+      {
+        m_phyTxDropTrace(f.packet);
+        continue;
+      }
+      Time txTime = Seconds(f.packet->GetSize() * 8.0 / rate);
+      m_transmitting = true;
+      m_phyTxBeginTrace(f.packet, rate, snr > 0 ? 10 * std::log10(snr) : 0.0);
+      m_channel->Send(f.packet, f.protocol, f.to, f.from, this, rate, txTime);
+      Simulator::Schedule(txTime, &OwcNetDevice::TransmitComplete, this);
+      return;
+    }
+  }
+
+  void TransmitComplete()
+  {
+    m_transmitting = false;
+    StartTransmission();
+  }
+
+  Ptr<OwcChannel> m_channel;
+  Ptr<Node> m_node;
+  Mac48Address m_address;
+  uint32_t m_ifIndex;
+  uint16_t m_mtu;
+  bool m_linkUp;
+  bool m_transmitting;
+  std::deque<Frame> m_queue;
+  uint32_t m_maxQueue;
+
+  double m_txPower;
+  double m_semiAngleDeg;
+  Vector m_orientation;
+  double m_area;
+  double m_fovDeg;
+  double m_responsivity;
+  double m_noise;
+  DataRate m_maxRate;
+  DataRate m_broadcastRate;
+
+  NetDevice::ReceiveCallback m_rxCallback;
+  NetDevice::PromiscReceiveCallback m_promiscCallback;
+  TracedCallback<> m_linkChanged;
+  TracedCallback<Ptr<const Packet>> m_macTxTrace;
+  TracedCallback<Ptr<const Packet>> m_macRxTrace;
+  TracedCallback<Ptr<const Packet>, double, double> m_phyTxBeginTrace;
+  TracedCallback<Ptr<const Packet>> m_phyTxDropTrace;
+};
+
+// ---------- OwcChannel ----------
+inline TypeId
+OwcChannel::GetTypeId()
+{
+  static TypeId tid = TypeId("ns3::OwcChannel")
+                          .SetParent<Channel>()
+                          .SetGroupName("Network")
+                          .AddConstructor<OwcChannel>()
+                          .AddAttribute("Bandwidth",
+                                        "Banda de modulação do LED (Hz)",
+                                        DoubleValue(20e6),
+                                        MakeDoubleAccessor(&OwcChannel::m_bandwidth),
+                                        MakeDoubleChecker<double>(0.0))
+                          .AddAttribute("SnrGap",
+                                        "Gap (dB) para a capacidade de Shannon",
+                                        DoubleValue(0.0),
+                                        MakeDoubleAccessor(&OwcChannel::m_snrGapDb),
+                                        MakeDoubleChecker<double>())
+                          .AddAttribute("MinSnr",
+                                        "SNR (dB) mínimo para haver enlace",
+                                        DoubleValue(0.0),
+                                        MakeDoubleAccessor(&OwcChannel::m_minSnrDb),
+                                        MakeDoubleChecker<double>());
+  return tid;
+}
+
+inline void
+OwcChannel::Add(Ptr<OwcNetDevice> device)
+{
+  m_devices.push_back(device);
+  m_byAddress[Mac48Address::ConvertFrom(device->GetAddress())] = device;
+}
+
+inline Ptr<NetDevice>
+OwcChannel::GetDevice(std::size_t i) const
+{
+  return m_devices[i];
+}
+
+inline Ptr<OwcNetDevice>
+OwcChannel::Find(Mac48Address address) const
+{
+  auto it = m_byAddress.find(address);
+  return it == m_byAddress.end() ? nullptr : it->second;
+}
+
+inline double
+OwcChannel::GetGain(Ptr<const OwcNetDevice> tx, Ptr<const OwcNetDevice> rx) const
+{
+  Vector tp = tx->GetPosition();
+  Vector rp = rx->GetPosition();
+  Vector v(rp.x - tp.x, rp.y - tp.y, rp.z - tp.z);
+  double d = v.GetLength();
+  Vector tn = tx->GetOrientation();
+  Vector rn = rx->GetOrientation();
+  if (d <= 0 || tn.GetLength() <= 0 || rn.GetLength() <= 0)
+  {
+    return 0.0;
+  }
+  double cosPhi = (v.x * tn.x + v.y * tn.y + v.z * tn.z) / (d * tn.GetLength());
+  double cosPsi = -(v.x * rn.x + v.y * rn.y + v.z * rn.z) / (d * rn.GetLength());
+  if (cosPhi <= 0 || cosPsi <= 0 || std::acos(std::min(cosPsi, 1.0)) > rx->GetFieldOfView())
+  {
+    return 0.0;
+  }
+  double m = tx->GetLambertianOrder();
+  return (m + 1) * rx->GetDetectorArea() / (2 * M_PI * d * d) * std::pow(cosPhi, m) * cosPsi;
+}
+
+inline double
+OwcChannel::GetSnr(Ptr<const OwcNetDevice> tx, Ptr<const OwcNetDevice> rx) const
+{
+  double current = rx->GetResponsivity() * GetGain(tx, rx) * tx->GetTxPower();
+  return rx->GetNoisePower() > 0 ? current * current / rx->GetNoisePower() : 0.0;
+}
+
+inline double
+OwcChannel::GetRate(Ptr<const OwcNetDevice> tx, Ptr<const OwcNetDevice> rx) const
+{
+  double snr = GetSnr(tx, rx);
+  if (snr <= 0 || 10 * std::log10(snr) < m_minSnrDb)
+  {
+    return 0.0;
+  }
+  double shannon = m_bandwidth * std::log2(1 + snr / std::pow(10.0, m_snrGapDb / 10));
+  return std::min(shannon, static_cast<double>(tx->GetMaxDataRate().GetBitRate()));
+}
+
+inline void
+OwcChannel::Send(Ptr<Packet> packet,
+                 uint16_t protocol,
+                 Mac48Address to,
+                 Mac48Address from,
+                 Ptr<OwcNetDevice> sender,
+                 double rateBps,
+                 Time txTime)
+{
+  for (const Ptr<OwcNetDevice>& dev : m_devices)
+  {
+    if (dev == sender || (!to.IsGroup() && Mac48Address::ConvertFrom(dev->GetAddress()) != to))
+    {
+      continue;
+    }
+    // broadcast só chega a quem decodifica a taxa base
+    if (to.IsGroup() && GetRate(sender, dev) < rateBps)
+    {
+      continue;
+    }
+    Vector a = sender->GetPosition();
+    Vector b = dev->GetPosition();
+    Time delay = txTime + Seconds(CalculateDistance(a, b) / 299792458.0);
+    Simulator::ScheduleWithContext(dev->GetNode()->GetId(),
+                                   delay,
+                                   &OwcNetDevice::Receive,
+                                   dev,
+                                   packet->Copy(),
+                                   protocol,
+                                   to,
+                                   from);
+  }
+}
+
+// ---------- helper ----------
+class OwcHelper
+{
+public:
+  OwcHelper()
+  {
+    m_deviceFactory.SetTypeId(OwcNetDevice::GetTypeId());
+    m_channelFactory.SetTypeId(OwcChannel::GetTypeId());
+  }
+
+  void SetDeviceAttribute(std::string name, const AttributeValue& value)
+  {
+    m_deviceFactory.Set(name, value);
+  }
+
+  void SetChannelAttribute(std::string name, const AttributeValue& value)
+  {
+    m_channelFactory.Set(name, value);
+  }
+
+  Ptr<OwcChannel> CreateChannel() const
+  {
+    return m_channelFactory.Create<OwcChannel>();
+  }
+
+  // um device por nó, todos em 'channel' (os nós precisam de MobilityModel)
+  NetDeviceContainer Install(const NodeContainer& nodes, Ptr<OwcChannel> channel) const
+  {
+    NetDeviceContainer devs;
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+      Ptr<OwcNetDevice> dev = m_deviceFactory.Create<OwcNetDevice>();
+      dev->SetAddress(Mac48Address::Allocate());
+      nodes.Get(i)->AddDevice(dev);
+      dev->SetChannel(channel);
+      devs.Add(dev);
+    }
+    return devs;
+  }
+
+private:
+  ObjectFactory m_deviceFactory;
+  ObjectFactory m_channelFactory;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(OwcChannel);
+NS_OBJECT_ENSURE_REGISTERED(OwcNetDevice);
+
+} // namespace ns3
+
+#endif // OWC_CHANNEL_H
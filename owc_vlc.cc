@@ -4,47 +4,53 @@
 #include "ns3/point-to-point-module.h"
 #include "ns3/applications-module.h"
 #include "ns3/mobility-module.h"
+#include "ns3/flow-monitor-module.h"
 
+#include "owc-channel.h"
+#include "owc-link-budget.h"
+
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
 
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("OWC_VLC_Simulation");
 
-double CalculateVlcLoss(double distance)
-{
-  double n = 1; // Exponente de perda de propagação para VLC
-  double referenceLoss = 1.0; // Perda de propagação na distância de referência para VLC
-  // L_VLC(dB) = 10 * n * log10(d) - L_0
-  //double loss = referenceLoss * std::pow(distance / referenceDistance, n);
-  double loss = 10 * n * std::log10(distance) - referenceLoss;
-
-  return loss;
-}
-
-double CalculateOwcLoss(double distance)
-{
-  double n = 2; // Exponente de perda de propagação para OWC
-  double referenceDistance = 1.0; // Distância de referência para OWC
-  double referenceLoss = 1.0; // Perda de propagação na distância de referência para OWC
-  // L_OWC(dB) = PL(d0) + 10 * alpha * log10(d/d0)
-  //double loss = referenceLoss * std::pow(distance / referenceDistance, n);
-  double loss = referenceLoss + 10 * n * std::log10(distance / referenceDistance);
-  //return 10 * std::log10(loss);
-  return loss;
-}
+// CalculateVlcLoss / CalculateOwcLoss ficam em owc-link-budget.h (usados também na varredura em lote)
 
 std::string AdjustDataRate(const std::string& originalDataRate, double propagationLoss)
 {
   double originalDataRateMbps = std::stod(originalDataRate.substr(0, originalDataRate.length() - 4));
   
   // Exemplo de função de ajuste de taxa de dados. Essa função pode ser modificada conforme necessário.
-  double adjustedDataRateMbps = originalDataRateMbps * exp(-propagationLoss / 10.0);
+  double adjustedDataRateMbps = AdjustDataRateMbps(originalDataRateMbps, propagationLoss);
   
   return std::to_string(adjustedDataRateMbps) + "Mbps";
 }
 
-void RunSimulation(const std::string& dataRate, const std::string& delay, double distance)
+// instantes de envio/recepção do eco (um único pacote)
+struct EchoProbe
+{
+  Time tx = Seconds(-1);
+  Time rx = Seconds(-1);
+};
+
+static void EchoTx(EchoProbe* probe, Ptr<const Packet>)
+{
+  probe->tx = Simulator::Now();
+}
+
+static void EchoRx(EchoProbe* probe, Ptr<const Packet>)
+{
+  probe->rx = Simulator::Now();
+}
+
+// retorna o RTT do eco, ou negativo se o eco não voltou até o fim
+Time RunSimulation(const std::string& dataRate, const std::string& delay, double distance, double angleDeg = 0.0)
 {
   NodeContainer nodes;
   nodes.Create(2);
@@ -60,7 +66,8 @@ void RunSimulation(const std::string& dataRate, const std::string& delay, double
   MobilityHelper mobility;
   Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator>();
   positionAlloc->Add(Vector(0.0, 0.0, 0.0));
-  positionAlloc->Add(Vector(distance, 0.0, 0.0));
+  positionAlloc->Add(Vector(distance * std::cos(angleDeg * M_PI / 180.0),
+                            distance * std::sin(angleDeg * M_PI / 180.0), 0.0));
   mobility.SetPositionAllocator(positionAlloc);
   mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
   mobility.Install(nodes);
@@ -89,18 +96,322 @@ void RunSimulation(const std::string& dataRate, const std::string& delay, double
   clientApps.Start(Seconds(2.0));
   clientApps.Stop(Seconds(10.0));
 
+  EchoProbe probe;
+  clientApps.Get(0)->TraceConnectWithoutContext("Tx", MakeBoundCallback(&EchoTx, &probe));
+  clientApps.Get(0)->TraceConnectWithoutContext("Rx", MakeBoundCallback(&EchoRx, &probe));
+
   Simulator::Run();
   Simulator::Destroy();
+  return probe.rx >= Seconds(0) ? probe.rx - probe.tx : Seconds(-1);
+}
+
+// RTT analítico do eco: ida e volta de 1024 B + UDP/IP (28 B) + PPP (2 B) na taxa do enlace
+double ExpectedRttS(uint64_t rateBps, double delayS)
+{
+  return 2.0 * ((1024 + 28 + 2) * 8.0 / rateBps + delayS);
+}
+
+std::vector<double> ParseList(const std::string& s)
+{
+  std::vector<double> v;
+  std::stringstream ss(s);
+  std::string item;
+  while (std::getline(ss, item, ','))
+  {
+    v.push_back(std::stod(item));
+  }
+  return v;
+}
+
+// varredura em lote + validação dos pontos amostrados: o link budget do lote é
+// conferido contra o caminho escalar do modo single (coordenadas recalculadas do
+// índice, Calculate*Loss e AdjustDataRate em string) e o enlace configurado com
+// essa taxa é simulado a nível de pacote
+void RunSweep(const LinkBudgetGrid& grid, uint32_t threads, uint32_t blockSize,
+              const std::string& sweepFile, uint32_t validateSamples, uint32_t seed,
+              const std::string& validateFile, double tolerance)
+{
+  LinkBudgetSweep sweep(grid, threads, blockSize);
+  std::vector<uint64_t> samples = sweep.PickSamples(validateSamples, seed);
+  std::vector<LinkBudgetPoint> sampled;
+  std::ofstream out(sweepFile);
+  sweep.Run(out, samples, sampled);
+  NS_LOG_INFO("Varredura em " << sweepFile);
+
+  std::ofstream val(validateFile);
+  val << "index,link,distance_m,angle_deg,rate_mbps,loss_db,rate_adj_mbps,loss_ref_db,rate_ref_mbps,budget_err,"
+         "rtt_expected_ms,rtt_measured_ms,rel_err\n";
+  uint32_t ok = 0;
+  uint32_t checked = 0;
+  uint32_t budgetOk = 0;
+  for (const LinkBudgetPoint& p : sampled)
+  {
+    double distance, angleDeg, rateMbps;
+    grid.At(p.index, distance, angleDeg, rateMbps);
+    std::string nominal = std::to_string(rateMbps) + "Mbps";
+    double vlcLoss = CalculateVlcLoss(distance);
+    double owcLoss = CalculateOwcLoss(distance);
+    struct { const char* name; double loss; double rate; double lossRef; std::string rateRef; const char* delay; double delayS; } links[] = {
+      {"vlc", p.vlcLossDb, p.vlcRateMbps, vlcLoss, AdjustDataRate(nominal, vlcLoss), "2ms", 0.002},
+      {"owc", p.owcLossDb, p.owcRateMbps, owcLoss, AdjustDataRate(nominal, owcLoss), "5ms", 0.005},
+    };
+    for (const auto& l : links)
+    {
+      // link budget do lote vs. caminho escalar (a taxa em string tem 6 casas decimais em Mb/s)
+      uint64_t refBps = DataRate(l.rateRef).GetBitRate();
+      double budgetErr = std::max({std::abs(p.distance - distance), std::abs(p.angleDeg - angleDeg),
+                                   std::abs(p.rateMbps - rateMbps), std::abs(l.loss - l.lossRef),
+                                   std::abs(l.rate * 1e6 - refBps) / std::max<double>(refBps, 1.0)});
+      budgetOk += budgetErr <= tolerance;
+      // RTT previsto pela taxa do lote, medido no enlace configurado pelo caminho escalar
+      uint64_t bps = static_cast<uint64_t>(l.rate * 1e6);
+      double expected = bps > 0 ? ExpectedRttS(bps, l.delayS) : -1;
+      double measured = -1;
+      // eco que não cabe na janela da aplicação (2 s a 10 s) não é simulado
+      if (refBps > 0 && expected > 0 && expected < 8.0)
+      {
+        measured = RunSimulation(l.rateRef, l.delay, distance, angleDeg).GetSeconds();
+      }
+      double err = measured > 0 ? std::abs(measured - expected) / expected : -1;
+      if (err >= 0)
+      {
+        checked++;
+        ok += err <= tolerance;
+      }
+      val << p.index << "," << l.name << "," << p.distance << "," << p.angleDeg << "," << p.rateMbps << ","
+          << l.loss << "," << l.rate << "," << l.lossRef << "," << refBps / 1e6 << "," << budgetErr << ","
+          << expected * 1e3 << "," << measured * 1e3 << "," << err << "\n";
+    }
+  }
+  NS_LOG_INFO("Validação: link budget de " << budgetOk << "/" << 2 * sampled.size()
+              << " enlaces igual ao caminho escalar; " << ok << "/" << checked << " ecos dentro de "
+              << tolerance * 100 << "% do RTT previsto (" << sampled.size() << " pontos amostrados) em "
+              << validateFile);
+}
+
+// sala com várias luminárias e receptores num único Run, no canal OWC Lambertiano:
+// cada receptor troca ecos com a luminária de maior ganho no início; a taxa de
+// cada quadro é adaptada na hora pela posição atual (receptores podem andar)
+void RunRoom(uint32_t lumRows, uint32_t lumCols, uint32_t receivers, double roomX, double roomY,
+             double ceiling, double deskHeight, double rxSpeed, double simTime, const std::string& roomFile)
+{
+  NodeContainer lums;
+  lums.Create(lumRows * lumCols);
+  NodeContainer rxs;
+  rxs.Create(receivers);
+
+  // luminárias em grade no teto
+  MobilityHelper lumMobility;
+  Ptr<ListPositionAllocator> lumAlloc = CreateObject<ListPositionAllocator>();
+  for (uint32_t r = 0; r < lumRows; r++)
+  {
+    for (uint32_t c = 0; c < lumCols; c++)
+    {
+      lumAlloc->Add(Vector((c + 0.5) * roomX / lumCols, (r + 0.5) * roomY / lumRows, ceiling));
+    }
+  }
+  lumMobility.SetPositionAllocator(lumAlloc);
+  lumMobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+  lumMobility.Install(lums);
+
+  // receptores no plano da mesa, parados ou andando
+  MobilityHelper rxMobility;
+  rxMobility.SetPositionAllocator("ns3::RandomBoxPositionAllocator",
+    "X", StringValue("ns3::UniformRandomVariable[Min=0|Max=" + std::to_string(roomX) + "]"),
+    "Y", StringValue("ns3::UniformRandomVariable[Min=0|Max=" + std::to_string(roomY) + "]"),
+    "Z", StringValue("ns3::ConstantRandomVariable[Constant=" + std::to_string(deskHeight) + "]"));
+  if (rxSpeed > 0)
+  {
+    rxMobility.SetMobilityModel("ns3::RandomWalk2dMobilityModel",
+      "Bounds", RectangleValue(Rectangle(0, roomX, 0, roomY)),
+      "Speed", StringValue("ns3::ConstantRandomVariable[Constant=" + std::to_string(rxSpeed) + "]"),
+      "Distance", DoubleValue(1.0));
+  }
+  else
+  {
+    rxMobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+  }
+  rxMobility.Install(rxs);
+
+  OwcHelper owc;
+  Ptr<OwcChannel> channel = owc.CreateChannel();
+  owc.SetDeviceAttribute("Orientation", VectorValue(Vector(0, 0, -1)));
+  NetDeviceContainer lumDevs = owc.Install(lums, channel);
+  owc.SetDeviceAttribute("Orientation", VectorValue(Vector(0, 0, 1)));
+  NetDeviceContainer rxDevs = owc.Install(rxs, channel);
+
+  InternetStackHelper stack;
+  stack.Install(lums);
+  stack.Install(rxs);
+  Ipv4AddressHelper address;
+  address.SetBase("10.2.0.0", "255.255.0.0");
+  Ipv4InterfaceContainer lumIfaces = address.Assign(lumDevs);
+  Ipv4InterfaceContainer rxIfaces = address.Assign(rxDevs);
+
+  // enlace de cada receptor: luminária de maior ganho em t=0
+  std::vector<int32_t> serving(receivers, -1);
+  std::vector<double> rateStart(receivers, 0.0);
+  UdpEchoServerHelper echoServer(9);
+  ApplicationContainer serverApps = echoServer.Install(rxs);
+  serverApps.Start(Seconds(0.5));
+  for (uint32_t j = 0; j < receivers; j++)
+  {
+    Ptr<OwcNetDevice> rx = DynamicCast<OwcNetDevice>(rxDevs.Get(j));
+    double best = 0;
+    for (uint32_t i = 0; i < lumDevs.GetN(); i++)
+    {
+      double g = channel->GetGain(DynamicCast<OwcNetDevice>(lumDevs.Get(i)), rx);
+      if (g > best)
+      {
+        best = g;
+        serving[j] = i;
+      }
+    }
+    if (serving[j] < 0)
+    {
+      continue;
+    }
+    rateStart[j] = channel->GetRate(DynamicCast<OwcNetDevice>(lumDevs.Get(serving[j])), rx);
+    UdpEchoClientHelper echoClient(rxIfaces.GetAddress(j), 9);
+    echoClient.SetAttribute("MaxPackets", UintegerValue(1000000));
+    echoClient.SetAttribute("Interval", TimeValue(MilliSeconds(10)));
+    echoClient.SetAttribute("PacketSize", UintegerValue(1024));
+    ApplicationContainer clientApp = echoClient.Install(lums.Get(serving[j]));
+    clientApp.Start(Seconds(1.0 + 0.01 * j / receivers));
+    clientApp.Stop(Seconds(simTime));
+  }
+
+  FlowMonitorHelper flowmon;
+  Ptr<FlowMonitor> monitor = flowmon.InstallAll();
+
+  Simulator::Stop(Seconds(simTime));
+  auto t0 = std::chrono::steady_clock::now();
+  Simulator::Run();
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  // descida (luminária -> receptor) por receptor
+  monitor->CheckForLostPackets();
+  Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(flowmon.GetClassifier());
+  std::map<Ipv4Address, uint32_t> rxIndex;
+  for (uint32_t j = 0; j < receivers; j++)
+  {
+    rxIndex[rxIfaces.GetAddress(j)] = j;
+  }
+  std::vector<FlowMonitor::FlowStats> downlink(receivers);
+  for (const auto& kv : monitor->GetFlowStats())
+  {
+    Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(kv.first);
+    auto it = rxIndex.find(t.destinationAddress);
+    if (it != rxIndex.end())
+    {
+      downlink[it->second] = kv.second;
+    }
+  }
+
+  std::ofstream out(roomFile);
+  out << "luminaire,receiver,distance_m,gain_db,rate_start_mbps,rate_end_mbps,dl_tx,dl_rx,dl_delay_ms,dl_thr_mbps\n";
+  uint32_t covered = 0;
+  for (uint32_t j = 0; j < receivers; j++)
+  {
+    if (serving[j] < 0)
+    {
+      out << "," << j << ",,,0,0,0,0,,0\n";
+      continue;
+    }
+    covered++;
+    Ptr<OwcNetDevice> lum = DynamicCast<OwcNetDevice>(lumDevs.Get(serving[j]));
+    Ptr<OwcNetDevice> rx = DynamicCast<OwcNetDevice>(rxDevs.Get(j));
+    const FlowMonitor::FlowStats& s = downlink[j];
+    double gain = channel->GetGain(lum, rx);
+    out << serving[j] << "," << j << "," << CalculateDistance(lum->GetPosition(), rx->GetPosition()) << ","
+        << (gain > 0 ? 10 * std::log10(gain) : -999) << "," << rateStart[j] / 1e6 << ","
+        << channel->GetRate(lum, rx) / 1e6 << "," << s.txPackets << "," << s.rxPackets << ","
+        << (s.rxPackets ? s.delaySum.GetSeconds() * 1e3 / s.rxPackets : 0) << ","
+        << s.rxBytes * 8.0 / (simTime - 1.0) / 1e6 << "\n";
+  }
+  NS_LOG_INFO("Sala: " << lums.GetN() << " luminárias, " << receivers << " receptores (" << covered
+              << " cobertos) num único Run: " << wall << " s reais, " << Simulator::GetEventCount()
+              << " eventos; enlaces em " << roomFile);
+  Simulator::Destroy();
 }
 
 int main(int argc, char* argv[])
 {
   Time::SetResolution(Time::NS);
   LogComponentEnable("OWC_VLC_Simulation", LOG_LEVEL_INFO);
-  LogComponentEnable("UdpEchoClientApplication", LOG_LEVEL_INFO);
-  LogComponentEnable("UdpEchoServerApplication", LOG_LEVEL_INFO);
 
   double distance = 20.0; // Distância entre os nós em metros
+  std::string mode = "single";
+  // varredura em lote (mode=sweep)
+  double sweepDistMin = 1.0, sweepDistMax = 100.0;
+  uint32_t sweepDistSteps = 1000;
+  double sweepAngleMin = 0.0, sweepAngleMax = 60.0;
+  uint32_t sweepAngleSteps = 61;
+  std::string sweepRates = "1,10,100";
+  uint32_t threads = std::thread::hardware_concurrency();
+  uint32_t blockSize = 65536;
+  std::string sweepFile = "owc-vlc-sweep.csv";
+  uint32_t validateSamples = 20;
+  uint32_t validateSeed = 1;
+  double validateTol = 1e-3;
+  std::string validateFile = "owc-vlc-validation.csv";
+  // sala com vários enlaces (mode=room)
+  uint32_t lumRows = 3, lumCols = 3;
+  uint32_t receivers = 30;
+  double roomX = 10.0, roomY = 10.0;
+  double ceiling = 3.0;
+  double deskHeight = 0.85;
+  double rxSpeed = 0.0;
+  double simTime = 10.0;
+  std::string roomFile = "owc-vlc-room.csv";
+
+  CommandLine cmd;
+  cmd.AddValue("mode", "Um enlace a 'distance' (single), varredura em lote da grade (sweep) ou sala com vários enlaces (room)", mode);
+  cmd.AddValue("distance", "Distância entre os nós (m) no modo single", distance);
+  cmd.AddValue("sweepDistMin", "Distância mínima (m) da varredura", sweepDistMin);
+  cmd.AddValue("sweepDistMax", "Distância máxima (m) da varredura", sweepDistMax);
+  cmd.AddValue("sweepDistSteps", "Pontos de distância da varredura", sweepDistSteps);
+  cmd.AddValue("sweepAngleMin", "Ângulo mínimo (graus) da varredura", sweepAngleMin);
+  cmd.AddValue("sweepAngleMax", "Ângulo máximo (graus) da varredura", sweepAngleMax);
+  cmd.AddValue("sweepAngleSteps", "Pontos de ângulo da varredura", sweepAngleSteps);
+  cmd.AddValue("sweepRates", "Taxas nominais (Mb/s) separadas por vírgula", sweepRates);
+  cmd.AddValue("threads", "Threads da varredura", threads);
+  cmd.AddValue("blockSize", "Pontos por bloco (buffers contíguos por thread)", blockSize);
+  cmd.AddValue("sweepFile", "CSV da varredura (gravado em streaming)", sweepFile);
+  cmd.AddValue("validateSamples", "Pontos da varredura validados com simulação a nível de pacote", validateSamples);
+  cmd.AddValue("validateSeed", "Semente da amostra de validação", validateSeed);
+  cmd.AddValue("validateTol", "Erro relativo máximo do RTT medido vs. analítico", validateTol);
+  cmd.AddValue("validateFile", "CSV da validação", validateFile);
+  cmd.AddValue("lumRows", "Linhas de luminárias no teto (room)", lumRows);
+  cmd.AddValue("lumCols", "Colunas de luminárias no teto (room)", lumCols);
+  cmd.AddValue("receivers", "Número de receptores (room)", receivers);
+  cmd.AddValue("roomX", "Largura da sala (m)", roomX);
+  cmd.AddValue("roomY", "Comprimento da sala (m)", roomY);
+  cmd.AddValue("ceiling", "Altura das luminárias (m)", ceiling);
+  cmd.AddValue("deskHeight", "Altura dos receptores (m)", deskHeight);
+  cmd.AddValue("rxSpeed", "Velocidade (m/s) dos receptores; 0 = parados", rxSpeed);
+  cmd.AddValue("simTime", "Duração da simulação da sala (s)", simTime);
+  cmd.AddValue("roomFile", "CSV por enlace da sala", roomFile);
+  cmd.Parse(argc, argv);
+
+  if (mode == "room")
+  {
+    RunRoom(lumRows, lumCols, receivers, roomX, roomY, ceiling, deskHeight, rxSpeed, simTime, roomFile);
+    return 0;
+  }
+
+  if (mode == "sweep")
+  {
+    LinkBudgetGrid grid;
+    grid.distances = LinkBudgetGrid::Linspace(sweepDistMin, sweepDistMax, sweepDistSteps);
+    grid.anglesDeg = LinkBudgetGrid::Linspace(sweepAngleMin, sweepAngleMax, sweepAngleSteps);
+    grid.ratesMbps = ParseList(sweepRates);
+    RunSweep(grid, threads, blockSize, sweepFile, validateSamples, validateSeed, validateFile, validateTol);
+    return 0;
+  }
+
+  LogComponentEnable("UdpEchoClientApplication", LOG_LEVEL_INFO);
+  LogComponentEnable("UdpEchoServerApplication", LOG_LEVEL_INFO);
   double vlcLoss = CalculateVlcLoss(distance);
   double owcLoss = CalculateOwcLoss(distance);
 
@@ -0,0 +1,194 @@
+// urbano-attach-scheduler.h
+// Attach escalonado em ondas por setor.
+//  lte->Attach(ueDevs) / AttachToClosestEnb ligam todos os UEs em t=0: milhares de
+//  RACH + RRC Connection Request + S1 no mesmo instante, o que domina o tempo de
+//  parede e a memória do início da simulação. StagedAttach agrupa os UEs pelo
+//  setor alvo e, a cada WaveInterval, faz o attach de no máximo WaveSize UEs de
+//  cada setor (todos os setores em paralelo), limitando a carga de sinalização
+//  por célula. O attach em si é uma função do cenário (LTE: seleção de célula
+//  automática; NR: AttachToEnb no setor mais próximo).
+//  Mede, via trace ConnectionEstablished do LteUeRrc (usado também pelo NR), o
+//  instante em que o último UE conecta e o tempo de parede gasto até lá,
+//  contado a partir do início do Simulator::Run; o mesmo relatório vale para o
+//  modo "todos de uma vez" (Immediate), para comparação.
+
+#ifndef URBANO_ATTACH_SCHEDULER_H
+#define URBANO_ATTACH_SCHEDULER_H
+
+#include "ns3/core-module.h"
+#include "ns3/lte-module.h"
+#include "ns3/network-module.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace ns3
+{
+
+class StagedAttach
+{
+  public:
+    using AttachFn = std::function<void(uint32_t ue)>;
+    using RrcFn = std::function<Ptr<LteUeRrc>(Ptr<NetDevice>)>;
+
+    StagedAttach(const NetDeviceContainer& ueDevs, AttachFn attach, RrcFn rrc)
+        : m_ueDevs(ueDevs),
+          m_attach(attach),
+          m_rrc(rrc),
+          m_connected(0),
+          m_waves(0),
+          m_firstAttach(Seconds(0)),
+          m_allConnected(Seconds(-1))
+    {
+    }
+
+    // todos os UEs de uma vez (comportamento original); o attach ocorre já, antes do Run
+    void Immediate()
+    {
+        ConnectTraces();
+        for (uint32_t i = 0; i < m_ueDevs.GetN(); i++)
+        {
+            m_attach(i);
+        }
+        m_waves = 1;
+        m_firstAttach = Seconds(0);
+        Simulator::ScheduleNow(&StagedAttach::MarkRunStart, this);
+    }
+
+    // ondas: sectorOf(ue) -> setor alvo; waveSize UEs por setor a cada waveInterval
+    void Staged(std::function<uint32_t(uint32_t)> sectorOf,
+                uint32_t waveSize,
+                Time start,
+                Time waveInterval)
+    {
+        NS_ABORT_MSG_IF(waveSize == 0, "WaveSize deve ser > 0");
+        ConnectTraces();
+        std::map<uint32_t, std::vector<uint32_t>> bySector;
+        for (uint32_t i = 0; i < m_ueDevs.GetN(); i++)
+        {
+            bySector[sectorOf(i)].push_back(i);
+        }
+        std::vector<std::vector<uint32_t>> waves;
+        for (const auto& kv : bySector)
+        {
+            for (size_t k = 0; k < kv.second.size(); k++)
+            {
+                size_t w = k / waveSize;
+                if (waves.size() <= w)
+                {
+                    waves.resize(w + 1);
+                }
+                waves[w].push_back(kv.second[k]);
+            }
+        }
+        m_waves = waves.size();
+        m_firstAttach = start;
+        Simulator::ScheduleNow(&StagedAttach::MarkRunStart, this);
+        for (size_t w = 0; w < waves.size(); w++)
+        {
+            Simulator::Schedule(start + waveInterval * static_cast<int64_t>(w),
+                                &StagedAttach::RunWave,
+                                this,
+                                waves[w]);
+        }
+        std::cout << "[ATTACH] " << m_ueDevs.GetN() << " UEs em " << bySector.size()
+                  << " setores: " << m_waves << " ondas de até " << waveSize
+                  << " UEs/setor a cada " << waveInterval.GetMilliSeconds() << " ms (última em t="
+                  << (start + waveInterval * static_cast<int64_t>(m_waves - 1)).GetSeconds() << " s)"
+                  << std::endl;
+    }
+
+    uint32_t GetConnected() const
+    {
+        return m_connected;
+    }
+
+    // instante (simulado) em que o último UE conectou; negativo se não conectaram todos
+    Time GetAllConnectedTime() const
+    {
+        return m_allConnected;
+    }
+
+    // chamado uma vez, quando o último UE conecta
+    void SetAllConnectedCallback(std::function<void()> cb)
+    {
+        m_onAllConnected = cb;
+    }
+
+    void Report() const
+    {
+        std::cout << "[ATTACH] " << m_connected << "/" << m_ueDevs.GetN() << " UEs conectados";
+        if (m_allConnected >= Seconds(0))
+        {
+            std::cout << "; todos em t=" << m_allConnected.GetSeconds() << " s ("
+                      << (m_allConnected - m_firstAttach).GetSeconds() << " s após o 1º attach, "
+                      << m_wallToAllS << " s de tempo real desde o início do Run)";
+        }
+        std::cout << std::endl;
+    }
+
+  private:
+    void ConnectTraces()
+    {
+        for (uint32_t i = 0; i < m_ueDevs.GetN(); i++)
+        {
+            m_rrc(m_ueDevs.Get(i))->TraceConnectWithoutContext(
+                "ConnectionEstablished",
+                MakeCallback(&StagedAttach::Connected, this));
+        }
+    }
+
+    void MarkRunStart()
+    {
+        m_runStart = std::chrono::steady_clock::now();
+    }
+
+    void RunWave(std::vector<uint32_t> ues)
+    {
+        for (uint32_t i : ues)
+        {
+            m_attach(i);
+        }
+    }
+
+    // conta IMSIs distintos (reconexão após RLF dispara o trace de novo)
+    void Connected(uint64_t imsi, uint16_t, uint16_t)
+    {
+        if (!m_imsis.insert(imsi).second)
+        {
+            return;
+        }
+        m_connected++;
+        if (m_connected == m_ueDevs.GetN())
+        {
+            m_allConnected = Simulator::Now();
+            m_wallToAllS =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - m_runStart).count();
+            if (m_onAllConnected)
+            {
+                m_onAllConnected();
+            }
+        }
+    }
+
+    NetDeviceContainer m_ueDevs;
+    AttachFn m_attach;
+    RrcFn m_rrc;
+    uint32_t m_connected;
+    uint32_t m_waves;
+    Time m_firstAttach;
+    Time m_allConnected;
+    std::set<uint64_t> m_imsis;
+    std::chrono::steady_clock::time_point m_runStart;
+    double m_wallToAllS = 0;
+    std::function<void()> m_onAllConnected;
+};
+
+} // namespace ns3
+
+#endif // URBANO_ATTACH_SCHEDULER_H
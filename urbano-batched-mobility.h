@@ -0,0 +1,387 @@
+// urbano-batched-mobility.h
+// Passeio aleatório 2D em lote para milhares de pedestres.
+//  Com RandomWalk2dMobilityModel (Distance=5 m, 1 m/s) cada UE agenda um evento
+//  de fim de perna a cada ~5 s e cada um dispara CourseChange para os ouvintes
+//  (cache de pathloss, etc.): com 6300 UEs, um fluxo constante de eventos
+//  minúsculos. Aqui:
+//   - BatchedWalkEngine (um por simulação) guarda o estado de todos os UEs em
+//     vetores contíguos (SoA: origem da perna, velocidade, t0, fim da perna,
+//     limites, última posição notificada) e faz uma única atualização
+//     periódica (UpdateInterval) em laços simples sobre os vetores;
+//   - a posição é calculada sob demanda no GetPosition: origem + v·(t - t0),
+//     rebatida nos limites (reflexão analítica, sem eventos);
+//   - CourseChange só é disparado quando o UE se afastou mais de
+//     NotifyThreshold m da última posição notificada. O padrão (5 m, o Distance
+//     dos cenários) fica bem acima do passo de um tick (1 m/s x 1 s = 1 m): um
+//     pedestre notifica no máximo uma vez a cada 5 ticks, abaixo da taxa do
+//     RandomWalk2d (um CourseChange por perna). Um limiar igual ao passo faria
+//     todo UE notificar em todo tick;
+//   - as trocas de direção acontecem nos ticks: a perna dura Distance/v
+//     arredondado para cima ao múltiplo de UpdateInterval.
+//  BatchedRandomWalk2dMobilityModel tem os mesmos atributos do RandomWalk2d usados
+//  nos cenários (Bounds, Speed, Direction, Distance), então troca direto o tipo
+//  da ObjectFactory dos UEs (InstallMobility, urbano-topology-builder.h).
+
+#ifndef URBANO_BATCHED_MOBILITY_H
+#define URBANO_BATCHED_MOBILITY_H
+
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace ns3
+{
+
+// rebate a coordenada para dentro de [lo, hi] (ida e volta nas bordas)
+inline double
+ReflectInto(double v, double lo, double hi)
+{
+    double w = hi - lo;
+    if (w <= 0)
+    {
+        return lo;
+    }
+    double t = std::fmod(v - lo, 2 * w);
+    if (t < 0)
+    {
+        t += 2 * w;
+    }
+    return lo + (t <= w ? t : 2 * w - t);
+}
+
+// sentido da componente da velocidade após as reflexões (+1 ou -1)
+inline double
+ReflectSign(double v, double lo, double hi)
+{
+    double w = hi - lo;
+    if (w <= 0)
+    {
+        return 0.0;
+    }
+    double t = std::fmod(v - lo, 2 * w);
+    if (t < 0)
+    {
+        t += 2 * w;
+    }
+    return t <= w ? 1.0 : -1.0;
+}
+
+class BatchedRandomWalk2dMobilityModel;
+
+class BatchedWalkEngine : public Object
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::BatchedWalkEngine")
+                .SetParent<Object>()
+                .SetGroupName("Mobility")
+                .AddConstructor<BatchedWalkEngine>()
+                .AddAttribute("UpdateInterval",
+                              "Período da atualização em lote (fim de pernas e notificações)",
+                              TimeValue(Seconds(1.0)),
+                              MakeTimeAccessor(&BatchedWalkEngine::m_interval),
+                              MakeTimeChecker(MilliSeconds(1)));
+        return tid;
+    }
+
+    BatchedWalkEngine()
+        : m_ticks(0),
+          m_legs(0),
+          m_notifications(0)
+    {
+    }
+
+    // instância da simulação corrente (recriada após Simulator::Destroy)
+    static Ptr<BatchedWalkEngine> Get()
+    {
+        Ptr<BatchedWalkEngine>& e = Instance();
+        if (!e)
+        {
+            e = CreateObject<BatchedWalkEngine>();
+            Simulator::ScheduleDestroy(&BatchedWalkEngine::Release);
+        }
+        return e;
+    }
+
+    static void Report()
+    {
+        Ptr<BatchedWalkEngine> e = Instance();
+        if (!e)
+        {
+            return;
+        }
+        std::cout << "[MOBILITY] " << e->m_x0.size() << " UEs em lote: " << e->m_ticks << " ticks de "
+                  << e->m_interval.GetMilliSeconds() << " ms, " << e->m_legs << " pernas, "
+                  << e->m_notifications << " CourseChange" << std::endl;
+    }
+
+    uint32_t Add(BatchedRandomWalk2dMobilityModel* model,
+                 const Vector& p,
+                 const Rectangle& bounds,
+                 Ptr<RandomVariableStream> speed,
+                 Ptr<RandomVariableStream> direction,
+                 double legDistance,
+                 double threshold)
+    {
+        uint32_t i = m_x0.size();
+        m_models.push_back(model);
+        m_speed.push_back(speed);
+        m_direction.push_back(direction);
+        m_x0.push_back(ReflectInto(p.x, bounds.xMin, bounds.xMax));
+        m_y0.push_back(ReflectInto(p.y, bounds.yMin, bounds.yMax));
+        m_z.push_back(p.z);
+        m_vx.push_back(0);
+        m_vy.push_back(0);
+        m_t0.push_back(Simulator::Now().GetSeconds());
+        m_tEnd.push_back(0);
+        m_xMin.push_back(bounds.xMin);
+        m_xMax.push_back(bounds.xMax);
+        m_yMin.push_back(bounds.yMin);
+        m_yMax.push_back(bounds.yMax);
+        m_nx.push_back(m_x0[i]);
+        m_ny.push_back(m_y0[i]);
+        m_legDistance.push_back(legDistance);
+        m_threshold2.push_back(threshold * threshold);
+        m_px.push_back(m_x0[i]);
+        m_py.push_back(m_y0[i]);
+        NewLeg(i, Simulator::Now().GetSeconds());
+        if (!m_tick.IsRunning())
+        {
+            m_tick = Simulator::Schedule(m_interval, &BatchedWalkEngine::Tick, this);
+        }
+        return i;
+    }
+
+    void Remove(uint32_t i)
+    {
+        m_models[i] = nullptr;
+    }
+
+    Vector GetPosition(uint32_t i) const
+    {
+        double dt = Simulator::Now().GetSeconds() - m_t0[i];
+        return Vector(ReflectInto(m_x0[i] + m_vx[i] * dt, m_xMin[i], m_xMax[i]),
+                      ReflectInto(m_y0[i] + m_vy[i] * dt, m_yMin[i], m_yMax[i]),
+                      m_z[i]);
+    }
+
+    Vector GetVelocity(uint32_t i) const
+    {
+        double dt = Simulator::Now().GetSeconds() - m_t0[i];
+        return Vector(m_vx[i] * ReflectSign(m_x0[i] + m_vx[i] * dt, m_xMin[i], m_xMax[i]),
+                      m_vy[i] * ReflectSign(m_y0[i] + m_vy[i] * dt, m_yMin[i], m_yMax[i]),
+                      0.0);
+    }
+
+    // reposiciona (perna atual continua a partir de p)
+    void SetPosition(uint32_t i, const Vector& p)
+    {
+        m_x0[i] = m_nx[i] = ReflectInto(p.x, m_xMin[i], m_xMax[i]);
+        m_y0[i] = m_ny[i] = ReflectInto(p.y, m_yMin[i], m_yMax[i]);
+        m_z[i] = p.z;
+        m_t0[i] = Simulator::Now().GetSeconds();
+    }
+
+  private:
+    static Ptr<BatchedWalkEngine>& Instance()
+    {
+        static Ptr<BatchedWalkEngine> e;
+        return e;
+    }
+
+    static void Release()
+    {
+        Instance() = nullptr;
+    }
+
+    void NewLeg(uint32_t i, double now)
+    {
+        double v = m_speed[i]->GetValue();
+        double dir = m_direction[i]->GetValue();
+        m_vx[i] = v * std::cos(dir);
+        m_vy[i] = v * std::sin(dir);
+        m_tEnd[i] = now + (v > 0 ? m_legDistance[i] / v : 1e9);
+        m_legs++;
+    }
+
+    void Tick();
+
+    void DoDispose() override
+    {
+        m_tick.Cancel();
+        m_models.clear();
+        m_speed.clear();
+        m_direction.clear();
+        Object::DoDispose();
+    }
+
+    Time m_interval;
+    EventId m_tick;
+    uint64_t m_ticks;
+    uint64_t m_legs;
+    uint64_t m_notifications;
+
+    std::vector<BatchedRandomWalk2dMobilityModel*> m_models;
+    std::vector<Ptr<RandomVariableStream>> m_speed;
+    std::vector<Ptr<RandomVariableStream>> m_direction;
+    // estado por UE, um vetor por grandeza
+    std::vector<double> m_x0, m_y0, m_z, m_vx, m_vy, m_t0, m_tEnd;
+    std::vector<double> m_xMin, m_xMax, m_yMin, m_yMax;
+    std::vector<double> m_nx, m_ny, m_legDistance, m_threshold2;
+    std::vector<double> m_px, m_py; // posições do tick corrente
+};
+
+class BatchedRandomWalk2dMobilityModel : public MobilityModel
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::BatchedRandomWalk2dMobilityModel")
+                .SetParent<MobilityModel>()
+                .SetGroupName("Mobility")
+                .AddConstructor<BatchedRandomWalk2dMobilityModel>()
+                .AddAttribute("Bounds",
+                              "Limites da área do passeio",
+                              RectangleValue(Rectangle(0.0, 100.0, 0.0, 100.0)),
+                              MakeRectangleAccessor(&BatchedRandomWalk2dMobilityModel::m_bounds),
+                              MakeRectangleChecker())
+                .AddAttribute("Speed",
+                              "Velocidade (m/s) sorteada a cada perna",
+                              StringValue("ns3::UniformRandomVariable[Min=2.0|Max=4.0]"),
+                              MakePointerAccessor(&BatchedRandomWalk2dMobilityModel::m_speed),
+                              MakePointerChecker<RandomVariableStream>())
+                .AddAttribute("Direction",
+                              "Direção (rad) sorteada a cada perna",
+                              StringValue("ns3::UniformRandomVariable[Min=0.0|Max=6.283184]"),
+                              MakePointerAccessor(&BatchedRandomWalk2dMobilityModel::m_direction),
+                              MakePointerChecker<RandomVariableStream>())
+                .AddAttribute("Distance",
+                              "Comprimento (m) de cada perna",
+                              DoubleValue(1.0),
+                              MakeDoubleAccessor(&BatchedRandomWalk2dMobilityModel::m_distance),
+                              MakeDoubleChecker<double>(0.0))
+                .AddAttribute("NotifyThreshold",
+                              "Deslocamento (m) desde a última notificação acima do qual CourseChange é disparado",
+                              DoubleValue(5.0),
+                              MakeDoubleAccessor(&BatchedRandomWalk2dMobilityModel::m_threshold),
+                              MakeDoubleChecker<double>(0.0));
+        return tid;
+    }
+
+    BatchedRandomWalk2dMobilityModel()
+        : m_index(-1)
+    {
+    }
+
+    // chamado pelo engine no tick
+    void NotifyMoved()
+    {
+        NotifyCourseChange();
+    }
+
+  private:
+    Vector DoGetPosition() const override
+    {
+        return m_index < 0 ? Vector() : m_engine->GetPosition(m_index);
+    }
+
+    Vector DoGetVelocity() const override
+    {
+        return m_index < 0 ? Vector() : m_engine->GetVelocity(m_index);
+    }
+
+    // registra no engine na primeira posição (atributos já aplicados)
+    void DoSetPosition(const Vector& p) override
+    {
+        if (m_index < 0)
+        {
+            m_engine = BatchedWalkEngine::Get();
+            m_index = m_engine->Add(this, p, m_bounds, m_speed, m_direction, m_distance, m_threshold);
+        }
+        else
+        {
+            m_engine->SetPosition(m_index, p);
+        }
+        NotifyCourseChange();
+    }
+
+    int64_t DoAssignStreams(int64_t stream) override
+    {
+        m_speed->SetStream(stream);
+        m_direction->SetStream(stream + 1);
+        return 2;
+    }
+
+    void DoDispose() override
+    {
+        if (m_index >= 0)
+        {
+            m_engine->Remove(m_index);
+        }
+        m_engine = nullptr;
+        MobilityModel::DoDispose();
+    }
+
+    Rectangle m_bounds;
+    Ptr<RandomVariableStream> m_speed;
+    Ptr<RandomVariableStream> m_direction;
+    double m_distance;
+    double m_threshold;
+    Ptr<BatchedWalkEngine> m_engine;
+    int64_t m_index;
+};
+
+inline void
+BatchedWalkEngine::Tick()
+{
+    const double now = Simulator::Now().GetSeconds();
+    const size_t n = m_x0.size();
+    m_ticks++;
+
+    // posições de todos os UEs no instante do tick
+    for (size_t i = 0; i < n; i++)
+    {
+        double dt = now - m_t0[i];
+        m_px[i] = ReflectInto(m_x0[i] + m_vx[i] * dt, m_xMin[i], m_xMax[i]);
+        m_py[i] = ReflectInto(m_y0[i] + m_vy[i] * dt, m_yMin[i], m_yMax[i]);
+    }
+    // pernas encerradas: nova direção/velocidade a partir da posição atual
+    for (size_t i = 0; i < n; i++)
+    {
+        if (m_tEnd[i] <= now + 1e-9)
+        {
+            m_x0[i] = m_px[i];
+            m_y0[i] = m_py[i];
+            m_t0[i] = now;
+            NewLeg(i, now);
+        }
+    }
+    // CourseChange só para quem andou mais que o limiar desde a última notificação
+    for (size_t i = 0; i < n; i++)
+    {
+        double dx = m_px[i] - m_nx[i];
+        double dy = m_py[i] - m_ny[i];
+        double d2 = dx * dx + dy * dy;
+        if (d2 > m_threshold2[i] && m_models[i])
+        {
+            m_nx[i] = m_px[i];
+            m_ny[i] = m_py[i];
+            m_notifications++;
+            m_models[i]->NotifyMoved();
+        }
+    }
+    m_tick = Simulator::Schedule(m_interval, &BatchedWalkEngine::Tick, this);
+}
+
+NS_OBJECT_ENSURE_REGISTERED(BatchedWalkEngine);
+NS_OBJECT_ENSURE_REGISTERED(BatchedRandomWalk2dMobilityModel);
+
+} // namespace ns3
+
+#endif // URBANO_BATCHED_MOBILITY_H
@@ -0,0 +1,156 @@
+// urbano-beam-cache.h
+// Cache dos vetores de beamforming por par gNB/UE.
+//  O IdealBeamformingHelper recalcula, a cada BeamformingPeriodicity, o par de
+//  feixes ótimo de todo par gNB-UE registrado (uma atualização em lote por
+//  período, mais uma por par no attach). No lite os UEs são
+//  ConstantPosition e a resposta nunca muda; no completo andam a 1 m/s.
+//  CachedIdealBeamformingHelper mantém o mesmo agendamento em lote e só troca o
+//  cálculo de cada par:
+//   - chave = (NrSpectrumPhy do gNB, NrSpectrumPhy do UE);
+//   - guarda os vetores e os ângulos (azimute/inclinação) do UE visto do gNB no
+//     cálculo; enquanto nenhum dos dois mudar mais que AngularThreshold graus,
+//     devolve os vetores guardados;
+//   - senão, chama o algoritmo configurado (BeamformingMethod) e atualiza.
+//  Exato para DirectPathBeamforming (só geometria, padrão do helper); com
+//  métodos que usam a matriz do canal (cell scan) o feixe fica congelado
+//  entre movimentos maiores que o limiar.
+//  Report() mostra a taxa de acerto e o custo de cada atualização periódica,
+//  medido em volta de ExpireBeamformingTimer (o lote inteiro); os pares
+//  calculados fora do lote (attach, handover) são contados à parte.
+
+#ifndef URBANO_BEAM_CACHE_H
+#define URBANO_BEAM_CACHE_H
+
+#include "ns3/antenna-module.h"
+#include "ns3/core-module.h"
+#include "ns3/ideal-beamforming-helper.h"
+#include "ns3/mobility-module.h"
+#include "ns3/nr-module.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <utility>
+
+namespace ns3
+{
+
+class CachedIdealBeamformingHelper : public IdealBeamformingHelper
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::CachedIdealBeamformingHelper")
+                .SetParent<IdealBeamformingHelper>()
+                .SetGroupName("nr")
+                .AddConstructor<CachedIdealBeamformingHelper>()
+                .AddAttribute("AngularThreshold",
+                              "Variação (graus) de azimute ou inclinação do UE visto do gNB "
+                              "que invalida o feixe guardado",
+                              DoubleValue(1.0),
+                              MakeDoubleAccessor(&CachedIdealBeamformingHelper::m_thresholdDeg),
+                              MakeDoubleChecker<double>(0.0));
+        return tid;
+    }
+
+    CachedIdealBeamformingHelper()
+        : m_thresholdDeg(1.0),
+          m_hits(0),
+          m_misses(0),
+          m_updates(0),
+          m_outOfBatch(0),
+          m_inUpdate(false),
+          m_wallS(0),
+          m_maxUpdateS(0)
+    {
+    }
+
+    // uma atualização periódica: todos os pares registrados, em lote
+    void ExpireBeamformingTimer() override
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        m_inUpdate = true;
+        IdealBeamformingHelper::ExpireBeamformingTimer();
+        m_inUpdate = false;
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        m_updates++;
+        m_wallS += s;
+        m_maxUpdateS = std::max(m_maxUpdateS, s);
+    }
+
+    double GetHitRate() const
+    {
+        uint64_t total = m_hits + m_misses;
+        return total ? static_cast<double>(m_hits) / total : 0.0;
+    }
+
+    void Report() const
+    {
+        std::cout << "[BEAM] cache: hit rate " << 100.0 * GetHitRate() << "% (" << m_hits << " hits, "
+                  << m_misses << " recálculos, " << m_cache.size() << " pares), " << m_updates
+                  << " atualizações periódicas, " << (m_updates ? 1e3 * m_wallS / m_updates : 0.0)
+                  << " ms por atualização (máx " << 1e3 * m_maxUpdateS << " ms), " << m_outOfBatch
+                  << " pares fora do lote (attach/handover)" << std::endl;
+    }
+
+  protected:
+    BeamformingVectorPair GetBeamformingVectors(const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                                                const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const override
+    {
+        m_outOfBatch += !m_inUpdate;
+        Angles a(ueSpectrumPhy->GetMobility()->GetPosition(), gnbSpectrumPhy->GetMobility()->GetPosition());
+        auto key = std::make_pair(PeekPointer(gnbSpectrumPhy), PeekPointer(ueSpectrumPhy));
+        auto it = m_cache.find(key);
+        const double thr = m_thresholdDeg * M_PI / 180.0;
+        if (it != m_cache.end() && AngleDiff(a.GetAzimuth(), it->second.azimuth) <= thr &&
+            std::abs(a.GetInclination() - it->second.inclination) <= thr)
+        {
+            m_hits++;
+            return it->second.vectors;
+        }
+        m_misses++;
+        BeamformingVectorPair v = IdealBeamformingHelper::GetBeamformingVectors(gnbSpectrumPhy, ueSpectrumPhy);
+        m_cache[key] = Entry{a.GetAzimuth(), a.GetInclination(), v};
+        return v;
+    }
+
+    void DoDispose() override
+    {
+        m_cache.clear();
+        IdealBeamformingHelper::DoDispose();
+    }
+
+  private:
+    struct Entry
+    {
+        double azimuth;
+        double inclination;
+        BeamformingVectorPair vectors;
+    };
+
+    // diferença angular em [0, π]
+    static double AngleDiff(double a, double b)
+    {
+        double d = std::fmod(std::abs(a - b), 2 * M_PI);
+        return d > M_PI ? 2 * M_PI - d : d;
+    }
+
+    double m_thresholdDeg;
+    mutable std::map<std::pair<const NrSpectrumPhy*, const NrSpectrumPhy*>, Entry> m_cache;
+    mutable uint64_t m_hits;
+    mutable uint64_t m_misses;
+    uint64_t m_updates;
+    mutable uint64_t m_outOfBatch;
+    bool m_inUpdate;
+    double m_wallS;
+    double m_maxUpdateS;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(CachedIdealBeamformingHelper);
+
+} // namespace ns3
+
+#endif // URBANO_BEAM_CACHE_H
@@ -0,0 +1,477 @@
+// urbano-event-profiler.h
+// Profiler do laço de eventos (opcional, --eventProfile=true).
+//  ProfilingScheduler é um Scheduler que embrulha o escalonador real (Inner,
+//  padrão MapScheduler como no DefaultSimulatorImpl) e mede cada evento sem
+//  tocar no simulador: o DefaultSimulatorImpl chama RemoveNext() imediatamente
+//  antes de executar um evento e IsEmpty() logo depois, então o intervalo entre
+//  os dois é o custo do callback. O tipo do evento é o typeid da EventImpl
+//  (MakeEvent gera uma classe por assinatura "void (ns3::NrGnbPhy::*)()"), que
+//  identifica a classe dona e, por palavra-chave, a camada (phy, mac, rlc...).
+//  Por tipo: chamadas, tempo real total e histograma log2 do custo por chamada.
+//  Ao longo do tempo: a cada SampleInterval de tempo real grava eventos/s e a
+//  razão tempo simulado / tempo real numa série CSV.
+//  Custo: um lookup em hash por evento e dois steady_clock::now() por evento
+//  cronometrado; com TimingStride = N só 1 em N eventos é cronometrado e o tempo
+//  de cada tipo é extrapolado pela sua contagem total. O custo do relógio é
+//  calibrado na criação e a sobrecarga estimada sai no relatório.
+//
+//  Instalação (pode ser feita depois do simulador criado; os eventos pendentes
+//  são transferidos):
+//    ObjectFactory f;
+//    f.SetTypeId("ns3::ProfilingScheduler");
+//    f.Set("ReportFile", StringValue("x-events.csv"));
+//    Simulator::SetScheduler(f);
+//    ...
+//    ProfilingScheduler::Report(); // antes do Simulator::Destroy (ou no destrutor)
+
+#ifndef URBANO_EVENT_PROFILER_H
+#define URBANO_EVENT_PROFILER_H
+
+#include "ns3/core-module.h"
+
+#include <cxxabi.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+class ProfilingScheduler : public Scheduler
+{
+  public:
+    static constexpr int N_BUCKETS = 12; // < 256 ns, < 512 ns, ..., >= 262 us
+
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::ProfilingScheduler")
+                .SetParent<Scheduler>()
+                .SetGroupName("Core")
+                .AddConstructor<ProfilingScheduler>()
+                .AddAttribute("Inner",
+                              "TypeId do escalonador embrulhado",
+                              StringValue("ns3::MapScheduler"),
+                              MakeStringAccessor(&ProfilingScheduler::SetInnerType),
+                              MakeStringChecker())
+                .AddAttribute("ReportFile",
+                              "CSV com todos os tipos de evento (vazio = não grava)",
+                              StringValue("event-profile.csv"),
+                              MakeStringAccessor(&ProfilingScheduler::m_reportFile),
+                              MakeStringChecker())
+                .AddAttribute("TimelineFile",
+                              "CSV com eventos/s e tempo simulado/tempo real ao longo da execução",
+                              StringValue("event-timeline.csv"),
+                              MakeStringAccessor(&ProfilingScheduler::m_timelineFile),
+                              MakeStringChecker())
+                .AddAttribute("SampleInterval",
+                              "Intervalo (tempo real, s) entre amostras da série",
+                              DoubleValue(1.0),
+                              MakeDoubleAccessor(&ProfilingScheduler::m_sampleInterval),
+                              MakeDoubleChecker<double>(0.001))
+                .AddAttribute("TimingStride",
+                              "Cronometra 1 a cada N eventos (todos são contados)",
+                              UintegerValue(1),
+                              MakeUintegerAccessor(&ProfilingScheduler::m_stride),
+                              MakeUintegerChecker<uint32_t>(1))
+                .AddAttribute("TopN",
+                              "Tipos de evento listados no relatório de texto",
+                              UintegerValue(20),
+                              MakeUintegerAccessor(&ProfilingScheduler::m_topN),
+                              MakeUintegerChecker<uint32_t>());
+        return tid;
+    }
+
+    ProfilingScheduler()
+        : m_stride(1),
+          m_pending(-1),
+          m_events(0),
+          m_lastSampleEvents(0),
+          m_lastSampleSimTs(0),
+          m_currentTs(0),
+          m_reported(false)
+    {
+        SetInnerType("ns3::MapScheduler");
+        m_origin = Clock::now();
+        m_lastSample = m_origin;
+        CalibrateClock();
+        s_instance = this;
+    }
+
+    ~ProfilingScheduler() override
+    {
+        DoReport();
+        if (s_instance == this)
+        {
+            s_instance = nullptr;
+        }
+    }
+
+    // relatório do escalonador ativo (chamar antes do Simulator::Destroy)
+    static void Report()
+    {
+        if (s_instance)
+        {
+            s_instance->DoReport();
+        }
+    }
+
+    void SetInnerType(std::string typeId)
+    {
+        ObjectFactory f;
+        f.SetTypeId(typeId);
+        m_inner = f.Create<Scheduler>();
+    }
+
+    void Insert(const Event& ev) override
+    {
+        m_inner->Insert(ev);
+    }
+
+    bool IsEmpty() const override
+    {
+        if (m_pending >= 0)
+        {
+            Close(Clock::now());
+        }
+        return m_inner->IsEmpty();
+    }
+
+    Event PeekNext() const override
+    {
+        return m_inner->PeekNext();
+    }
+
+    Event RemoveNext() override
+    {
+        Event ev = m_inner->RemoveNext();
+        uint32_t type = TypeIndex(typeid(*ev.impl));
+        m_stats[type].count++;
+        m_currentTs = ev.key.m_ts;
+        if (++m_events % m_stride != 0)
+        {
+            return ev;
+        }
+        Clock::time_point now = Clock::now();
+        if (m_pending >= 0)
+        {
+            Close(now);
+        }
+        m_pending = type;
+        m_start = now;
+        if (m_events % (1024 * m_stride) == 0 &&
+            std::chrono::duration<double>(now - m_lastSample).count() >= m_sampleInterval)
+        {
+            Sample(now);
+        }
+        return ev;
+    }
+
+    void Remove(const Event& ev) override
+    {
+        m_inner->Remove(ev);
+    }
+
+  protected:
+    void DoDispose() override
+    {
+        DoReport();
+        m_inner = nullptr;
+        Scheduler::DoDispose();
+    }
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct TypeStats
+    {
+        const std::type_info* type;
+        uint64_t count = 0;
+        uint64_t timed = 0;
+        uint64_t ns = 0;
+        uint64_t hist[N_BUCKETS] = {};
+    };
+
+    struct TimelineRow
+    {
+        double wallS;
+        double simS;
+        double eventsPerS;
+        double rtf;
+    };
+
+    uint32_t TypeIndex(const std::type_info& t)
+    {
+        auto it = m_index.find(&t);
+        if (it != m_index.end())
+        {
+            return it->second;
+        }
+        TypeStats s;
+        s.type = &t;
+        m_stats.push_back(s);
+        m_index[&t] = m_stats.size() - 1;
+        return m_stats.size() - 1;
+    }
+
+    void Close(Clock::time_point now) const
+    {
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_start).count();
+        TypeStats& s = m_stats[m_pending];
+        s.timed++;
+        s.ns += ns;
+        int b = 0;
+        for (uint64_t v = ns >> 8; v && b < N_BUCKETS - 1; v >>= 1)
+        {
+            b++;
+        }
+        s.hist[b]++;
+        m_pending = -1;
+    }
+
+    void Sample(Clock::time_point now)
+    {
+        double dw = std::chrono::duration<double>(now - m_lastSample).count();
+        if (dw <= 0)
+        {
+            return;
+        }
+        double simS = TimeStep(m_currentTs).GetSeconds();
+        double ds = simS - TimeStep(m_lastSampleSimTs).GetSeconds();
+        TimelineRow r;
+        r.wallS = std::chrono::duration<double>(now - m_origin).count();
+        r.simS = simS;
+        r.eventsPerS = (m_events - m_lastSampleEvents) / dw;
+        r.rtf = ds / dw;
+        m_timeline.push_back(r);
+        m_lastSample = now;
+        m_lastSampleEvents = m_events;
+        m_lastSampleSimTs = m_currentTs;
+    }
+
+    void CalibrateClock()
+    {
+        const int n = 10000;
+        Clock::time_point t0 = Clock::now();
+        for (int i = 0; i < n; i++)
+        {
+            m_start = Clock::now();
+        }
+        m_clockNs =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count() /
+            static_cast<double>(n);
+    }
+
+    static std::string Demangle(const char* name)
+    {
+        int status = 0;
+        char* d = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+        std::string out = (status == 0 && d) ? d : name;
+        std::free(d);
+        return out;
+    }
+
+    // classe dona: primeiro "ns3::X::*" (membro) ou "(*)(" (função livre)
+    static std::string Owner(const std::string& type)
+    {
+        static const std::regex member("ns3::([A-Za-z0-9_]+)(<[^:]*>)?::\\*");
+        std::smatch m;
+        if (std::regex_search(type, m, member))
+        {
+            return m[1];
+        }
+        if (type.find("(*)(") != std::string::npos)
+        {
+            return "<função>";
+        }
+        return "<outro>";
+    }
+
+    static std::string Layer(const std::string& owner)
+    {
+        static const std::pair<const char*, const char*> keys[] = {
+            {"Spectrum", "phy"}, {"Phy", "phy"},        {"Channel", "phy"},
+            {"Harq", "mac"},     {"Sched", "mac-sched"}, {"Mac", "mac"},
+            {"Rlc", "rlc"},      {"Pdcp", "pdcp"},       {"Rrc", "rrc"},
+            {"Epc", "epc"},      {"Mobility", "mobility"}, {"Client", "app"},
+            {"Sink", "app"},     {"OnOff", "app"},       {"Application", "app"},
+            {"Tcp", "internet"}, {"Udp", "internet"},    {"Ipv4", "internet"},
+            {"Arp", "internet"}, {"Socket", "internet"}, {"Flow", "flowmon"},
+        };
+        for (const auto& k : keys)
+        {
+            if (owner.find(k.first) != std::string::npos)
+            {
+                return k.second;
+            }
+        }
+        return "other";
+    }
+
+    void DoReport()
+    {
+        if (m_reported)
+        {
+            return;
+        }
+        m_reported = true;
+        if (m_pending >= 0)
+        {
+            Close(Clock::now());
+        }
+        Sample(Clock::now());
+
+        // agrega por nome (o mesmo tipo pode ter type_info distintos entre bibliotecas)
+        struct Row
+        {
+            std::string type;
+            std::string owner;
+            std::string layer;
+            uint64_t count = 0;
+            uint64_t ns = 0;
+            uint64_t hist[N_BUCKETS] = {};
+        };
+        std::map<std::string, Row> byName;
+        uint64_t totalNs = 0;
+        uint64_t totalCount = 0;
+        uint64_t totalTimed = 0;
+        for (const auto& s : m_stats)
+        {
+            std::string name = Demangle(s.type->name());
+            Row& r = byName[name];
+            r.type = name;
+            // extrapola o tempo cronometrado para todas as chamadas do tipo
+            uint64_t ns = s.timed ? static_cast<uint64_t>(s.ns * (double(s.count) / s.timed)) : 0;
+            r.count += s.count;
+            r.ns += ns;
+            for (int b = 0; b < N_BUCKETS; b++)
+            {
+                r.hist[b] += s.hist[b];
+            }
+            totalNs += ns;
+            totalCount += s.count;
+            totalTimed += s.timed;
+        }
+        std::vector<Row> rows;
+        std::map<std::string, std::pair<uint64_t, uint64_t>> byLayer;
+        for (auto& kv : byName)
+        {
+            kv.second.owner = Owner(kv.second.type);
+            kv.second.layer = Layer(kv.second.owner);
+            byLayer[kv.second.layer].first += kv.second.count;
+            byLayer[kv.second.layer].second += kv.second.ns;
+            rows.push_back(kv.second);
+        }
+        std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.ns > b.ns; });
+
+        double wallS = std::chrono::duration<double>(Clock::now() - m_origin).count();
+        double simS = TimeStep(m_currentTs).GetSeconds();
+        std::cout << "[EVENTS] " << totalCount << " eventos, " << totalNs * 1e-9
+                  << " s em callbacks, " << (wallS > 0 ? totalCount / wallS : 0.0)
+                  << " eventos/s, tempo simulado/real " << (wallS > 0 ? simS / wallS : 0.0)
+                  << ", sobrecarga estimada "
+                  << (totalNs ? 100.0 * 2 * m_clockNs * totalTimed / totalNs : 0.0) << "%"
+                  << std::endl;
+        for (const auto& kv : byLayer)
+        {
+            std::cout << "[EVENTS]   camada " << std::setw(10) << kv.first << ": "
+                      << std::setw(6) << std::fixed << std::setprecision(1)
+                      << (totalNs ? 100.0 * kv.second.second / totalNs : 0.0) << "% ("
+                      << kv.second.first << " eventos)" << std::defaultfloat << std::endl;
+        }
+        for (size_t i = 0; i < rows.size() && i < m_topN; i++)
+        {
+            const Row& r = rows[i];
+            std::cout << "[EVENTS] " << std::setw(2) << i + 1 << ". " << std::fixed
+                      << std::setprecision(1) << std::setw(5) << (100.0 * r.ns / totalNs)
+                      << "% " << std::setw(10) << r.count << "x " << std::setprecision(2)
+                      << std::setw(8) << (r.ns * 1e-3 / r.count) << " us  " << r.owner << " ["
+                      << r.layer << "]" << std::defaultfloat << std::endl;
+        }
+
+        if (!m_reportFile.empty())
+        {
+            std::ofstream out(m_reportFile);
+            out << "owner,layer,count,wall_s,mean_us,share_pct";
+            for (int b = 0; b < N_BUCKETS - 1; b++)
+            {
+                out << ",lt_" << (256 << b) << "ns";
+            }
+            out << ",ge_" << (256 << (N_BUCKETS - 2)) << "ns";
+            out << ",type\n";
+            for (const auto& r : rows)
+            {
+                out << r.owner << "," << r.layer << "," << r.count << "," << r.ns * 1e-9 << ","
+                    << (r.count ? r.ns * 1e-3 / r.count : 0.0) << ","
+                    << (totalNs ? 100.0 * r.ns / totalNs : 0.0);
+                for (int b = 0; b < N_BUCKETS; b++)
+                {
+                    out << "," << r.hist[b];
+                }
+                out << ",\"" << r.type << "\"\n";
+            }
+        }
+        if (!m_timelineFile.empty())
+        {
+            std::ofstream out(m_timelineFile);
+            out << "wall_s,sim_s,events_per_s,sim_over_wall\n";
+            for (const auto& r : m_timeline)
+            {
+                out << r.wallS << "," << r.simS << "," << r.eventsPerS << "," << r.rtf << "\n";
+            }
+        }
+    }
+
+    Ptr<Scheduler> m_inner;
+    std::string m_reportFile;
+    std::string m_timelineFile;
+    double m_sampleInterval;
+    uint32_t m_stride;
+    uint32_t m_topN;
+
+    mutable std::vector<TypeStats> m_stats;
+    std::unordered_map<const std::type_info*, uint32_t> m_index;
+    mutable int64_t m_pending;
+    Clock::time_point m_start;
+    Clock::time_point m_origin;
+    Clock::time_point m_lastSample;
+    uint64_t m_events;
+    uint64_t m_lastSampleEvents;
+    uint64_t m_lastSampleSimTs;
+    uint64_t m_currentTs;
+    std::vector<TimelineRow> m_timeline;
+    double m_clockNs;
+    bool m_reported;
+
+    static ProfilingScheduler* s_instance;
+};
+
+inline ProfilingScheduler* ProfilingScheduler::s_instance = nullptr;
+
+NS_OBJECT_ENSURE_REGISTERED(ProfilingScheduler);
+
+// liga o profiler de eventos no simulador (os eventos já agendados são transferidos)
+inline void
+EnableEventProfiler(const std::string& prefix, uint32_t stride = 1)
+{
+    ObjectFactory f;
+    f.SetTypeId("ns3::ProfilingScheduler");
+    f.Set("ReportFile", StringValue(prefix + "-events.csv"));
+    f.Set("TimelineFile", StringValue(prefix + "-event-timeline.csv"));
+    f.Set("TimingStride", UintegerValue(stride));
+    Simulator::SetScheduler(f);
+}
+
+} // namespace ns3
+
+#endif // URBANO_EVENT_PROFILER_H
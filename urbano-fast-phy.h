@@ -0,0 +1,434 @@
+// urbano-fast-phy.h
+// PHY rápido (link-to-system): SINR efetivo -> BLER por tabela pré-calculada.
+//  O NrSpectrumPhy avalia o modelo de erro (ErrorModelType) em todo TB de todo UE
+//  e o NrAmc o usa de novo para achar o MCS do CQI; com 400 MHz e numerologia
+//  alta isso domina o custo por slot. NrFastPhyErrorModel troca a avaliação por:
+//   - SINR efetivo EESM: -β·ln(média exp(-sinr_rb/β)) nos RBs alocados;
+//   - BLER do code block por interpolação linear (em dB) numa tabela por MCS,
+//     passo SinrStepDb de -10 a 35 dB;
+//   - BLER do TB = 1 - (1 - BLER_cb)^C, C = code blocks (LDPC, Kcb 8448 ou 3840);
+//   - retransmissões: soma (chase) dos SINR efetivos lineares de cada transmissão;
+//     a saída guarda só o da própria transmissão, porque o NrSpectrumPhy acumula
+//     todas as saídas no histórico.
+//  As tabelas saem do próprio modelo exato ("Inner", o padrão do NR é o
+//  NrLteMiErrorModel), sondado uma vez na primeira chamada: curva com SINR plano
+//  num TB de um code block e β de cada MCS calibrado com um SINR em dois níveis
+//  (±3 dB em volta do ponto de 50%). Com CacheFile as tabelas são gravadas e
+//  recarregadas nas rodadas seguintes (cabeçalho com Inner/passo/MCS).
+//  O NrSpectrumPhy cria um modelo por TB, então as tabelas e as contagens ficam
+//  num registro estático por Inner. As chamadas sem histórico incluem as sondas
+//  de CQI do NrAmc (mesmo tipo de modelo, mesma assinatura), que não se
+//  distinguem de primeiras transmissões: Report() conta avaliações e, à parte,
+//  as retransmissões. A cada ValidateEvery avaliações sem histórico o modelo
+//  exato também é avaliado e Report() mostra a diferença de BLER e da vazão
+//  esperada (Σ bits·(1-BLER)) entre tabela e exato, separada entre TBs de um
+//  code block (o caso das tabelas) e de vários (a tabela elevada a C), que é
+//  onde o TB de referência pode divergir da segmentação do modelo exato.
+//  BLER e vazão de rodadas reais com e sem fastPhy: urbano_fastphy_bench.py.
+
+#ifndef URBANO_FAST_PHY_H
+#define URBANO_FAST_PHY_H
+
+#include "ns3/core-module.h"
+#include "ns3/nr-module.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+// saída com o SINR efetivo (linear) desta transmissão, para combinar retransmissões
+struct NrFastPhyOutput : public NrErrorModelOutput
+{
+    NrFastPhyOutput(double tbler, double sinrEff)
+        : NrErrorModelOutput(tbler),
+          m_sinrEff(sinrEff)
+    {
+    }
+
+    double m_sinrEff;
+};
+
+class NrFastPhyErrorModel : public NrErrorModel
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::NrFastPhyErrorModel")
+                .SetParent<NrErrorModel>()
+                .SetGroupName("nr")
+                .AddConstructor<NrFastPhyErrorModel>()
+                .AddAttribute("Inner",
+                              "TypeId do modelo de erro exato usado para gerar as tabelas",
+                              StringValue("ns3::NrLteMiErrorModel"),
+                              MakeStringAccessor(&NrFastPhyErrorModel::m_innerType),
+                              MakeStringChecker())
+                .AddAttribute("SinrStepDb",
+                              "Passo (dB) da tabela SINR -> BLER",
+                              DoubleValue(0.25),
+                              MakeDoubleAccessor(&NrFastPhyErrorModel::m_stepDb),
+                              MakeDoubleChecker<double>(0.01))
+                .AddAttribute("CacheFile",
+                              "Arquivo das tabelas (lido se compatível, senão gravado); vazio = não usa",
+                              StringValue(""),
+                              MakeStringAccessor(&NrFastPhyErrorModel::m_cacheFile),
+                              MakeStringChecker())
+                .AddAttribute("ValidateEvery",
+                              "Avaliar também o modelo exato a cada N TBs; 0 = não valida",
+                              UintegerValue(200),
+                              MakeUintegerAccessor(&NrFastPhyErrorModel::m_validateEvery),
+                              MakeUintegerChecker<uint32_t>());
+        return tid;
+    }
+
+    NrFastPhyErrorModel()
+        : m_stepDb(0.25),
+          m_validateEvery(200),
+          m_tables(nullptr)
+    {
+    }
+
+    Ptr<NrErrorModelOutput> GetTbDecodificationStats(const SpectrumValue& sinr,
+                                                      const std::vector<int>& map,
+                                                      uint32_t size,
+                                                      uint8_t mcs,
+                                                      const NrErrorModelHistory& history) override
+    {
+        Tables& t = GetTables(sinr);
+        mcs = std::min<uint8_t>(mcs, t.cbler.size() - 1);
+        const double eff = Eesm(sinr, map, t.beta[mcs]);
+        double combined = eff;
+        for (const auto& h : history)
+        {
+            Ptr<NrFastPhyOutput> prev = DynamicCast<NrFastPhyOutput>(h);
+            if (prev)
+            {
+                combined += prev->m_sinrEff;
+            }
+        }
+        double cbler = Lookup(t, mcs, 10 * std::log10(std::max(combined, 1e-12)));
+        const uint32_t blocks = CodeBlocks(size);
+        double tbler = 1.0 - std::pow(1.0 - cbler, blocks);
+        t.evaluations++;
+        t.retx += !history.empty();
+
+        if (m_validateEvery > 0 && history.empty() && (t.evaluations - t.retx) % m_validateEvery == 0)
+        {
+            double exact = t.inner->GetTbDecodificationStats(sinr, map, size, mcs, NrErrorModelHistory())->m_tbler;
+            Validation& v = t.validation[blocks > 1];
+            v.count++;
+            v.blerFast += tbler;
+            v.blerExact += exact;
+            v.absErr += std::abs(tbler - exact);
+            v.bitsFast += 8.0 * size * (1.0 - tbler);
+            v.bitsExact += 8.0 * size * (1.0 - exact);
+        }
+        return Create<NrFastPhyOutput>(tbler, eff);
+    }
+
+    double GetSpectralEfficiencyForCqi(uint8_t cqi) override
+    {
+        return Inner()->GetSpectralEfficiencyForCqi(cqi);
+    }
+
+    double GetSpectralEfficiencyForMcs(uint8_t mcs) const override
+    {
+        return Inner()->GetSpectralEfficiencyForMcs(mcs);
+    }
+
+    uint32_t GetPayloadSize(uint32_t usefulSc, uint8_t mcs, uint32_t rbNum, Mode mode) const override
+    {
+        return Inner()->GetPayloadSize(usefulSc, mcs, rbNum, mode);
+    }
+
+    uint32_t GetMaxCbSize(uint32_t tbSize, uint8_t mcs) const override
+    {
+        return Inner()->GetMaxCbSize(tbSize, mcs);
+    }
+
+    uint8_t GetMaxMcs() const override
+    {
+        return Inner()->GetMaxMcs();
+    }
+
+    // resumo por modelo interno; chamar no fim da simulação
+    static void Report()
+    {
+        for (const auto& kv : Registry())
+        {
+            const Tables& t = kv.second;
+            std::cout << "[FASTPHY] " << kv.first << ": " << t.evaluations
+                      << " avaliações por tabela, TBs e sondas de CQI do NrAmc (" << t.retx
+                      << " retransmissões; " << t.cbler.size() << " MCS x " << t.points << " pontos de "
+                      << t.stepDb << " dB, "
+                      << (t.fromCache ? "lida do cache" : "calculada em " + std::to_string(t.buildMs) + " ms")
+                      << ")" << std::endl;
+            for (int multi = 0; multi < 2; multi++)
+            {
+                const Validation& v = t.validation[multi];
+                if (v.count == 0)
+                {
+                    continue;
+                }
+                std::cout << "[FASTPHY] validação em " << v.count << " avaliações sem histórico (inclui sondas de CQI), "
+                          << (multi ? "TBs de 2+ code blocks" : "TBs de 1 code block") << ": BLER média tabela "
+                          << v.blerFast / v.count << " x exato " << v.blerExact / v.count << " (|Δ| médio "
+                          << v.absErr / v.count << "), vazão esperada "
+                          << (v.bitsExact > 0 ? 100.0 * (v.bitsFast - v.bitsExact) / v.bitsExact : 0.0)
+                          << "% em relação ao exato" << std::endl;
+            }
+        }
+    }
+
+  private:
+    static constexpr double kMinDb = -10.0;
+    static constexpr double kMaxDb = 35.0;
+    static constexpr uint32_t kRefTbBytes = 475; // 3800 bits + CRC = 1 code block
+
+    // tabela x modelo exato nas avaliações validadas
+    struct Validation
+    {
+        uint64_t count = 0;
+        double blerFast = 0;
+        double blerExact = 0;
+        double absErr = 0;
+        double bitsFast = 0;
+        double bitsExact = 0;
+    };
+
+    struct Tables
+    {
+        Ptr<NrErrorModel> inner;
+        double stepDb = 0;
+        uint32_t points = 0;
+        std::vector<double> beta;               // por MCS
+        std::vector<std::vector<float>> cbler;  // [MCS][ponto]
+        bool built = false;
+        bool fromCache = false;
+        uint64_t buildMs = 0;
+        uint64_t evaluations = 0; // TBs decodificados + sondas de CQI do NrAmc
+        uint64_t retx = 0;        // avaliações com histórico HARQ (só do PHY)
+        Validation validation[2]; // [0] TBs de 1 code block, [1] de vários
+    };
+
+    static std::map<std::string, Tables>& Registry()
+    {
+        static std::map<std::string, Tables> r;
+        return r;
+    }
+
+    Tables& Shared() const
+    {
+        if (!m_tables)
+        {
+            Tables& t = Registry()[m_innerType];
+            if (!t.inner)
+            {
+                ObjectFactory f;
+                f.SetTypeId(m_innerType);
+                t.inner = f.Create<NrErrorModel>();
+                t.stepDb = m_stepDb;
+            }
+            m_tables = &t;
+        }
+        return *m_tables;
+    }
+
+    Ptr<NrErrorModel> Inner() const
+    {
+        return Shared().inner;
+    }
+
+    Tables& GetTables(const SpectrumValue& sinr)
+    {
+        Tables& t = Shared();
+        if (!t.built)
+        {
+            if (!Load(t))
+            {
+                auto t0 = std::chrono::steady_clock::now();
+                Build(t, sinr);
+                t.buildMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                std::chrono::steady_clock::now() - t0)
+                                .count();
+                Save(t);
+            }
+            t.built = true;
+        }
+        return t;
+    }
+
+    static double Eesm(const SpectrumValue& sinr, const std::vector<int>& map, double beta)
+    {
+        if (map.empty())
+        {
+            return 0.0;
+        }
+        double sum = 0;
+        for (int rb : map)
+        {
+            sum += std::exp(-sinr.ValuesAt(rb) / beta);
+        }
+        return -beta * std::log(std::max(sum / map.size(), 1e-300));
+    }
+
+    static double Lookup(const Tables& t, uint8_t mcs, double db)
+    {
+        double x = std::clamp((db - kMinDb) / t.stepDb, 0.0, t.points - 1.0);
+        uint32_t i = std::min<uint32_t>(x, t.points - 2);
+        double f = x - i;
+        const std::vector<float>& c = t.cbler[mcs];
+        return (1 - f) * c[i] + f * c[i + 1];
+    }
+
+    // SINR plano (dB) com o BLER dado (curva não crescente)
+    static double InverseLookup(const Tables& t, uint8_t mcs, double bler)
+    {
+        const std::vector<float>& c = t.cbler[mcs];
+        for (uint32_t i = 0; i + 1 < t.points; i++)
+        {
+            if (c[i] >= bler && c[i + 1] < bler)
+            {
+                double f = (c[i] - bler) / (c[i] - c[i + 1]);
+                return kMinDb + (i + f) * t.stepDb;
+            }
+        }
+        return c.front() < bler ? kMinDb : kMaxDb;
+    }
+
+    // code blocks do LDPC (38.212): BG1 (Kcb 8448) acima de 3824 bits, senão BG2 (3840)
+    static uint32_t CodeBlocks(uint32_t sizeBytes)
+    {
+        const double b = 8.0 * sizeBytes + 24;
+        const double kcb = b > 3824 ? 8448 : 3840;
+        return b <= kcb ? 1 : static_cast<uint32_t>(std::ceil(b / (kcb - 24)));
+    }
+
+    void Build(Tables& t, const SpectrumValue& sinr) const
+    {
+        const uint32_t nRb = sinr.GetValuesN();
+        const uint32_t nMcs = t.inner->GetMaxMcs() + 1;
+        t.points = static_cast<uint32_t>(std::ceil((kMaxDb - kMinDb) / t.stepDb)) + 1;
+        t.cbler.assign(nMcs, std::vector<float>(t.points));
+        t.beta.assign(nMcs, 1.0);
+
+        SpectrumValue v(sinr.GetSpectrumModel());
+        std::vector<int> all(nRb);
+        std::iota(all.begin(), all.end(), 0);
+        for (uint32_t m = 0; m < nMcs; m++)
+        {
+            float prev = 1.0f;
+            for (uint32_t p = 0; p < t.points; p++)
+            {
+                v = std::pow(10.0, (kMinDb + p * t.stepDb) / 10.0);
+                double b = t.inner->GetTbDecodificationStats(v, all, kRefTbBytes, m, NrErrorModelHistory())->m_tbler;
+                prev = std::min(prev, static_cast<float>(b));
+                t.cbler[m][p] = prev;
+            }
+            t.beta[m] = CalibrateBeta(t, m, v, all);
+        }
+    }
+
+    // β tal que o EESM de um SINR em dois níveis reproduza o BLER do modelo exato
+    double CalibrateBeta(const Tables& t, uint8_t mcs, SpectrumValue& v, const std::vector<int>& all) const
+    {
+        double mid = std::pow(10.0, InverseLookup(t, mcs, 0.5) / 10.0);
+        double s1 = mid / 2.0;
+        double s2 = mid * 2.0;
+        if (all.size() < 2)
+        {
+            return mid;
+        }
+        for (size_t i = 0; i < all.size(); i++)
+        {
+            v[i] = i % 2 ? s2 : s1;
+        }
+        double b = t.inner->GetTbDecodificationStats(v, all, kRefTbBytes, mcs, NrErrorModelHistory())->m_tbler;
+        if (b <= 1e-3 || b >= 0.999)
+        {
+            return mid;
+        }
+        double eff = std::pow(10.0, InverseLookup(t, mcs, b) / 10.0);
+        // EESM de {s1, s2} cresce com β, de s1 (β->0) até a média (β->∞)
+        eff = std::clamp(eff, s1 * 1.0001, 0.9999 * (s1 + s2) / 2);
+        double lo = 1e-3 * mid;
+        double hi = 1e3 * mid;
+        for (int it = 0; it < 100; it++)
+        {
+            double beta = std::sqrt(lo * hi);
+            double e = -beta * std::log((std::exp(-s1 / beta) + std::exp(-s2 / beta)) / 2);
+            (e < eff ? lo : hi) = beta;
+        }
+        return std::sqrt(lo * hi);
+    }
+
+    std::string Header(const Tables& t) const
+    {
+        return "urbano-fastphy 1 " + m_innerType + " " + std::to_string(t.stepDb) + " " +
+               std::to_string(t.inner->GetMaxMcs() + 1);
+    }
+
+    bool Load(Tables& t) const
+    {
+        std::ifstream in(m_cacheFile);
+        std::string header;
+        if (m_cacheFile.empty() || !in || !std::getline(in, header) || header != Header(t))
+        {
+            return false;
+        }
+        uint32_t nMcs = t.inner->GetMaxMcs() + 1;
+        in >> t.points;
+        t.beta.assign(nMcs, 1.0);
+        t.cbler.assign(nMcs, std::vector<float>(t.points));
+        for (uint32_t m = 0; m < nMcs && in; m++)
+        {
+            in >> t.beta[m];
+            for (uint32_t p = 0; p < t.points && in; p++)
+            {
+                in >> t.cbler[m][p];
+            }
+        }
+        t.fromCache = static_cast<bool>(in);
+        return t.fromCache;
+    }
+
+    void Save(const Tables& t) const
+    {
+        if (m_cacheFile.empty())
+        {
+            return;
+        }
+        std::ofstream out(m_cacheFile);
+        out << Header(t) << "\n" << t.points << "\n";
+        for (size_t m = 0; m < t.cbler.size(); m++)
+        {
+            out << t.beta[m];
+            for (float c : t.cbler[m])
+            {
+                out << " " << c;
+            }
+            out << "\n";
+        }
+    }
+
+    std::string m_innerType;
+    double m_stepDb;
+    std::string m_cacheFile;
+    uint32_t m_validateEvery;
+    mutable Tables* m_tables;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(NrFastPhyErrorModel);
+
+} // namespace ns3
+
+#endif // URBANO_FAST_PHY_H
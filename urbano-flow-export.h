@@ -0,0 +1,275 @@
+// urbano-flow-export.h
+// Exportação colunar compacta do FlowMonitor (alternativa ao SerializeToXmlFile).
+//  O XML com histogramas para milhares de fluxos passa de centenas de MB e é
+//  lento de gravar e de ler. Aqui GetFlowStats() e as estatísticas dos probes
+//  são gravados por coluna: cada coluna é uma sequência de inteiros de 64 bits
+//  codificados como delta + zigzag + varint. Como os fluxos saem ordenados por
+//  FlowId, colunas como flow_id, IPs, portas e tempos viram 1–2 bytes por linha.
+//  O leitor/conversor para a planilha de resumo é urbano_flowstats.py.
+//
+//  Formato "UFSC" v1 (little-endian):
+//   "UFSC" | u8 versão | u32 nTabelas
+//   por tabela : u8 len + nome | u32 nLinhas | u32 nColunas
+//   por coluna : u8 len + nome | u8 codificação (1 = delta-zigzag-varint) |
+//                u32 nBytes | bytes
+//  Tabelas:
+//   flows      flow_id, protocol, src_ip, src_port, dst_ip, dst_port,
+//              time_first_tx_ns, time_last_tx_ns, time_first_rx_ns, time_last_rx_ns,
+//              delay_sum_ns, jitter_sum_ns, last_delay_ns, tx_bytes, rx_bytes,
+//              tx_packets, rx_packets, lost_packets, times_forwarded, packets_dropped
+//   probes     probe_id, flow_id, delay_from_first_probe_sum_ns, bytes, packets,
+//              bytes_dropped, packets_dropped
+//   histograms (opcional) flow_id, kind (0 atraso, 1 jitter, 2 tamanho de pacote),
+//              bin_start, bin_width, count  (tempos em ns, tamanhos em bytes)
+
+#ifndef URBANO_FLOW_EXPORT_H
+#define URBANO_FLOW_EXPORT_H
+
+#include "ns3/core-module.h"
+#include "ns3/flow-monitor-module.h"
+#include "ns3/internet-module.h"
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+namespace ns3
+{
+
+// ---------- coluna inteira com codificação delta-zigzag-varint ----------
+class ColumnarColumn
+{
+  public:
+    explicit ColumnarColumn(const std::string& name)
+        : m_name(name),
+          m_prev(0)
+    {
+    }
+
+    void Append(int64_t v)
+    {
+        int64_t delta = v - m_prev;
+        m_prev = v;
+        uint64_t zz = (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+        while (zz >= 0x80)
+        {
+            m_bytes.push_back(static_cast<uint8_t>(zz | 0x80));
+            zz >>= 7;
+        }
+        m_bytes.push_back(static_cast<uint8_t>(zz));
+    }
+
+    const std::string& GetName() const
+    {
+        return m_name;
+    }
+
+    const std::vector<uint8_t>& GetBytes() const
+    {
+        return m_bytes;
+    }
+
+  private:
+    std::string m_name;
+    int64_t m_prev;
+    std::vector<uint8_t> m_bytes;
+};
+
+class ColumnarTable
+{
+  public:
+    ColumnarTable(const std::string& name, const std::vector<std::string>& columns)
+        : m_name(name),
+          m_rows(0)
+    {
+        for (const auto& c : columns)
+        {
+            m_columns.emplace_back(c);
+        }
+    }
+
+    // valores na mesma ordem das colunas
+    void AppendRow(const std::vector<int64_t>& values)
+    {
+        NS_ASSERT(values.size() == m_columns.size());
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            m_columns[i].Append(values[i]);
+        }
+        m_rows++;
+    }
+
+    void Write(std::ostream& os) const
+    {
+        WriteString(os, m_name);
+        WriteU32(os, m_rows);
+        WriteU32(os, m_columns.size());
+        for (const auto& c : m_columns)
+        {
+            WriteString(os, c.GetName());
+            os.put(1); // delta-zigzag-varint
+            WriteU32(os, c.GetBytes().size());
+            os.write(reinterpret_cast<const char*>(c.GetBytes().data()), c.GetBytes().size());
+        }
+    }
+
+    static void WriteU32(std::ostream& os, uint32_t v)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            os.put(static_cast<char>((v >> (8 * i)) & 0xff));
+        }
+    }
+
+    static void WriteString(std::ostream& os, const std::string& s)
+    {
+        os.put(static_cast<char>(s.size()));
+        os.write(s.data(), s.size());
+    }
+
+  private:
+    std::string m_name;
+    uint32_t m_rows;
+    std::vector<ColumnarColumn> m_columns;
+};
+
+// ---------- exporta FlowStats + probes ----------
+inline void
+WriteFlowStatsColumnar(Ptr<FlowMonitor> monitor,
+                       Ptr<Ipv4FlowClassifier> classifier,
+                       const std::string& fileName,
+                       bool includeHistograms)
+{
+    ColumnarTable flows("flows",
+                        {"flow_id",          "protocol",         "src_ip",
+                         "src_port",         "dst_ip",           "dst_port",
+                         "time_first_tx_ns", "time_last_tx_ns",  "time_first_rx_ns",
+                         "time_last_rx_ns",  "delay_sum_ns",     "jitter_sum_ns",
+                         "last_delay_ns",    "tx_bytes",         "rx_bytes",
+                         "tx_packets",       "rx_packets",       "lost_packets",
+                         "times_forwarded",  "packets_dropped"});
+    ColumnarTable hist("histograms", {"flow_id", "kind", "bin_start", "bin_width", "count"});
+
+    auto addHistogram = [&hist](FlowId id, int64_t kind, const Histogram& h, double scale) {
+        for (uint32_t b = 0; b < h.GetNBins(); b++)
+        {
+            if (h.GetBinCount(b) == 0)
+            {
+                continue;
+            }
+            hist.AppendRow({static_cast<int64_t>(id),
+                            kind,
+                            static_cast<int64_t>(h.GetBinStart(b) * scale),
+                            static_cast<int64_t>(h.GetBinWidth(b) * scale),
+                            static_cast<int64_t>(h.GetBinCount(b))});
+        }
+    };
+
+    // mesma contagem de perdas que o SerializeToXmlFile faz antes de gravar
+    monitor->CheckForLostPackets();
+    const FlowMonitor::FlowStatsContainer& stats = monitor->GetFlowStats();
+    for (auto it = stats.begin(); it != stats.end(); ++it)
+    {
+        const FlowMonitor::FlowStats& s = it->second;
+        Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(it->first);
+        int64_t dropped = 0;
+        for (uint32_t d : s.packetsDropped)
+        {
+            dropped += d;
+        }
+        flows.AppendRow({static_cast<int64_t>(it->first),
+                         t.protocol,
+                         t.sourceAddress.Get(),
+                         t.sourcePort,
+                         t.destinationAddress.Get(),
+                         t.destinationPort,
+                         s.timeFirstTxPacket.GetNanoSeconds(),
+                         s.timeLastTxPacket.GetNanoSeconds(),
+                         s.timeFirstRxPacket.GetNanoSeconds(),
+                         s.timeLastRxPacket.GetNanoSeconds(),
+                         s.delaySum.GetNanoSeconds(),
+                         s.jitterSum.GetNanoSeconds(),
+                         s.lastDelay.GetNanoSeconds(),
+                         static_cast<int64_t>(s.txBytes),
+                         static_cast<int64_t>(s.rxBytes),
+                         s.txPackets,
+                         s.rxPackets,
+                         s.lostPackets,
+                         s.timesForwarded,
+                         dropped});
+
+        if (includeHistograms)
+        {
+            addHistogram(it->first, 0, s.delayHistogram, 1e9);
+            addHistogram(it->first, 1, s.jitterHistogram, 1e9);
+            addHistogram(it->first, 2, s.packetSizeHistogram, 1.0);
+        }
+    }
+
+    ColumnarTable probes("probes",
+                         {"probe_id",
+                          "flow_id",
+                          "delay_from_first_probe_sum_ns",
+                          "bytes",
+                          "packets",
+                          "bytes_dropped",
+                          "packets_dropped"});
+    const FlowMonitor::FlowProbeContainer& all = monitor->GetAllProbes();
+    for (uint32_t p = 0; p < all.size(); p++)
+    {
+        FlowProbe::Stats ps = all[p]->GetStats();
+        for (auto it = ps.begin(); it != ps.end(); ++it)
+        {
+            int64_t bytesDropped = 0;
+            int64_t packetsDropped = 0;
+            for (uint64_t b : it->second.bytesDropped)
+            {
+                bytesDropped += b;
+            }
+            for (uint32_t n : it->second.packetsDropped)
+            {
+                packetsDropped += n;
+            }
+            probes.AppendRow({static_cast<int64_t>(p),
+                              static_cast<int64_t>(it->first),
+                              it->second.delayFromFirstProbeSum.GetNanoSeconds(),
+                              static_cast<int64_t>(it->second.bytes),
+                              it->second.packets,
+                              bytesDropped,
+                              packetsDropped});
+        }
+    }
+
+    std::ofstream os(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    os.write("UFSC", 4);
+    os.put(1);
+    ColumnarTable::WriteU32(os, includeHistograms ? 3 : 2);
+    flows.Write(os);
+    probes.Write(os);
+    if (includeHistograms)
+    {
+        hist.Write(os);
+    }
+}
+
+// ---------- mede tempo de gravação e tamanho do arquivo ----------
+inline void
+TimedExport(const std::string& label, const std::string& fileName, std::function<void()> exporter)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    exporter();
+    double ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    struct stat st;
+    double mb = (stat(fileName.c_str(), &st) == 0) ? st.st_size / 1048576.0 : 0.0;
+    std::cout << "[EXPORT] " << label << ": " << fileName << " " << mb << " MB em " << ms
+              << " ms" << std::endl;
+}
+
+} // namespace ns3
+
+#endif // URBANO_FLOW_EXPORT_H
@@ -0,0 +1,461 @@
+// urbano-flow-sampling.h
+// FlowMonitor por amostragem estratificada de UEs.
+//  Com InstallAll (ou PGW + todos os UEs) o monitor classifica e rastreia cada
+//  pacote de todos os fluxos, e guarda FlowStats de todos eles. Aqui uma fração
+//  dos UEs é sorteada por estrato (setor x anel de distância ao site) e só os
+//  fluxos desses UEs são instrumentados:
+//   - SampledIpv4FlowProbe: mesma contabilidade do Ipv4FlowProbe (tag no 1º
+//     envio, ReportFirstTx/ReportLastRx/ReportDrop), mas só para pacotes com
+//     origem ou destino amostrado; os demais custam uma busca em hash. Vai no
+//     PGW e nos UEs amostrados (os outros UEs ficam sem probe);
+//   - o FlowMonitor/classificador são os do FlowMonitorHelper, então KPIs por
+//     janela, exportação colunar e relatório do mix funcionam como antes (sobre
+//     os fluxos amostrados);
+//   - Report() extrapola para a rede inteira com o estimador estratificado
+//     (total = soma N_h * média_h; atraso e perda como razões) e IC de 95%
+//     (normal, com correção de população finita; estrato com um só UE usa a
+//     variância agrupada dos demais).
+//  Memória e custo por pacote do monitor passam a escalar com a amostra.
+//  Fila de devices não é observada (o Ipv4FlowProbe também liga nos drops de fila).
+
+#ifndef URBANO_FLOW_SAMPLING_H
+#define URBANO_FLOW_SAMPLING_H
+
+#include "ns3/core-module.h"
+#include "ns3/flow-monitor-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace ns3
+{
+
+// ---------- tag do pacote rastreado ----------
+class SampledFlowTag : public Tag
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("ns3::SampledFlowTag")
+                                .SetParent<Tag>()
+                                .SetGroupName("FlowMonitor")
+                                .AddConstructor<SampledFlowTag>();
+        return tid;
+    }
+
+    TypeId GetInstanceTypeId() const override
+    {
+        return GetTypeId();
+    }
+
+    SampledFlowTag() = default;
+
+    SampledFlowTag(FlowId flowId, FlowPacketId packetId, uint32_t size, Ipv4Address src, Ipv4Address dst)
+        : m_flowId(flowId),
+          m_packetId(packetId),
+          m_size(size),
+          m_src(src),
+          m_dst(dst)
+    {
+    }
+
+    uint32_t GetSerializedSize() const override
+    {
+        return 20;
+    }
+
+    void Serialize(TagBuffer buf) const override
+    {
+        buf.WriteU32(m_flowId);
+        buf.WriteU32(m_packetId);
+        buf.WriteU32(m_size);
+        buf.WriteU32(m_src.Get());
+        buf.WriteU32(m_dst.Get());
+    }
+
+    void Deserialize(TagBuffer buf) override
+    {
+        m_flowId = buf.ReadU32();
+        m_packetId = buf.ReadU32();
+        m_size = buf.ReadU32();
+        m_src.Set(buf.ReadU32());
+        m_dst.Set(buf.ReadU32());
+    }
+
+    void Print(std::ostream& os) const override
+    {
+        os << "FlowId=" << m_flowId << " PacketId=" << m_packetId << " size=" << m_size;
+    }
+
+    // a tag continua no pacote interno do túnel GTP: só vale com o mesmo par IP
+    bool Matches(const Ipv4Header& h) const
+    {
+        return m_src == h.GetSource() && m_dst == h.GetDestination();
+    }
+
+    FlowId m_flowId = 0;
+    FlowPacketId m_packetId = 0;
+    uint32_t m_size = 0;
+    Ipv4Address m_src;
+    Ipv4Address m_dst;
+};
+
+// ---------- probe IPv4 só para os endereços amostrados ----------
+class SampledIpv4FlowProbe : public FlowProbe
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("ns3::SampledIpv4FlowProbe")
+                                .SetParent<FlowProbe>()
+                                .SetGroupName("FlowMonitor");
+        return tid;
+    }
+
+    SampledIpv4FlowProbe(Ptr<FlowMonitor> monitor,
+                         Ptr<Ipv4FlowClassifier> classifier,
+                         Ptr<Node> node,
+                         std::shared_ptr<const std::unordered_set<uint32_t>> sampled)
+        : FlowProbe(monitor),
+          m_classifier(classifier),
+          m_sampled(sampled)
+    {
+        Ptr<Ipv4L3Protocol> ipv4 = node->GetObject<Ipv4L3Protocol>();
+        NS_ABORT_MSG_IF(!ipv4, "SampledIpv4FlowProbe: nó sem pilha IPv4");
+        ipv4->TraceConnectWithoutContext("SendOutgoing",
+                                         MakeCallback(&SampledIpv4FlowProbe::SendOutgoing, this));
+        ipv4->TraceConnectWithoutContext("LocalDeliver",
+                                         MakeCallback(&SampledIpv4FlowProbe::LocalDeliver, this));
+        ipv4->TraceConnectWithoutContext("Drop", MakeCallback(&SampledIpv4FlowProbe::Drop, this));
+    }
+
+  private:
+    bool IsSampled(const Ipv4Header& h) const
+    {
+        return m_sampled->count(h.GetSource().Get()) || m_sampled->count(h.GetDestination().Get());
+    }
+
+    void SendOutgoing(const Ipv4Header& h, Ptr<const Packet> p, uint32_t)
+    {
+        if (!IsSampled(h))
+        {
+            return;
+        }
+        SampledFlowTag tag;
+        if (p->PeekPacketTag(tag))
+        {
+            if (tag.Matches(h))
+            {
+                return;
+            }
+            const_cast<Packet*>(PeekPointer(p))->RemovePacketTag(tag);
+        }
+        FlowId flowId;
+        FlowPacketId packetId;
+        if (!m_classifier->Classify(h, p, &flowId, &packetId))
+        {
+            return;
+        }
+        uint32_t size = p->GetSize() + h.GetSerializedSize();
+        p->AddPacketTag(SampledFlowTag(flowId, packetId, size, h.GetSource(), h.GetDestination()));
+        m_flowMonitor->ReportFirstTx(this, flowId, packetId, size);
+    }
+
+    void LocalDeliver(const Ipv4Header& h, Ptr<const Packet> p, uint32_t)
+    {
+        SampledFlowTag tag;
+        if (p->PeekPacketTag(tag) && tag.Matches(h))
+        {
+            m_flowMonitor->ReportLastRx(this, tag.m_flowId, tag.m_packetId, tag.m_size);
+        }
+    }
+
+    void Drop(const Ipv4Header& h,
+              Ptr<const Packet> p,
+              Ipv4L3Protocol::DropReason reason,
+              Ptr<Ipv4>,
+              uint32_t)
+    {
+        SampledFlowTag tag;
+        if (!p->PeekPacketTag(tag) || !tag.Matches(h))
+        {
+            return;
+        }
+        uint32_t code = Ipv4FlowProbe::DROP_INVALID_REASON;
+        switch (reason)
+        {
+        case Ipv4L3Protocol::DROP_TTL_EXPIRED:
+            code = Ipv4FlowProbe::DROP_TTL_EXPIRE;
+            break;
+        case Ipv4L3Protocol::DROP_NO_ROUTE:
+            code = Ipv4FlowProbe::DROP_NO_ROUTE;
+            break;
+        case Ipv4L3Protocol::DROP_BAD_CHECKSUM:
+            code = Ipv4FlowProbe::DROP_BAD_CHECKSUM;
+            break;
+        case Ipv4L3Protocol::DROP_INTERFACE_DOWN:
+            code = Ipv4FlowProbe::DROP_INTERFACE_DOWN;
+            break;
+        case Ipv4L3Protocol::DROP_ROUTE_ERROR:
+            code = Ipv4FlowProbe::DROP_ROUTE_ERROR;
+            break;
+        case Ipv4L3Protocol::DROP_FRAGMENT_TIMEOUT:
+            code = Ipv4FlowProbe::DROP_FRAGMENT_TIMEOUT;
+            break;
+        default:
+            break;
+        }
+        m_flowMonitor->ReportDrop(this, tag.m_flowId, tag.m_packetId, tag.m_size, code);
+    }
+
+    Ptr<Ipv4FlowClassifier> m_classifier;
+    std::shared_ptr<const std::unordered_set<uint32_t>> m_sampled; // compartilhado entre as probes
+};
+
+// ---------- desenho da amostra e estimador ----------
+class FlowSample
+{
+  public:
+    // estrato = setor x anel (ringWidth m de largura, o último anel é aberto)
+    FlowSample(const NodeContainer& ueNodes,
+               const Ipv4InterfaceContainer& ueIfaces,
+               std::function<uint32_t(uint32_t ue)> sectorOf,
+               std::function<double(uint32_t ue)> distanceOf,
+               double ringWidth,
+               uint32_t rings)
+        : m_ueNodes(ueNodes)
+    {
+        NS_ABORT_MSG_IF(rings == 0 || ringWidth <= 0, "FlowSample: anéis inválidos");
+        m_stratum.resize(ueNodes.GetN());
+        for (uint32_t i = 0; i < ueNodes.GetN(); i++)
+        {
+            uint32_t ring = std::min<uint32_t>(rings - 1, static_cast<uint32_t>(distanceOf(i) / ringWidth));
+            m_stratum[i] = sectorOf(i) * rings + ring;
+            m_members[m_stratum[i]].push_back(i);
+            m_address.push_back(ueIfaces.GetAddress(i));
+        }
+    }
+
+    // sorteia max(1, round(fraction * N_h)) UEs de cada estrato
+    void Draw(double fraction, Ptr<UniformRandomVariable> rng)
+    {
+        NS_ABORT_MSG_IF(fraction <= 0 || fraction > 1, "FlowSample: fração deve estar em (0, 1]");
+        m_selected.clear();
+        auto addresses = std::make_shared<std::unordered_set<uint32_t>>();
+        for (auto& kv : m_members)
+        {
+            std::vector<uint32_t> v = kv.second;
+            uint32_t m = std::max<uint32_t>(1, static_cast<uint32_t>(std::lround(fraction * v.size())));
+            for (uint32_t k = 0; k < m; k++)
+            {
+                uint32_t j = k + rng->GetInteger(0, v.size() - 1 - k);
+                std::swap(v[k], v[j]);
+                m_selected.push_back(v[k]);
+            }
+        }
+        std::sort(m_selected.begin(), m_selected.end());
+        for (uint32_t i : m_selected)
+        {
+            addresses->insert(m_address[i].Get());
+        }
+        m_addresses = addresses;
+        std::cout << "[SAMPLE] " << m_selected.size() << "/" << m_ueNodes.GetN() << " UEs amostrados em "
+                  << m_members.size() << " estratos (setor x anel)" << std::endl;
+    }
+
+    uint32_t GetSampleSize() const
+    {
+        return m_selected.size();
+    }
+
+    // probes no nó de origem do tráfego (PGW) e nos UEs amostrados
+    Ptr<FlowMonitor> Install(FlowMonitorHelper& fm, Ptr<Node> core)
+    {
+        NS_ABORT_MSG_IF(!m_addresses, "FlowSample: Draw() antes de Install()");
+        Ptr<FlowMonitor> monitor = fm.GetMonitor();
+        Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(fm.GetClassifier());
+        Create<SampledIpv4FlowProbe>(monitor, classifier, core, m_addresses);
+        for (uint32_t i : m_selected)
+        {
+            Create<SampledIpv4FlowProbe>(monitor, classifier, m_ueNodes.Get(i), m_addresses);
+        }
+        return monitor;
+    }
+
+    // KPIs da rede inteira extrapolados da amostra, com IC de 95%
+    void Report(Ptr<FlowMonitor> monitor,
+                Ptr<Ipv4FlowClassifier> classifier,
+                Time duration,
+                const std::string& file) const
+    {
+        monitor->CheckForLostPackets();
+        std::unordered_map<uint32_t, uint32_t> ueOf;
+        for (uint32_t i : m_selected)
+        {
+            ueOf[m_address[i].Get()] = i;
+        }
+        // por UE amostrado: bits recebidos, pacotes tx/rx e soma dos atrasos
+        std::map<uint32_t, Totals> per;
+        for (uint32_t i : m_selected)
+        {
+            per[i] = Totals();
+        }
+        for (const auto& kv : monitor->GetFlowStats())
+        {
+            Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(kv.first);
+            auto it = ueOf.find(t.destinationAddress.Get());
+            if (it == ueOf.end())
+            {
+                it = ueOf.find(t.sourceAddress.Get());
+            }
+            if (it == ueOf.end())
+            {
+                continue;
+            }
+            Totals& u = per[it->second];
+            u.rxBits += 8.0 * kv.second.rxBytes;
+            u.txPackets += kv.second.txPackets;
+            u.rxPackets += kv.second.rxPackets;
+            u.delayS += kv.second.delaySum.GetSeconds();
+        }
+
+        const double secs = duration.GetSeconds();
+        Estimate thr = Total(per, [&](const Totals& u) { return u.rxBits / secs / 1e6; });
+        Estimate delay = Ratio(per,
+                               [](const Totals& u) { return u.delayS * 1e3; },
+                               [](const Totals& u) { return u.rxPackets; });
+        Estimate loss = Ratio(per,
+                              [](const Totals& u) { return u.txPackets - std::min(u.rxPackets, u.txPackets); },
+                              [](const Totals& u) { return u.txPackets; });
+        const double n = m_ueNodes.GetN();
+        Estimate perUe{thr.value / n, thr.variance / (n * n)};
+        Estimate lossPct{100.0 * loss.value, 1e4 * loss.variance};
+
+        std::ofstream out(file);
+        out << "kpi,estimate,ci95_low,ci95_high,rel_half_width,sample_ues,population_ues,strata\n";
+        auto row = [&](const std::string& name, const Estimate& e, const std::string& unit) {
+            double hw = 1.96 * std::sqrt(e.variance);
+            out << name << "," << e.value << "," << e.value - hw << "," << e.value + hw << ","
+                << (e.value != 0 ? hw / std::abs(e.value) : 0.0) << "," << m_selected.size() << ","
+                << m_ueNodes.GetN() << "," << m_members.size() << "\n";
+            std::cout << "[SAMPLE] " << name << ": " << e.value << " " << unit << " (IC95% ±" << hw << ")"
+                      << std::endl;
+        };
+        row("throughput_total_mbps", thr, "Mb/s");
+        row("throughput_per_ue_mbps", perUe, "Mb/s");
+        row("delay_mean_ms", delay, "ms");
+        row("loss_pct", lossPct, "%");
+        std::cout << "[SAMPLE] extrapolado de " << m_selected.size() << "/" << m_ueNodes.GetN()
+                  << " UEs, " << monitor->GetFlowStats().size() << " fluxos monitorados -> " << file
+                  << std::endl;
+    }
+
+  private:
+    struct Totals
+    {
+        double rxBits = 0;
+        double txPackets = 0;
+        double rxPackets = 0;
+        double delayS = 0;
+    };
+
+    struct Estimate
+    {
+        double value;
+        double variance;
+    };
+
+    // total estratificado de f(u) e sua variância
+    template <typename F>
+    Estimate Total(const std::map<uint32_t, Totals>& per, F f) const
+    {
+        std::map<uint32_t, std::vector<double>> ys;
+        for (const auto& kv : per)
+        {
+            ys[m_stratum[kv.first]].push_back(f(kv.second));
+        }
+        // variância agrupada, para estratos com um só UE amostrado
+        double pooledSs = 0;
+        double pooledDf = 0;
+        for (const auto& kv : ys)
+        {
+            if (kv.second.size() >= 2)
+            {
+                pooledSs += Variance(kv.second) * (kv.second.size() - 1);
+                pooledDf += kv.second.size() - 1;
+            }
+        }
+        double pooled = pooledDf > 0 ? pooledSs / pooledDf : 0.0;
+
+        Estimate e{0, 0};
+        for (const auto& kv : ys)
+        {
+            double nh = m_members.at(kv.first).size();
+            double mh = kv.second.size();
+            double mean = 0;
+            for (double y : kv.second)
+            {
+                mean += y / mh;
+            }
+            double s2 = mh >= 2 ? Variance(kv.second) : pooled;
+            e.value += nh * mean;
+            e.variance += nh * nh * (1.0 - mh / nh) * s2 / mh;
+        }
+        return e;
+    }
+
+    // razão Y/X (linearização: resíduo y - R x)
+    template <typename FY, typename FX>
+    Estimate Ratio(const std::map<uint32_t, Totals>& per, FY fy, FX fx) const
+    {
+        Estimate y = Total(per, fy);
+        Estimate x = Total(per, fx);
+        if (x.value <= 0)
+        {
+            return {0, 0};
+        }
+        double r = y.value / x.value;
+        Estimate res = Total(per, [&](const Totals& u) { return fy(u) - r * fx(u); });
+        return {r, res.variance / (x.value * x.value)};
+    }
+
+    static double Variance(const std::vector<double>& v)
+    {
+        double mean = 0;
+        for (double y : v)
+        {
+            mean += y / v.size();
+        }
+        double ss = 0;
+        for (double y : v)
+        {
+            ss += (y - mean) * (y - mean);
+        }
+        return ss / (v.size() - 1);
+    }
+
+    NodeContainer m_ueNodes;
+    std::vector<uint32_t> m_stratum;
+    std::vector<Ipv4Address> m_address;
+    std::map<uint32_t, std::vector<uint32_t>> m_members;
+    std::vector<uint32_t> m_selected;
+    std::shared_ptr<const std::unordered_set<uint32_t>> m_addresses;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(SampledFlowTag);
+NS_OBJECT_ENSURE_REGISTERED(SampledIpv4FlowProbe);
+
+} // namespace ns3
+
+#endif // URBANO_FLOW_SAMPLING_H
@@ -0,0 +1,259 @@
+// urbano-interference-pruning.h
+// Poda de interferência no canal espectral por potência recebida estimada.
+//  O SpectrumChannel entrega cada transmissão a todos os PHYs do canal: perda
+//  espectral, evento StartRx e soma na interferência de cada UE, mesmo de
+//  setores a quilômetros, 40+ dB abaixo do ruído. ReceivedPowerTransmitFilter
+//  (SpectrumTransmitFilter, consultado pelo canal antes de propagar cada par
+//  tx->rx) descarta os pares com
+//     P_tx - perda + MarginDb < ruído + ThresholdDb
+//   - P_tx: integral da PSD da transmissão (calculada uma vez por sinal);
+//   - perda: modelo de perda do canal (SetPropagationLossModel), sem ganhos de
+//     antena/beamforming (MarginDb cobre ganho máximo e desvanecimento);
+//   - ruído: kTB na banda do sinal + NoiseFigure.
+//  Conjuntos de candidatos incrementais: para cada nó móvel guarda-se a perda
+//  até cada nó estático (setor) já avaliado; quando o móvel se afasta mais que
+//  ReevaluateDistance do ponto da última avaliação, só as perdas dele são
+//  descartadas e recalculadas sob demanda. Pares estático-estático e
+//  móvel-móvel nunca são podados. Report() mostra a fração de sinais não
+//  entregues (eventos StartRx e cálculos de interferência evitados).
+//  A perda estimada é a cadeia inteira do canal (com o mapa de sombreamento,
+//  se houver): instalar depois de AddPropagationLossModel.
+//  Estimativa geométrica no lte-urbano (LogDistance 40.7 + 37·log d, limiar
+//  -20 dB, UEs uniformes na área da grade do urbano_bench.py, sem
+//  sombreamento), pares podados a 48 / 192 setores:
+//     folga   DL 46 dBm/100 RBs   UL 23 dBm/6 RBs   UL 23 dBm/25 RBs
+//     10 dB     0.0% / 13.5%       13.5% / 62.6%     42.1% / 80.3%
+//      3 dB     3.5% / 47.1%       45.6% / 81.9%     70.0% / 91.0%
+//  Com folga 10 o DL só é podado além de 3.6 km, fora da grade de 48 setores.
+//  A folga padrão do lte-urbano é 3 dB: lá a antena parabólica tem ganho
+//  máximo 0 dB e não há desvanecimento, então a perda estimada nunca é maior
+//  que a real; a folga só limita a soma dos sinais podados. Nessa estimativa
+//  (todos os setores do DL transmitindo em todos os RBs) a soma podada fica
+//  12 dB abaixo do ruído a 48 setores e 6 dB a 192, e o SINR do pior UE muda
+//  no máximo 0.08 / 0.25 dB, bem abaixo de um degrau de CQI.
+
+#ifndef URBANO_INTERFERENCE_PRUNING_H
+#define URBANO_INTERFERENCE_PRUNING_H
+
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/spectrum-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+class ReceivedPowerTransmitFilter : public SpectrumTransmitFilter
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::ReceivedPowerTransmitFilter")
+                .SetParent<SpectrumTransmitFilter>()
+                .SetGroupName("Spectrum")
+                .AddConstructor<ReceivedPowerTransmitFilter>()
+                .AddAttribute("ThresholdDb",
+                              "Potência recebida mínima relativa ao ruído (dB) para entregar o sinal",
+                              DoubleValue(-20.0),
+                              MakeDoubleAccessor(&ReceivedPowerTransmitFilter::m_thresholdDb),
+                              MakeDoubleChecker<double>())
+                .AddAttribute("MarginDb",
+                              "Folga (dB) para ganhos de antena/beamforming e desvanecimento",
+                              DoubleValue(10.0),
+                              MakeDoubleAccessor(&ReceivedPowerTransmitFilter::m_marginDb),
+                              MakeDoubleChecker<double>(0.0))
+                .AddAttribute("NoiseFigure",
+                              "Figura de ruído (dB) do receptor usada na estimativa",
+                              DoubleValue(5.0),
+                              MakeDoubleAccessor(&ReceivedPowerTransmitFilter::m_noiseFigureDb),
+                              MakeDoubleChecker<double>(0.0))
+                .AddAttribute("ReevaluateDistance",
+                              "Deslocamento (m) do nó móvel que invalida suas perdas avaliadas",
+                              DoubleValue(10.0),
+                              MakeDoubleAccessor(&ReceivedPowerTransmitFilter::m_reevaluateDistance),
+                              MakeDoubleChecker<double>(0.0));
+        return tid;
+    }
+
+    ReceivedPowerTransmitFilter()
+        : m_lastPowerDbm(0),
+          m_lastNoiseDbm(0),
+          m_passed(0),
+          m_dropped(0),
+          m_evaluated(0),
+          m_reevaluations(0)
+    {
+    }
+
+    void SetPropagationLossModel(Ptr<PropagationLossModel> loss)
+    {
+        m_loss = loss;
+    }
+
+    uint64_t GetPassed() const
+    {
+        return m_passed;
+    }
+
+    uint64_t GetDropped() const
+    {
+        return m_dropped;
+    }
+
+    void Report(const std::string& name) const
+    {
+        uint64_t total = m_passed + m_dropped;
+        std::cout << "[PRUNE] " << name << ": " << m_dropped << " de " << total << " sinais tx->rx não entregues ("
+                  << (total ? 100.0 * m_dropped / total : 0.0) << "%), " << m_evaluated
+                  << " perdas avaliadas, " << m_reevaluations << " reavaliações por movimento" << std::endl;
+    }
+
+  private:
+    struct Candidates
+    {
+        Vector at;
+        std::vector<float> lossDb; // por nó estático; NaN = não avaliado
+    };
+
+    bool DoFilter(Ptr<const SpectrumSignalParameters> params, Ptr<const SpectrumPhy> receiverPhy) override
+    {
+        if (!m_loss || !params->txPhy)
+        {
+            return false;
+        }
+        Ptr<MobilityModel> tx = params->txPhy->GetMobility();
+        Ptr<MobilityModel> rx = receiverPhy->GetMobility();
+        if (!tx || !rx)
+        {
+            return false;
+        }
+        bool sTx = IsStatic(tx);
+        bool sRx = IsStatic(rx);
+        if (sTx == sRx)
+        {
+            return false;
+        }
+        double loss = LossDb(sTx ? tx : rx, sTx ? rx : tx, tx, rx);
+        if (params != m_lastParams)
+        {
+            // potência e ruído uma vez por sinal (o canal consulta todos os rx em seguida;
+            // a referência mantida impede que outro sinal reuse o endereço)
+            m_lastParams = params;
+            double watts = Integral(*params->psd);
+            m_lastPowerDbm = 10 * std::log10(std::max(watts, 1e-30)) + 30;
+            double bw = 0;
+            for (auto b = params->psd->ConstBandsBegin(); b != params->psd->ConstBandsEnd(); ++b)
+            {
+                bw += b->fh - b->fl;
+            }
+            m_lastNoiseDbm = -174.0 + 10 * std::log10(std::max(bw, 1.0)) + m_noiseFigureDb;
+        }
+        if (m_lastPowerDbm - loss + m_marginDb < m_lastNoiseDbm + m_thresholdDb)
+        {
+            m_dropped++;
+            return true;
+        }
+        m_passed++;
+        return false;
+    }
+
+    // perda estimada estático <-> móvel, avaliada uma vez por posição do móvel
+    double LossDb(Ptr<MobilityModel> fixed, Ptr<MobilityModel> mobile, Ptr<MobilityModel> tx, Ptr<MobilityModel> rx)
+    {
+        uint32_t s;
+        auto it = m_staticIndex.find(PeekPointer(fixed));
+        if (it == m_staticIndex.end())
+        {
+            s = m_staticIndex.size();
+            m_staticIndex[PeekPointer(fixed)] = s;
+        }
+        else
+        {
+            s = it->second;
+        }
+
+        Vector p = mobile->GetPosition();
+        auto cIt = m_candidates.find(PeekPointer(mobile));
+        if (cIt == m_candidates.end())
+        {
+            cIt = m_candidates.emplace(PeekPointer(mobile), Candidates{p, {}}).first;
+        }
+        Candidates& c = cIt->second;
+        double dx = p.x - c.at.x;
+        double dy = p.y - c.at.y;
+        if (dx * dx + dy * dy > m_reevaluateDistance * m_reevaluateDistance)
+        {
+            std::fill(c.lossDb.begin(), c.lossDb.end(), std::numeric_limits<float>::quiet_NaN());
+            c.at = p;
+            m_reevaluations++;
+        }
+        if (c.lossDb.size() <= s)
+        {
+            c.lossDb.resize(m_staticIndex.size(), std::numeric_limits<float>::quiet_NaN());
+        }
+        if (std::isnan(c.lossDb[s]))
+        {
+            c.lossDb[s] = -m_loss->CalcRxPower(0.0, tx, rx);
+            m_evaluated++;
+        }
+        return c.lossDb[s];
+    }
+
+    static bool IsStatic(Ptr<MobilityModel> m)
+    {
+        return DynamicCast<ConstantPositionMobilityModel>(m) != nullptr;
+    }
+
+    void DoDispose() override
+    {
+        m_loss = nullptr;
+        m_lastParams = nullptr;
+        m_candidates.clear();
+        m_staticIndex.clear();
+        SpectrumTransmitFilter::DoDispose();
+    }
+
+    double m_thresholdDb;
+    double m_marginDb;
+    double m_noiseFigureDb;
+    double m_reevaluateDistance;
+    Ptr<PropagationLossModel> m_loss;
+
+    std::unordered_map<const MobilityModel*, uint32_t> m_staticIndex;
+    std::unordered_map<const MobilityModel*, Candidates> m_candidates;
+    Ptr<const SpectrumSignalParameters> m_lastParams;
+    double m_lastPowerDbm;
+    double m_lastNoiseDbm;
+    uint64_t m_passed;
+    uint64_t m_dropped;
+    uint64_t m_evaluated;
+    uint64_t m_reevaluations;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(ReceivedPowerTransmitFilter);
+
+// instala o filtro num canal, estimando a perda com o modelo do próprio canal
+inline Ptr<ReceivedPowerTransmitFilter>
+InstallInterferencePruning(Ptr<SpectrumChannel> ch, double thresholdDb, double marginDb, double reevaluateM)
+{
+    Ptr<ReceivedPowerTransmitFilter> f = CreateObjectWithAttributes<ReceivedPowerTransmitFilter>(
+        "ThresholdDb", DoubleValue(thresholdDb),
+        "MarginDb", DoubleValue(marginDb),
+        "ReevaluateDistance", DoubleValue(reevaluateM));
+    f->SetPropagationLossModel(ch->GetPropagationLossModel());
+    ch->AddSpectrumTransmitFilter(f);
+    return f;
+}
+
+} // namespace ns3
+
+#endif // URBANO_INTERFERENCE_PRUNING_H
@@ -0,0 +1,271 @@
+// urbano-kpi-recorder.h
+// Registro contínuo de KPIs em janelas de tempo simulado (substitui o dump XML
+// do FlowMonitor no fim da rodada).
+//  A cada janela (ex.: 100 ms) lê GetFlowStats(), calcula o delta de cada fluxo
+//  desde a janela anterior (throughput, atraso, jitter, perda) e soma por setor
+//  (cellId de serviço do UE do fluxo: destino no DL, origem no UL). As linhas
+//  vão direto para um CSV append-only, descarregado ao fim de cada janela. A
+//  memória fica limitada a um snapshot por fluxo, independentemente da duração,
+//  e o CSV pode ser plotado durante a rodada.
+//
+//  Colunas: t_ms,kind,id,tx_pkts,rx_pkts,thr_kbit_s,delay_ms,jitter_ms,loss_pct
+//   kind = F (id = FlowId) ou S (id = cellId do setor)
+//   loss_pct é (tx - rx) / tx da janela, então inclui pacotes ainda em trânsito.
+
+#ifndef URBANO_KPI_RECORDER_H
+#define URBANO_KPI_RECORDER_H
+
+#include "ns3/core-module.h"
+#include "ns3/flow-monitor-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+// ---------- linha de KPI de uma janela ----------
+struct KpiRow
+{
+    double tMs;             // fim da janela (ms de tempo simulado)
+    double windowS;         // duração efetiva da janela (s)
+    char kind;              // 'F' = fluxo, 'S' = setor
+    uint32_t id;            // FlowId ou cellId
+    uint64_t rxBytes;
+    uint32_t txPackets;
+    uint32_t rxPackets;
+    double delaySumS;
+    double jitterSumS;
+    uint32_t jitterSamples;
+};
+
+class KpiWindowRecorder
+{
+  public:
+    // devolve o cellId (setor) do UE do fluxo; 0 = desconhecido
+    using SectorResolver = std::function<uint16_t(const Ipv4FlowClassifier::FiveTuple&)>;
+    // chamado ao fim de cada janela com as linhas agregadas por setor
+    using WindowCallback = std::function<void(const std::vector<KpiRow>&)>;
+
+    KpiWindowRecorder(Ptr<FlowMonitor> monitor,
+                      Ptr<Ipv4FlowClassifier> classifier,
+                      const std::string& fileName,
+                      Time window,
+                      bool perFlow = true)
+        : m_monitor(monitor),
+          m_classifier(classifier),
+          m_window(window),
+          m_perFlow(perFlow)
+    {
+        m_out.open(fileName, std::ios::out | std::ios::trunc);
+        m_out << "t_ms,kind,id,tx_pkts,rx_pkts,thr_kbit_s,delay_ms,jitter_ms,loss_pct\n";
+        m_out.flush();
+    }
+
+    ~KpiWindowRecorder()
+    {
+        m_out.flush();
+    }
+
+    void SetSectorResolver(SectorResolver resolver)
+    {
+        m_resolver = resolver;
+    }
+
+    void SetWindowCallback(WindowCallback cb)
+    {
+        m_windowCb = cb;
+    }
+
+    // primeira amostra (linha de base) em 'at'; depois uma a cada janela
+    void Start(Time at)
+    {
+        m_lastSample = at;
+        m_event = Simulator::Schedule(at - Simulator::Now(), &KpiWindowRecorder::Sample, this, true);
+    }
+
+    // fecha a última janela (parcial); chamar após Simulator::Run()
+    void Finish()
+    {
+        m_event.Cancel();
+        if (Simulator::Now() > m_lastSample)
+        {
+            Sample(false);
+        }
+    }
+
+  private:
+    struct FlowSnapshot
+    {
+        uint64_t rxBytes = 0;
+        uint32_t txPackets = 0;
+        uint32_t rxPackets = 0;
+        double delaySumS = 0.0;
+        double jitterSumS = 0.0;
+    };
+
+    void Sample(bool reschedule)
+    {
+        const double windowS = (Simulator::Now() - m_lastSample).GetSeconds();
+        const double tMs = Simulator::Now().GetSeconds() * 1000.0;
+        m_lastSample = Simulator::Now();
+
+        std::map<uint16_t, KpiRow> sectors;
+        const FlowMonitor::FlowStatsContainer& stats = m_monitor->GetFlowStats();
+        for (auto it = stats.begin(); it != stats.end(); ++it)
+        {
+            const FlowMonitor::FlowStats& s = it->second;
+            if (it->first >= m_prev.size())
+            {
+                m_prev.resize(it->first + 1);
+            }
+            FlowSnapshot& prev = m_prev[it->first];
+
+            KpiRow row;
+            row.tMs = tMs;
+            row.windowS = windowS;
+            row.kind = 'F';
+            row.id = it->first;
+            row.rxBytes = s.rxBytes - prev.rxBytes;
+            row.txPackets = s.txPackets - prev.txPackets;
+            row.rxPackets = s.rxPackets - prev.rxPackets;
+            row.delaySumS = s.delaySum.GetSeconds() - prev.delaySumS;
+            row.jitterSumS = s.jitterSum.GetSeconds() - prev.jitterSumS;
+            // o FlowMonitor só soma jitter a partir do 2º pacote recebido
+            row.jitterSamples = (s.rxPackets > 1 ? s.rxPackets - 1 : 0) -
+                                (prev.rxPackets > 1 ? prev.rxPackets - 1 : 0);
+
+            prev.rxBytes = s.rxBytes;
+            prev.txPackets = s.txPackets;
+            prev.rxPackets = s.rxPackets;
+            prev.delaySumS = s.delaySum.GetSeconds();
+            prev.jitterSumS = s.jitterSum.GetSeconds();
+
+            if (row.txPackets == 0 && row.rxPackets == 0)
+            {
+                continue;
+            }
+            if (m_perFlow)
+            {
+                Write(row);
+            }
+            if (m_resolver)
+            {
+                uint16_t cellId = m_resolver(m_classifier->FindFlow(it->first));
+                KpiRow& agg = sectors[cellId];
+                if (agg.kind != 'S')
+                {
+                    agg = KpiRow{tMs, windowS, 'S', cellId, 0, 0, 0, 0.0, 0.0, 0};
+                }
+                agg.rxBytes += row.rxBytes;
+                agg.txPackets += row.txPackets;
+                agg.rxPackets += row.rxPackets;
+                agg.delaySumS += row.delaySumS;
+                agg.jitterSumS += row.jitterSumS;
+                agg.jitterSamples += row.jitterSamples;
+            }
+        }
+
+        std::vector<KpiRow> sectorRows;
+        sectorRows.reserve(sectors.size());
+        for (auto& kv : sectors)
+        {
+            Write(kv.second);
+            sectorRows.push_back(kv.second);
+        }
+        m_out.flush();
+
+        if (m_windowCb && windowS > 0)
+        {
+            m_windowCb(sectorRows);
+        }
+        if (reschedule)
+        {
+            m_event = Simulator::Schedule(m_window, &KpiWindowRecorder::Sample, this, true);
+        }
+    }
+
+    void Write(const KpiRow& r)
+    {
+        double thr = r.windowS > 0 ? r.rxBytes * 8.0 / r.windowS / 1000.0 : 0.0;
+        double delay = r.rxPackets > 0 ? r.delaySumS / r.rxPackets * 1000.0 : 0.0;
+        double jitter = r.jitterSamples > 0 ? r.jitterSumS / r.jitterSamples * 1000.0 : 0.0;
+        double loss = (r.txPackets > r.rxPackets)
+                          ? (r.txPackets - r.rxPackets) * 100.0 / r.txPackets
+                          : 0.0;
+        m_out << r.tMs << ',' << r.kind << ',' << r.id << ',' << r.txPackets << ','
+              << r.rxPackets << ',' << thr << ',' << delay << ',' << jitter << ',' << loss
+              << '\n';
+    }
+
+    Ptr<FlowMonitor> m_monitor;
+    Ptr<Ipv4FlowClassifier> m_classifier;
+    Time m_window;
+    bool m_perFlow;
+    SectorResolver m_resolver;
+    WindowCallback m_windowCb;
+
+    std::vector<FlowSnapshot> m_prev; // indexado por FlowId
+    std::ofstream m_out;
+    Time m_lastSample;
+    EventId m_event;
+};
+
+// ---------- FlowMonitor enxuto para o registro em janelas ----------
+// O registro só lê contadores e somas de FlowStats. Sem XML nem histogramas no
+// fim da rodada, os histogramas de cada fluxo (e de cada sonda) ficam com um
+// único bin e as sondas só nas pontas do tráfego (núcleo + UEs), sem eNB/SGW
+// no caminho: a memória por fluxo fica constante, em vez de crescer com a
+// faixa de atraso/jitter/tamanho observada e com o número de saltos.
+// Chamar antes de qualquer GetMonitor()/Install() do helper.
+inline void
+NarrowFlowMonitor(FlowMonitorHelper& fm)
+{
+    const double oneBin = 1e9;
+    fm.SetMonitorAttribute("DelayBinWidth", DoubleValue(oneBin));
+    fm.SetMonitorAttribute("JitterBinWidth", DoubleValue(oneBin));
+    fm.SetMonitorAttribute("PacketSizeBinWidth", DoubleValue(oneBin));
+    fm.SetMonitorAttribute("FlowInterruptionsBinWidth", DoubleValue(oneBin));
+}
+
+inline Ptr<FlowMonitor>
+InstallEndpointFlowMonitor(FlowMonitorHelper& fm, Ptr<Node> core, const NodeContainer& ues)
+{
+    NodeContainer nodes;
+    nodes.Add(core);
+    nodes.Add(ues);
+    return fm.Install(nodes);
+}
+
+// ---------- resolve fluxo -> UE -> cellId de serviço ----------
+// o UE é o destino (DL) ou, se o destino não é um UE, a origem (UL);
+// cellIdOf recebe o NetDevice do UE (LteUeNetDevice / NrUeNetDevice)
+inline KpiWindowRecorder::SectorResolver
+MakeCellIdResolver(const Ipv4InterfaceContainer& ueIfaces,
+                   const NetDeviceContainer& ueDevs,
+                   std::function<uint16_t(Ptr<NetDevice>)> cellIdOf)
+{
+    auto index = std::make_shared<std::map<Ipv4Address, Ptr<NetDevice>>>();
+    for (uint32_t i = 0; i < ueIfaces.GetN(); i++)
+    {
+        (*index)[ueIfaces.GetAddress(i)] = ueDevs.Get(i);
+    }
+    return [index, cellIdOf](const Ipv4FlowClassifier::FiveTuple& t) -> uint16_t {
+        auto it = index->find(t.destinationAddress);
+        if (it == index->end())
+        {
+            it = index->find(t.sourceAddress);
+        }
+        return it == index->end() ? 0 : cellIdOf(it->second);
+    };
+}
+
+} // namespace ns3
+
+#endif // URBANO_KPI_RECORDER_H
@@ -0,0 +1,241 @@
+// urbano-mpi-partition.h
+// Execução MPI dos cenários urbanos, particionada por cluster de sites.
+//  O canal de espectro do LTE/NR é um objeto único compartilhado por todos os
+//  setores e o ns-3 distribuído só aceita enlaces ponto-a-ponto como fronteira
+//  entre ranks, então não dá para cortar a rede de rádio ao meio. Cada rank
+//  simula um cluster de sites da grade hexagonal como uma ilha independente:
+//  seus setores, os UEs da região do cluster e um EPC próprio (o backhaul fica
+//  inteiro dentro do rank; nenhum pacote cruza ranks, então não há lookahead a
+//  respeitar e cada rank roda o simulador serial). No fim, os KPIs são somados
+//  entre ranks com MPI_Reduce.
+//  Partição: bisseção recursiva de coordenadas (RCB) sobre os centros dos sites;
+//  os cortes ficam no meio entre sites vizinhos, e os retângulos resultantes
+//  ladrilham a área dos UEs. Cada rank recebe UEs proporcionais à área do seu
+//  retângulo (maior resto, somando ueCount) e a mobilidade é limitada a ele.
+//  Limitação: interferência e handover entre clusters vizinhos são ignorados.
+//  Sem NS3_MPI (build sem --enable-mpi) tudo vira rank 0 de 1.
+
+#ifndef URBANO_MPI_PARTITION_H
+#define URBANO_MPI_PARTITION_H
+
+#include "ns3/core-module.h"
+#include "ns3/flow-monitor-module.h"
+#include "ns3/mobility-module.h"
+
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+struct SitePartition
+{
+    std::vector<uint32_t> sites; // índices em MakeHexGrid
+    Rectangle region;            // área dos UEs deste rank
+    uint32_t ueCount = 0;
+};
+
+class UrbanoMpi
+{
+  public:
+    static void Init(int* argc, char*** argv)
+    {
+#ifdef NS3_MPI
+        MpiInterface::Enable(argc, argv);
+#endif
+    }
+
+    static void Finalize()
+    {
+#ifdef NS3_MPI
+        MpiInterface::Disable();
+#endif
+    }
+
+    static uint32_t Rank()
+    {
+#ifdef NS3_MPI
+        return MpiInterface::IsEnabled() ? MpiInterface::GetSystemId() : 0;
+#else
+        return 0;
+#endif
+    }
+
+    static uint32_t Size()
+    {
+#ifdef NS3_MPI
+        return MpiInterface::IsEnabled() ? MpiInterface::GetSize() : 1;
+#else
+        return 1;
+#endif
+    }
+
+    // somas/máximos em rank 0 (os outros ranks recebem o próprio valor)
+    static std::vector<double> Sum(std::vector<double> v)
+    {
+        return Reduce(v, true);
+    }
+
+    static std::vector<double> Max(std::vector<double> v)
+    {
+        return Reduce(v, false);
+    }
+
+    // "x.csv" -> "x-rank3.csv" quando há mais de um rank
+    static std::string FileName(const std::string& name)
+    {
+        if (Size() == 1)
+        {
+            return name;
+        }
+        std::string suffix = "-rank" + std::to_string(Rank());
+        size_t dot = name.find_last_of('.');
+        if (dot == std::string::npos || name.find('/', dot) != std::string::npos)
+        {
+            return name + suffix;
+        }
+        return name.substr(0, dot) + suffix + name.substr(dot);
+    }
+
+  private:
+    static std::vector<double> Reduce(std::vector<double> v, bool sum)
+    {
+#ifdef NS3_MPI
+        if (MpiInterface::IsEnabled() && MpiInterface::GetSize() > 1)
+        {
+            std::vector<double> out(v.size(), 0.0);
+            MPI_Reduce(v.data(),
+                       out.data(),
+                       v.size(),
+                       MPI_DOUBLE,
+                       sum ? MPI_SUM : MPI_MAX,
+                       0,
+                       MpiInterface::GetCommunicator());
+            return Rank() == 0 ? out : v;
+        }
+#endif
+        return v;
+    }
+};
+
+// RCB: divide 'idx' (sites) dentro de 'r' em 'parts' retângulos
+inline void
+BisectSites(const std::vector<Vector>& centers,
+            std::vector<uint32_t> idx,
+            Rectangle r,
+            uint32_t parts,
+            std::vector<SitePartition>& out)
+{
+    if (parts == 1)
+    {
+        SitePartition p;
+        p.sites = idx;
+        p.region = r;
+        out.push_back(p);
+        return;
+    }
+    bool alongX = (r.xMax - r.xMin) >= (r.yMax - r.yMin);
+    auto coord = [&](uint32_t i) { return alongX ? centers[i].x : centers[i].y; };
+    std::sort(idx.begin(), idx.end(), [&](uint32_t a, uint32_t b) {
+        return coord(a) < coord(b) || (coord(a) == coord(b) && a < b);
+    });
+    uint32_t left = parts / 2;
+    size_t k = static_cast<size_t>(std::lround(idx.size() * double(left) / parts));
+    k = std::min(std::max<size_t>(k, left), idx.size() - (parts - left));
+    double cut = 0.5 * (coord(idx[k - 1]) + coord(idx[k]));
+
+    Rectangle a = r;
+    Rectangle b = r;
+    if (alongX)
+    {
+        a.xMax = b.xMin = cut;
+    }
+    else
+    {
+        a.yMax = b.yMin = cut;
+    }
+    BisectSites(centers, std::vector<uint32_t>(idx.begin(), idx.begin() + k), a, left, out);
+    BisectSites(centers, std::vector<uint32_t>(idx.begin() + k, idx.end()), b, parts - left, out);
+}
+
+// partição de todos os ranks (determinística; cada rank usa a sua)
+inline std::vector<SitePartition>
+PartitionSites(const std::vector<Vector>& centers, Rectangle area, uint32_t parts, uint32_t ueCount)
+{
+    NS_ABORT_MSG_IF(centers.size() < parts,
+                    "mais ranks (" << parts << ") que sites (" << centers.size() << ")");
+    std::vector<uint32_t> idx(centers.size());
+    std::iota(idx.begin(), idx.end(), 0);
+    std::vector<SitePartition> out;
+    BisectSites(centers, idx, area, parts, out);
+
+    // UEs proporcionais à área (maior resto)
+    const double total = (area.xMax - area.xMin) * (area.yMax - area.yMin);
+    std::vector<double> rest(parts);
+    uint32_t assigned = 0;
+    for (uint32_t p = 0; p < parts; p++)
+    {
+        const Rectangle& r = out[p].region;
+        double exact = ueCount * (r.xMax - r.xMin) * (r.yMax - r.yMin) / total;
+        out[p].ueCount = static_cast<uint32_t>(std::floor(exact));
+        rest[p] = exact - out[p].ueCount;
+        assigned += out[p].ueCount;
+    }
+    while (assigned < ueCount)
+    {
+        uint32_t p = std::max_element(rest.begin(), rest.end()) - rest.begin();
+        out[p].ueCount++;
+        rest[p] = -1.0;
+        assigned++;
+    }
+    return out;
+}
+
+// totais entre ranks (linha "[MPI] chave=valor" lida por urbano_mpi_scaling.py)
+inline void
+ReportMpiTotals(Ptr<FlowMonitor> monitor,
+                double setupWallS,
+                double runWallS,
+                uint32_t localSites,
+                uint32_t localUes,
+                double simTimeS)
+{
+    double tx = 0;
+    double rx = 0;
+    double rxBytes = 0;
+    double delayS = 0;
+    monitor->CheckForLostPackets();
+    for (const auto& kv : monitor->GetFlowStats())
+    {
+        tx += kv.second.txPackets;
+        rx += kv.second.rxPackets;
+        rxBytes += kv.second.rxBytes;
+        delayS += kv.second.delaySum.GetSeconds();
+    }
+    std::vector<double> sum = UrbanoMpi::Sum({tx, rx, rxBytes, delayS, double(localSites), double(localUes)});
+    std::vector<double> max = UrbanoMpi::Max({setupWallS, runWallS});
+    if (UrbanoMpi::Rank() != 0)
+    {
+        return;
+    }
+    std::cout << "[MPI] ranks=" << UrbanoMpi::Size() << " sites=" << sum[4] << " ues=" << sum[5]
+              << " setup_s=" << max[0] << " run_s=" << max[1] << " tx_pkts=" << sum[0]
+              << " rx_pkts=" << sum[1] << " thr_mbit_s=" << sum[2] * 8 / simTimeS / 1e6
+              << " delay_ms=" << (sum[1] > 0 ? 1e3 * sum[3] / sum[1] : 0.0)
+              << " loss_pct=" << (sum[0] > 0 ? 100.0 * (sum[0] - sum[1]) / sum[0] : 0.0)
+              << std::endl;
+}
+
+} // namespace ns3
+
+#endif // URBANO_MPI_PARTITION_H
@@ -0,0 +1,417 @@
+// urbano-multiflow-apps.h
+// Gerador de tráfego multi-fluxo no PGW + sink leve nos UEs.
+//  Antes cada UE tinha um OnOffApplication no PGW (um socket e um timer por
+//  fluxo) e um PacketSink; com 6300 UEs são 12 600 aplicações e ~1,3 M eventos
+//  por segundo simulado só de temporizador. Aqui um único MultiFlowUdpClient
+//  serve N destinos com um socket UDP e uma roda de temporização (timer wheel):
+//  cada fluxo guarda o instante exato do próximo envio e fica no slot
+//  correspondente da roda; um evento por slot ("Granularity") envia tudo o que
+//  venceu. Cada fluxo reproduz o OnOffApplication que substitui: começa
+//  desligado, alterna períodos sorteados de OnTime/OffTime (mesmos atributos e
+//  padrões do OnOff, 1 s/1 s constantes) e, ligado, envia CBR com
+//  tamanho*8/taxa entre pacotes, guardando a fração do intervalo já cumprida
+//  ao desligar (os "residual bits" do OnOff). A carga oferecida é a mesma;
+//  sem deriva porque os instantes são acumulados exatamente, e só a fase de
+//  cada pacote é arredondada para o slot. Para CBR contínuo:
+//  OnTime = Constant grande, OffTime = Constant 0.
+//  Grupos periódicos: fluxos com o mesmo período e tamanho (ex.: VoIP a cada
+//  20 ms) não passam pela roda; o grupo é dividido em period/Granularity fases
+//  e cada fase tem um único evento periódico que envia a todos os seus fluxos.
+//  LightUdpSink só conta bytes/pacotes (sem traces nem lista de endereços).
+
+#ifndef URBANO_MULTIFLOW_APPS_H
+#define URBANO_MULTIFLOW_APPS_H
+
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace ns3
+{
+
+// ---------- cliente UDP multi-fluxo com timer wheel ----------
+class MultiFlowUdpClient : public Application
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::MultiFlowUdpClient")
+                .SetParent<Application>()
+                .SetGroupName("Applications")
+                .AddConstructor<MultiFlowUdpClient>()
+                .AddAttribute("Granularity",
+                              "Duração de um slot da roda de temporização",
+                              TimeValue(MilliSeconds(1)),
+                              MakeTimeAccessor(&MultiFlowUdpClient::m_granularity),
+                              MakeTimeChecker(NanoSeconds(1)))
+                .AddAttribute("OnTime",
+                              "Duração dos períodos ligados de cada fluxo (como no OnOff)",
+                              StringValue("ns3::ConstantRandomVariable[Constant=1.0]"),
+                              MakePointerAccessor(&MultiFlowUdpClient::m_onTime),
+                              MakePointerChecker<RandomVariableStream>())
+                .AddAttribute("OffTime",
+                              "Duração dos períodos desligados de cada fluxo (como no OnOff)",
+                              StringValue("ns3::ConstantRandomVariable[Constant=1.0]"),
+                              MakePointerAccessor(&MultiFlowUdpClient::m_offTime),
+                              MakePointerChecker<RandomVariableStream>());
+        return tid;
+    }
+
+    MultiFlowUdpClient()
+        : m_cursor(0),
+          m_sent(0)
+    {
+    }
+
+    // CBR: um pacote de pktSize bytes a cada pktSize*8/rate
+    uint32_t AddFlow(const InetSocketAddress& dest, DataRate rate, uint32_t pktSize)
+    {
+        Flow f;
+        f.dest = dest;
+        f.size = pktSize;
+        f.interval = NanoSeconds(static_cast<int64_t>(pktSize * 8.0 * 1e9 / rate.GetBitRate()));
+        m_flows.push_back(f);
+        return m_flows.size() - 1;
+    }
+
+    // grupo de fluxos com período/tamanho comuns; destinos via AddToGroup
+    uint32_t AddPeriodicGroup(Time period, uint32_t pktSize)
+    {
+        Group g;
+        g.period = period;
+        g.size = pktSize;
+        m_groups.push_back(g);
+        return m_groups.size() - 1;
+    }
+
+    void AddToGroup(uint32_t group, const InetSocketAddress& dest)
+    {
+        m_groups[group].dests.push_back(dest);
+    }
+
+    uint32_t GetNFlows() const
+    {
+        uint32_t n = m_flows.size();
+        for (const auto& g : m_groups)
+        {
+            n += g.dests.size();
+        }
+        return n;
+    }
+
+    uint64_t GetSent() const
+    {
+        return m_sent;
+    }
+
+    int64_t AssignStreams(int64_t stream)
+    {
+        m_onTime->SetStream(stream);
+        m_offTime->SetStream(stream + 1);
+        return 2;
+    }
+
+  protected:
+    void DoDispose() override
+    {
+        m_socket = nullptr;
+        m_onTime = nullptr;
+        m_offTime = nullptr;
+        Application::DoDispose();
+    }
+
+  private:
+    struct Flow
+    {
+        InetSocketAddress dest = InetSocketAddress(Ipv4Address::GetAny(), 0);
+        uint32_t size = 0;
+        Time interval;
+        Time next;       // próximo envio (válido quando ligado)
+        bool on = false;
+        Time switchAt;   // próxima troca ligado/desligado
+        Time lastStart;  // início da contagem do intervalo corrente
+        Time earned;     // parte do intervalo cumprida em períodos ligados anteriores
+    };
+
+    struct Group
+    {
+        Time period;
+        uint32_t size = 0;
+        std::vector<InetSocketAddress> dests;
+        std::vector<EventId> events; // um por fase
+    };
+
+    void StartApplication() override
+    {
+        if (!m_socket)
+        {
+            m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+            m_socket->Bind();
+            m_socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+        }
+
+        // roda com slots suficientes para o maior intervalo (trocas on/off mais
+        // distantes que a roda só revisitam o fluxo uma vez por volta)
+        Time maxInterval = m_granularity;
+        for (const auto& f : m_flows)
+        {
+            maxInterval = std::max(maxInterval, f.interval);
+        }
+        m_wheel.assign(maxInterval.GetNanoSeconds() / m_granularity.GetNanoSeconds() + 2,
+                       std::vector<uint32_t>());
+        m_cursor = 0;
+        m_cursorTime = Simulator::Now();
+
+        for (uint32_t i = 0; i < m_flows.size(); i++)
+        {
+            // como o OnOff: começa com um período desligado
+            Flow& f = m_flows[i];
+            f.on = false;
+            f.earned = Time(0);
+            f.switchAt = m_cursorTime + Seconds(m_offTime->GetValue());
+            Insert(i);
+        }
+        if (!m_flows.empty())
+        {
+            m_tick = Simulator::Schedule(m_granularity, &MultiFlowUdpClient::Tick, this);
+        }
+
+        // fase k de um grupo: destinos k, k+P, k+2P...; desloca k*period/P
+        for (uint32_t gi = 0; gi < m_groups.size(); gi++)
+        {
+            Group& g = m_groups[gi];
+            uint32_t phases = std::max<int64_t>(
+                1,
+                std::min<int64_t>(g.period.GetNanoSeconds() / m_granularity.GetNanoSeconds(),
+                                  g.dests.size()));
+            g.events.assign(phases, EventId());
+            for (uint32_t k = 0; k < phases; k++)
+            {
+                Time offset = NanoSeconds(g.period.GetNanoSeconds() * k / phases);
+                g.events[k] = Simulator::Schedule(g.period + offset,
+                                                  &MultiFlowUdpClient::GroupTick,
+                                                  this,
+                                                  gi,
+                                                  k);
+            }
+        }
+    }
+
+    void StopApplication() override
+    {
+        m_tick.Cancel();
+        for (auto& g : m_groups)
+        {
+            for (auto& ev : g.events)
+            {
+                ev.Cancel();
+            }
+        }
+        if (m_socket)
+        {
+            m_socket->Close();
+        }
+    }
+
+    static Time Due(const Flow& f)
+    {
+        return f.on ? std::min(f.next, f.switchAt) : f.switchAt;
+    }
+
+    void Insert(uint32_t flow)
+    {
+        int64_t ahead = (Due(m_flows[flow]) - m_cursorTime).GetNanoSeconds() /
+                        m_granularity.GetNanoSeconds();
+        ahead = std::min<int64_t>(std::max<int64_t>(ahead, 1), m_wheel.size() - 1);
+        m_wheel[(m_cursor + ahead) % m_wheel.size()].push_back(flow);
+    }
+
+    // processa o próximo acontecimento do fluxo: envio ou troca ligado/desligado
+    void Advance(Flow& f)
+    {
+        if (f.on && f.next < f.switchAt)
+        {
+            m_socket->SendTo(Create<Packet>(f.size), 0, f.dest);
+            m_sent++;
+            f.lastStart = f.next;
+            f.earned = Time(0);
+            f.next += f.interval;
+        }
+        else if (f.on)
+        {
+            f.earned += f.switchAt - f.lastStart;
+            f.on = false;
+            f.switchAt += Seconds(m_offTime->GetValue());
+        }
+        else
+        {
+            f.on = true;
+            f.lastStart = f.switchAt;
+            f.next = f.switchAt + f.interval - f.earned;
+            f.switchAt += Seconds(m_onTime->GetValue());
+        }
+    }
+
+    void Tick()
+    {
+        m_cursor = (m_cursor + 1) % m_wheel.size();
+        m_cursorTime += m_granularity;
+
+        std::vector<uint32_t> due;
+        due.swap(m_wheel[m_cursor]);
+        const Time horizon = m_cursorTime + m_granularity;
+        for (uint32_t i : due)
+        {
+            Flow& f = m_flows[i];
+            // intervalos menores que o slot geram mais de um pacote por tick;
+            // fluxos revisitados antes da hora (roda curta) só voltam para ela
+            while (Due(f) < horizon)
+            {
+                Advance(f);
+            }
+            Insert(i);
+        }
+        m_tick = Simulator::Schedule(m_granularity, &MultiFlowUdpClient::Tick, this);
+    }
+
+    void GroupTick(uint32_t gi, uint32_t phase)
+    {
+        Group& g = m_groups[gi];
+        const uint32_t phases = g.events.size();
+        for (uint32_t i = phase; i < g.dests.size(); i += phases)
+        {
+            m_socket->SendTo(Create<Packet>(g.size), 0, g.dests[i]);
+            m_sent++;
+        }
+        g.events[phase] =
+            Simulator::Schedule(g.period, &MultiFlowUdpClient::GroupTick, this, gi, phase);
+    }
+
+    Time m_granularity;
+    Ptr<RandomVariableStream> m_onTime;
+    Ptr<RandomVariableStream> m_offTime;
+    std::vector<Flow> m_flows;
+    std::vector<Group> m_groups;
+    std::vector<std::vector<uint32_t>> m_wheel;
+    size_t m_cursor;
+    Time m_cursorTime;
+    Ptr<Socket> m_socket;
+    EventId m_tick;
+    uint64_t m_sent;
+};
+
+// ---------- sink UDP leve ----------
+class LightUdpSink : public Application
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("ns3::LightUdpSink")
+                                .SetParent<Application>()
+                                .SetGroupName("Applications")
+                                .AddConstructor<LightUdpSink>()
+                                .AddAttribute("Port",
+                                              "Porta UDP de escuta",
+                                              UintegerValue(9000),
+                                              MakeUintegerAccessor(&LightUdpSink::m_port),
+                                              MakeUintegerChecker<uint16_t>());
+        return tid;
+    }
+
+    LightUdpSink()
+        : m_port(9000),
+          m_rxBytes(0),
+          m_rxPackets(0)
+    {
+    }
+
+    uint64_t GetRxBytes() const
+    {
+        return m_rxBytes;
+    }
+
+    uint64_t GetRxPackets() const
+    {
+        return m_rxPackets;
+    }
+
+  protected:
+    void DoDispose() override
+    {
+        m_socket = nullptr;
+        Application::DoDispose();
+    }
+
+  private:
+    void StartApplication() override
+    {
+        if (!m_socket)
+        {
+            m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+            m_socket->Bind(InetSocketAddress(Ipv4Address::GetAny(), m_port));
+        }
+        m_socket->SetRecvCallback(MakeCallback(&LightUdpSink::HandleRead, this));
+    }
+
+    void StopApplication() override
+    {
+        if (m_socket)
+        {
+            m_socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+        }
+    }
+
+    void HandleRead(Ptr<Socket> socket)
+    {
+        Ptr<Packet> p;
+        while ((p = socket->Recv()))
+        {
+            m_rxBytes += p->GetSize();
+            m_rxPackets++;
+        }
+    }
+
+    uint16_t m_port;
+    Ptr<Socket> m_socket;
+    uint64_t m_rxBytes;
+    uint64_t m_rxPackets;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(MultiFlowUdpClient);
+NS_OBJECT_ENSURE_REGISTERED(LightUdpSink);
+
+// ---------- instala 1 cliente no nó de origem + 1 sink leve por UE ----------
+// portas basePort + i, como no laço de OnOff/PacketSink original
+inline ApplicationContainer
+InstallMultiFlowTraffic(Ptr<Node> source,
+                        const NodeContainer& ueNodes,
+                        const Ipv4InterfaceContainer& ueIfaces,
+                        uint16_t basePort,
+                        DataRate rate,
+                        uint32_t pktSize)
+{
+    ApplicationContainer apps;
+    Ptr<MultiFlowUdpClient> client = CreateObject<MultiFlowUdpClient>();
+    for (uint32_t i = 0; i < ueNodes.GetN(); i++)
+    {
+        uint16_t port = basePort + i;
+        Ptr<LightUdpSink> sink = CreateObject<LightUdpSink>();
+        sink->SetAttribute("Port", UintegerValue(port));
+        ueNodes.Get(i)->AddApplication(sink);
+        apps.Add(sink);
+
+        client->AddFlow(InetSocketAddress(ueIfaces.GetAddress(i), port), rate, pktSize);
+    }
+    source->AddApplication(client);
+    apps.Add(client);
+    return apps;
+}
+
+} // namespace ns3
+
+#endif // URBANO_MULTIFLOW_APPS_H
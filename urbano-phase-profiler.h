@@ -0,0 +1,228 @@
+// urbano-phase-profiler.h
+// Profiler por fase do cenário (substitui o PrintStep).
+//  O PrintStep imprimia clock()/CLOCKS_PER_SEC, que é tempo de CPU do processo
+//  e não tempo real, e nada sobre memória. Aqui cada fase (Begin("...") fecha a
+//  anterior; End()/Finish() fecham a última) registra:
+//   - tempo real (steady_clock) e tempo de CPU do processo;
+//   - RSS atual (/proc/self/statm) e pico de RSS (getrusage, acumulado do processo);
+//   - objetos ns-3 vivos alcançáveis pelas listas globais: nós e seus agregados,
+//     NetDevices, aplicações e canais (o ns-3 não mantém contador global de
+//     Object, então objetos internos de PHY/MAC não entram; serve para comparar
+//     fases e cenários, não como total exato);
+//   - eventos executados pelo simulador na fase (Simulator::GetEventCount). A
+//     contagem é congelada por um evento de ScheduleDestroy: depois do
+//     Simulator::Destroy() qualquer chamada ao Simulator (ou às listas de nós e
+//     canais, que se registram nele) criaria e vazaria uma implementação nova,
+//     zerada, e a fase "destroy" daria negativo.
+//  O relatório JSON é gravado em Finish() ou, se esquecido, no destrutor.
+
+#ifndef URBANO_PHASE_PROFILER_H
+#define URBANO_PHASE_PROFILER_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace ns3
+{
+
+class PhaseProfiler
+{
+  public:
+    struct Sample
+    {
+        double wallS = 0;
+        double cpuS = 0;
+        double rssMb = 0;
+        double peakRssMb = 0;
+        uint64_t objects = 0;
+        uint64_t events = 0;
+    };
+
+    struct Phase
+    {
+        std::string name;
+        Sample begin;
+        Sample end;
+    };
+
+    PhaseProfiler(const std::string& scenario, const std::string& fileName)
+        : m_scenario(scenario),
+          m_fileName(fileName),
+          m_open(false),
+          m_written(false),
+          m_destroyed(false),
+          m_finalEvents(0)
+    {
+        m_origin = std::chrono::steady_clock::now();
+        m_start = Now();
+        m_destroyEvent = Simulator::ScheduleDestroy(&PhaseProfiler::SimulatorDestroyed, this);
+    }
+
+    ~PhaseProfiler()
+    {
+        Finish();
+        if (!m_destroyed)
+        {
+            Simulator::Cancel(m_destroyEvent);
+        }
+    }
+
+    // fecha a fase corrente (se houver) e abre 'name'
+    void Begin(const std::string& name)
+    {
+        End();
+        Phase p;
+        p.name = name;
+        p.begin = Now();
+        m_phases.push_back(p);
+        m_open = true;
+        std::cout << "[PHASE] " << name << " (t=" << p.begin.wallS << " s)" << std::endl;
+    }
+
+    void End()
+    {
+        if (!m_open)
+        {
+            return;
+        }
+        Phase& p = m_phases.back();
+        p.end = Now();
+        m_open = false;
+        std::cout << "[PHASE] " << p.name << ": " << p.end.wallS - p.begin.wallS << " s real, "
+                  << p.end.cpuS - p.begin.cpuS << " s CPU, RSS " << p.end.rssMb << " MB (pico "
+                  << p.end.peakRssMb << " MB), " << p.end.objects << " objetos, "
+                  << p.end.events - p.begin.events << " eventos" << std::endl;
+    }
+
+    void Finish()
+    {
+        End();
+        if (m_written)
+        {
+            return;
+        }
+        m_written = true;
+        Sample total = Now();
+
+        std::ofstream out(m_fileName);
+        out << "{\n  \"scenario\": \"" << m_scenario << "\",\n  \"phases\": [\n";
+        for (size_t i = 0; i < m_phases.size(); i++)
+        {
+            const Phase& p = m_phases[i];
+            out << "    {\"name\": \"" << p.name << "\", "
+                << "\"wall_s\": " << p.end.wallS - p.begin.wallS << ", "
+                << "\"cpu_s\": " << p.end.cpuS - p.begin.cpuS << ", "
+                << "\"rss_mb\": " << p.end.rssMb << ", "
+                << "\"rss_delta_mb\": " << p.end.rssMb - p.begin.rssMb << ", "
+                << "\"peak_rss_mb\": " << p.end.peakRssMb << ", "
+                << "\"objects\": " << p.end.objects << ", "
+                << "\"objects_delta\": "
+                << static_cast<int64_t>(p.end.objects) - static_cast<int64_t>(p.begin.objects)
+                << ", "
+                << "\"events\": " << p.end.events - p.begin.events << "}"
+                << (i + 1 < m_phases.size() ? "," : "") << "\n";
+        }
+        out << "  ],\n  \"total\": {\"wall_s\": " << total.wallS - m_start.wallS
+            << ", \"cpu_s\": " << total.cpuS - m_start.cpuS
+            << ", \"peak_rss_mb\": " << total.peakRssMb << ", \"events\": " << total.events
+            << "}\n}\n";
+        std::cout << "[PHASE] relatório em " << m_fileName << std::endl;
+    }
+
+    const std::vector<Phase>& GetPhases() const
+    {
+        return m_phases;
+    }
+
+    // tempo real somado das fases (fechadas) cujo nome está em 'names'
+    double GetWallS(const std::vector<std::string>& names) const
+    {
+        double s = 0;
+        for (size_t i = 0; i < m_phases.size(); i++)
+        {
+            bool open = m_open && i + 1 == m_phases.size();
+            if (!open && std::find(names.begin(), names.end(), m_phases[i].name) != names.end())
+            {
+                s += m_phases[i].end.wallS - m_phases[i].begin.wallS;
+            }
+        }
+        return s;
+    }
+
+  private:
+    Sample Now() const
+    {
+        Sample s;
+        s.wallS =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - m_origin).count();
+        struct timespec ts;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        s.cpuS = ts.tv_sec + ts.tv_nsec * 1e-9;
+
+        long pages = 0;
+        long resident = 0;
+        std::ifstream statm("/proc/self/statm");
+        if (statm >> pages >> resident)
+        {
+            s.rssMb = resident * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+        }
+        struct rusage ru;
+        getrusage(RUSAGE_SELF, &ru);
+        s.peakRssMb = ru.ru_maxrss / 1024.0; // KB no Linux
+
+        // depois do Destroy as listas globais já foram esvaziadas
+        s.objects = m_destroyed ? 0 : CountObjects();
+        s.events = m_destroyed ? m_finalEvents : Simulator::GetEventCount();
+        return s;
+    }
+
+    // roda dentro do Simulator::Destroy(), com a implementação ainda viva
+    void SimulatorDestroyed()
+    {
+        m_finalEvents = Simulator::GetEventCount();
+        m_destroyed = true;
+    }
+
+    static uint64_t CountObjects()
+    {
+        uint64_t n = ChannelList::GetNChannels();
+        for (uint32_t i = 0; i < NodeList::GetNNodes(); i++)
+        {
+            Ptr<Node> node = NodeList::GetNode(i);
+            Object::AggregateIterator it = node->GetAggregateIterator();
+            while (it.HasNext())
+            {
+                it.Next();
+                n++;
+            }
+            n += node->GetNDevices() + node->GetNApplications();
+        }
+        return n;
+    }
+
+    std::string m_scenario;
+    std::string m_fileName;
+    std::chrono::steady_clock::time_point m_origin;
+    Sample m_start;
+    std::vector<Phase> m_phases;
+    bool m_open;
+    bool m_written;
+    bool m_destroyed;
+    uint64_t m_finalEvents;
+    EventId m_destroyEvent;
+};
+
+} // namespace ns3
+
+#endif // URBANO_PHASE_PROFILER_H
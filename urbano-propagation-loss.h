@@ -0,0 +1,294 @@
+// urbano-propagation-loss.h
+// Modelos de perda "embrulho" usados pelos cenários urbanos.
+//  WrappedPropagationLossModel: base comum; cada subclasse tem seu próprio
+//   atributo "Inner" (nome do TypeId do modelo interno), então pode ser usada
+//   direto em LteHelper::SetPathlossModelType e aninhada via Config::SetDefault
+//   ("ns3::<Classe>::Inner" — o SetDefault não enxerga atributos da classe mãe).
+//  CachedPropagationLossModel: memoiza a perda (dB) por par (tx, rx).
+//   - exato: chave = par de MobilityModel; cada modelo tem um contador de versão
+//     incrementado no trace CourseChange, e a entrada é recalculada quando a
+//     versão de algum lado muda (setores estáticos nunca invalidam). Só pares
+//     com os dois lados parados (estáticos ou velocidade nula) são memoizados:
+//     um UE andando muda de posição entre CourseChanges (uma perna inteira do
+//     RandomWalk2d), então esses pares vão direto ao modelo interno, sem tocar
+//     no cache. Com UEs andando o modo exato quase não acerta: para eles use a
+//     grade (o lte-urbano deixa o cache desligado por padrão);
+//   - grade (GridResolution > 0): se um dos lados é estático, a chave passa a
+//     ser (lado estático, posição quantizada do outro lado), então UEs que andam
+//     continuam acertando o cache; erro limitado à resolução da grade.
+//   A perda não depende da potência de TX, então uma entrada serve a qualquer txPower.
+//   Os traces CourseChange conectados são desconectados no DoDispose.
+
+#ifndef URBANO_PROPAGATION_LOSS_H
+#define URBANO_PROPAGATION_LOSS_H
+
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/propagation-loss-model.h"
+
+#include <cmath>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+// ---------- base: modelo com perda interna configurável ----------
+class WrappedPropagationLossModel : public PropagationLossModel
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("ns3::WrappedPropagationLossModel")
+                                .SetParent<PropagationLossModel>()
+                                .SetGroupName("Propagation");
+        return tid;
+    }
+
+    void SetInnerType(std::string typeId)
+    {
+        ObjectFactory f;
+        f.SetTypeId(typeId);
+        m_inner = f.Create<PropagationLossModel>();
+    }
+
+    Ptr<PropagationLossModel> GetInner() const
+    {
+        return m_inner;
+    }
+
+  protected:
+    double InnerLossDb(Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+    {
+        return -m_inner->CalcRxPower(0.0, a, b);
+    }
+
+    int64_t DoAssignStreams(int64_t stream) override
+    {
+        return m_inner->AssignStreams(stream);
+    }
+
+    void DoDispose() override
+    {
+        m_inner = nullptr;
+        PropagationLossModel::DoDispose();
+    }
+
+    Ptr<PropagationLossModel> m_inner;
+};
+
+// procura um modelo do tipo T seguindo a cadeia de embrulhos (e SetNext)
+template <typename T>
+Ptr<T>
+FindPropagationLossModel(Ptr<PropagationLossModel> m)
+{
+    while (m)
+    {
+        Ptr<T> t = DynamicCast<T>(m);
+        if (t)
+        {
+            return t;
+        }
+        Ptr<WrappedPropagationLossModel> w = DynamicCast<WrappedPropagationLossModel>(m);
+        m = w ? w->GetInner() : m->GetNext();
+    }
+    return nullptr;
+}
+
+// ---------- cache de perda por par / por grade ----------
+class CachedPropagationLossModel : public WrappedPropagationLossModel
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::CachedPropagationLossModel")
+                .SetParent<WrappedPropagationLossModel>()
+                .SetGroupName("Propagation")
+                .AddConstructor<CachedPropagationLossModel>()
+                .AddAttribute("Inner",
+                              "TypeId do modelo de perda embrulhado",
+                              StringValue("ns3::LogDistancePropagationLossModel"),
+                              MakeStringAccessor(&WrappedPropagationLossModel::SetInnerType),
+                              MakeStringChecker())
+                .AddAttribute("GridResolution",
+                              "Resolução (m) da grade para pares com um lado estático; "
+                              "0 = memoização exata por par",
+                              DoubleValue(0.0),
+                              MakeDoubleAccessor(&CachedPropagationLossModel::m_gridResolution),
+                              MakeDoubleChecker<double>(0.0));
+        return tid;
+    }
+
+    CachedPropagationLossModel()
+        : m_hits(0),
+          m_misses(0)
+    {
+    }
+
+    uint64_t GetHits() const
+    {
+        return m_hits;
+    }
+
+    uint64_t GetMisses() const
+    {
+        return m_misses;
+    }
+
+    double GetHitRate() const
+    {
+        uint64_t total = m_hits + m_misses;
+        return total ? static_cast<double>(m_hits) / total : 0.0;
+    }
+
+    size_t GetCacheSize() const
+    {
+        return m_cache.size();
+    }
+
+  private:
+    struct Key
+    {
+        const MobilityModel* a;
+        const MobilityModel* b;
+        int64_t cell;
+
+        bool operator==(const Key& o) const
+        {
+            return a == o.a && b == o.b && cell == o.cell;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& k) const
+        {
+            size_t h = std::hash<const void*>()(k.a);
+            h ^= std::hash<const void*>()(k.b) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            h ^= std::hash<int64_t>()(k.cell) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            return h;
+        }
+    };
+
+    struct Entry
+    {
+        double lossDb;
+        uint32_t va;
+        uint32_t vb;
+    };
+
+    double DoCalcRxPower(double txPowerDbm,
+                         Ptr<MobilityModel> a,
+                         Ptr<MobilityModel> b) const override
+    {
+        Key key{PeekPointer(a), PeekPointer(b), 0};
+        uint32_t va = 0;
+        uint32_t vb = 0;
+        if (m_gridResolution > 0 && IsStatic(a))
+        {
+            key = Key{PeekPointer(a), nullptr, Quantize(b->GetPosition())};
+            va = Version(a);
+        }
+        else if (m_gridResolution > 0 && IsStatic(b))
+        {
+            key = Key{nullptr, PeekPointer(b), Quantize(a->GetPosition())};
+            vb = Version(b);
+        }
+        else if (!IsStill(a) || !IsStill(b))
+        {
+            // chave exata com um lado em movimento ficaria velha até o próximo CourseChange
+            m_misses++;
+            return txPowerDbm - InnerLossDb(a, b);
+        }
+        else
+        {
+            va = Version(a);
+            vb = Version(b);
+        }
+
+        auto it = m_cache.find(key);
+        if (it != m_cache.end() && it->second.va == va && it->second.vb == vb)
+        {
+            m_hits++;
+            return txPowerDbm - it->second.lossDb;
+        }
+        m_misses++;
+        double loss = InnerLossDb(a, b);
+        m_cache[key] = Entry{loss, va, vb};
+        return txPowerDbm - loss;
+    }
+
+    // versão do modelo de mobilidade; conecta ao CourseChange na primeira vez
+    uint32_t Version(Ptr<MobilityModel> m) const
+    {
+        auto it = m_versions.find(PeekPointer(m));
+        if (it != m_versions.end())
+        {
+            return it->second;
+        }
+        m_versions[PeekPointer(m)] = 0;
+        m->TraceConnectWithoutContext("CourseChange", CourseChangeCallback());
+        m_connected.push_back(m);
+        return 0;
+    }
+
+    Callback<void, Ptr<const MobilityModel>> CourseChangeCallback() const
+    {
+        return MakeCallback(&CachedPropagationLossModel::CourseChanged, this);
+    }
+
+    void DoDispose() override
+    {
+        for (const auto& m : m_connected)
+        {
+            m->TraceDisconnectWithoutContext("CourseChange", CourseChangeCallback());
+        }
+        m_connected.clear();
+        m_versions.clear();
+        m_cache.clear();
+        WrappedPropagationLossModel::DoDispose();
+    }
+
+    void CourseChanged(Ptr<const MobilityModel> m) const
+    {
+        m_versions[PeekPointer(m)]++;
+    }
+
+    static bool IsStatic(Ptr<MobilityModel> m)
+    {
+        return DynamicCast<ConstantPositionMobilityModel>(m) != nullptr;
+    }
+
+    static bool IsStill(Ptr<MobilityModel> m)
+    {
+        if (IsStatic(m))
+        {
+            return true;
+        }
+        Vector v = m->GetVelocity();
+        return v.x == 0 && v.y == 0 && v.z == 0;
+    }
+
+    int64_t Quantize(const Vector& p) const
+    {
+        int64_t qx = static_cast<int64_t>(std::floor(p.x / m_gridResolution));
+        int64_t qy = static_cast<int64_t>(std::floor(p.y / m_gridResolution));
+        return (qx << 32) ^ (qy & 0xffffffff);
+    }
+
+    double m_gridResolution;
+    mutable std::unordered_map<Key, Entry, KeyHash> m_cache;
+    mutable std::unordered_map<const MobilityModel*, uint32_t> m_versions;
+    mutable std::vector<Ptr<MobilityModel>> m_connected;
+    mutable uint64_t m_hits;
+    mutable uint64_t m_misses;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(WrappedPropagationLossModel);
+NS_OBJECT_ENSURE_REGISTERED(CachedPropagationLossModel);
+
+} // namespace ns3
+
+#endif // URBANO_PROPAGATION_LOSS_H
@@ -0,0 +1,287 @@
+// urbano-sequential-stop.h
+// Parada sequencial: encerra a rodada quando os ICs das KPIs convergem.
+//  Liga no callback de janela do KpiWindowRecorder (linhas por setor) e agrupa
+//  as janelas em lotes (batch means) de BatchWindows janelas. Por lote calcula,
+//  para a rede (soma dos setores) e, opcionalmente, para cada setor:
+//   thr   = bits recebidos / duração do lote (Mb/s)
+//   delay = soma dos atrasos / pacotes recebidos (ms)
+//   loss  = (tx - rx) / tx (%)
+//  As médias dos lotes entram em acumuladores de Welford (memória constante por
+//  setor). Descartados os SkipBatches primeiros lotes (transitório do início do
+//  tráfego), com pelo menos MinBatches lotes a meia-largura do IC de 95%
+//  (t de Student, k-1 graus) de cada KPI alvo é comparada com RelHalfWidth x
+//  |média| (perda: ou até LossAbsPct pontos percentuais, já que a média pode ser
+//  ~0). Quando todas convergem, Simulator::Stop(); o simTime do cenário fica
+//  como teto. O motivo e o instante da parada vão para o console e para o CSV.
+
+#ifndef URBANO_SEQUENTIAL_STOP_H
+#define URBANO_SEQUENTIAL_STOP_H
+
+#include "urbano-kpi-recorder.h"
+
+#include "ns3/core-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+struct SequentialStopConfig
+{
+    double relHalfWidth = 0.05;
+    double lossAbsPct = 0.1;
+    uint32_t batchWindows = 10;
+    uint32_t minBatches = 10;
+    uint32_t skipBatches = 1;
+    std::string kpis = "thr,delay,loss"; // alvos, separados por vírgula
+    bool perSector = false;              // exige convergência também em cada setor
+};
+
+// quantil 0.975 da t de Student: tabela até 9 graus, depois expansão de
+// Cornish-Fisher (erro < 0.1%)
+inline double
+StudentT975(uint32_t df)
+{
+    static const double small[] = {0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262};
+    if (df < 10)
+    {
+        return small[df == 0 ? 1 : df];
+    }
+    const double z = 1.959964;
+    const double v = df;
+    return z + (z * z * z + z) / (4 * v) + (5 * std::pow(z, 5) + 16 * z * z * z + 3 * z) / (96 * v * v);
+}
+
+class SequentialStop
+{
+  public:
+    SequentialStop(const SequentialStopConfig& cfg, const std::string& fileName)
+        : m_cfg(cfg),
+          m_file(fileName),
+          m_windows(0),
+          m_batches(0),
+          m_converged(false)
+    {
+        NS_ABORT_MSG_IF(cfg.batchWindows == 0, "SequentialStop: BatchWindows deve ser > 0");
+        NS_ABORT_MSG_IF(cfg.minBatches < 2, "SequentialStop: MinBatches deve ser >= 2");
+        std::stringstream ss(cfg.kpis);
+        std::string k;
+        while (std::getline(ss, k, ','))
+        {
+            int idx = k == "thr" ? THR : k == "delay" ? DELAY : k == "loss" ? LOSS : -1;
+            NS_ABORT_MSG_IF(idx < 0, "SequentialStop: KPI desconhecida '" << k << "' (thr, delay, loss)");
+            m_targets.push_back(idx);
+        }
+        NS_ABORT_MSG_IF(m_targets.empty(), "SequentialStop: nenhuma KPI alvo");
+    }
+
+    void Attach(KpiWindowRecorder& kpi)
+    {
+        kpi.SetWindowCallback([this](const std::vector<KpiRow>& rows) { OnWindow(rows); });
+    }
+
+    bool IsConverged() const
+    {
+        return m_converged;
+    }
+
+    // relatório final; chamar após Simulator::Run()
+    void Report() const
+    {
+        std::string reason = m_converged ? "converged" : "maxTime";
+        Time at = m_converged ? m_stopAt : Simulator::Now();
+        std::cout << "[STOP] " << (m_converged ? "ICs convergiram" : "teto de tempo (simTime) atingido")
+                  << " em t=" << at.GetSeconds() << " s após " << m_batches << " lotes ("
+                  << (m_batches > m_cfg.skipBatches ? m_batches - m_cfg.skipBatches : 0) << " usados)"
+                  << std::endl;
+        std::ofstream out(m_file);
+        out << "scope,kpi,batches,mean,half_width,rel_half_width,converged,stop_reason,stop_t_s\n";
+        auto rows = [&](const std::string& scope, const Scope& s, bool print) {
+            for (int k = 0; k < NKPI; k++)
+            {
+                const Welford& w = s.kpi[k];
+                double hw = HalfWidth(w);
+                out << scope << "," << Name(k) << "," << w.n << "," << w.mean << "," << hw << ","
+                    << (w.mean != 0 ? hw / std::abs(w.mean) : 0.0) << "," << (Converged(k, w) ? 1 : 0)
+                    << "," << reason << "," << at.GetSeconds() << "\n";
+                if (print)
+                {
+                    std::cout << "[STOP] " << Name(k) << ": " << w.mean << " ±" << hw << " ("
+                              << w.n << " lotes)" << std::endl;
+                }
+            }
+        };
+        rows("network", m_network, true);
+        for (const auto& kv : m_sectors)
+        {
+            rows(std::to_string(kv.first), kv.second, false);
+        }
+    }
+
+  private:
+    enum
+    {
+        THR = 0,
+        DELAY = 1,
+        LOSS = 2,
+        NKPI = 3
+    };
+
+    struct Welford
+    {
+        uint32_t n = 0;
+        double mean = 0;
+        double m2 = 0;
+
+        void Add(double x)
+        {
+            n++;
+            double d = x - mean;
+            mean += d / n;
+            m2 += d * (x - mean);
+        }
+    };
+
+    // acumulado do lote corrente + médias de lote por KPI
+    struct Scope
+    {
+        double rxBits = 0;
+        double txPackets = 0;
+        double rxPackets = 0;
+        double delayS = 0;
+        Welford kpi[NKPI];
+    };
+
+    static const char* Name(int k)
+    {
+        static const char* names[] = {"thr_mbps", "delay_ms", "loss_pct"};
+        return names[k];
+    }
+
+    double HalfWidth(const Welford& w) const
+    {
+        if (w.n < 2)
+        {
+            return 0.0;
+        }
+        return StudentT975(w.n - 1) * std::sqrt(w.m2 / (w.n - 1) / w.n);
+    }
+
+    bool Converged(int k, const Welford& w) const
+    {
+        if (w.n < m_cfg.minBatches)
+        {
+            return false;
+        }
+        double hw = HalfWidth(w);
+        return hw <= m_cfg.relHalfWidth * std::abs(w.mean) || (k == LOSS && hw <= m_cfg.lossAbsPct);
+    }
+
+    void OnWindow(const std::vector<KpiRow>& rows)
+    {
+        if (m_converged)
+        {
+            return; // janela parcial do Finish() após a parada
+        }
+        for (const KpiRow& r : rows)
+        {
+            Accumulate(m_network, r);
+            if (m_cfg.perSector)
+            {
+                Accumulate(m_sectors[r.id], r);
+            }
+        }
+        // duração do lote pelo relógio simulado (janela sem nenhum tráfego não tem linhas)
+        Time now = Simulator::Now();
+        m_batchS += m_lastWindow.IsStrictlyPositive() ? (now - m_lastWindow).GetSeconds()
+                                                      : (rows.empty() ? 0.0 : rows.front().windowS);
+        m_lastWindow = now;
+        if (++m_windows < m_cfg.batchWindows)
+        {
+            return;
+        }
+        bool use = m_batches >= m_cfg.skipBatches;
+        CloseBatch(m_network, use);
+        for (auto& kv : m_sectors)
+        {
+            CloseBatch(kv.second, use);
+        }
+        m_batches++;
+        m_windows = 0;
+        m_batchS = 0;
+
+        if (use && AllConverged())
+        {
+            m_converged = true;
+            m_stopAt = Simulator::Now();
+            Simulator::Stop();
+        }
+    }
+
+    static void Accumulate(Scope& s, const KpiRow& r)
+    {
+        s.rxBits += 8.0 * r.rxBytes;
+        s.txPackets += r.txPackets;
+        s.rxPackets += r.rxPackets;
+        s.delayS += r.delaySumS;
+    }
+
+    void CloseBatch(Scope& s, bool use) const
+    {
+        if (use && m_batchS > 0)
+        {
+            s.kpi[THR].Add(s.rxBits / m_batchS / 1e6);
+            if (s.rxPackets > 0)
+            {
+                s.kpi[DELAY].Add(s.delayS / s.rxPackets * 1e3);
+            }
+            if (s.txPackets > 0)
+            {
+                s.kpi[LOSS].Add(100.0 * std::max(0.0, s.txPackets - s.rxPackets) / s.txPackets);
+            }
+        }
+        s.rxBits = s.txPackets = s.rxPackets = s.delayS = 0;
+    }
+
+    bool AllConverged() const
+    {
+        for (int k : m_targets)
+        {
+            if (!Converged(k, m_network.kpi[k]))
+            {
+                return false;
+            }
+            for (const auto& kv : m_sectors)
+            {
+                if (!Converged(k, kv.second.kpi[k]))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    SequentialStopConfig m_cfg;
+    std::string m_file;
+    std::vector<int> m_targets;
+    Scope m_network;
+    std::map<uint32_t, Scope> m_sectors;
+    uint32_t m_windows;
+    uint32_t m_batches;
+    double m_batchS = 0;
+    Time m_lastWindow;
+    bool m_converged;
+    Time m_stopAt;
+};
+
+} // namespace ns3
+
+#endif // URBANO_SEQUENTIAL_STOP_H
@@ -0,0 +1,401 @@
+// urbano-shadowing-map.h
+// Sombreamento espacialmente correlacionado por mapa (um campo 2D por site).
+//  O sombreamento do ThreeGppPropagationLossModel (ShadowingEnabled) guarda
+//  estado por enlace (par gNB/UE) e o atualiza conforme o UE anda: a memória
+//  cresce com setores x UEs. Aqui cada site tem um campo gaussiano 2D gerado uma
+//  vez sobre a área dos UEs (Bounds, passo Resolution):
+//   - ruído branco N(0,1) filtrado no domínio da frequência (FFT 2D radix-2)
+//     pela raiz do espectro da covariância exp(-d/DecorrelationDistance)
+//     (Gudmundson), com folga de 2 distâncias de descorrelação em cada borda
+//     para a periodicidade da FFT não aparecer; variância unitária por Parseval;
+//   - InterSiteCorrelation (ρ): campo do site = √ρ·comum + √(1-ρ)·próprio;
+//   - consulta O(1): interpolação bilinear na posição do lado móvel, em dB x Sigma.
+//  A memória passa a escalar com a área (células x sites x 4 bytes), não com o
+//  número de enlaces. Os setores (1 m do centro) usam o campo do site mais
+//  próximo registrado via AddSite; sem sites registrados cada nó estático tem o
+//  seu. Gerado sob demanda no primeiro enlace do site (no MPI só os sites do rank).
+//  ShadowingMapPropagationLossModel não tem modelo interno: entra na cadeia do
+//  canal com SpectrumChannel::AddPropagationLossModel, que faz SetNext para a
+//  cabeça atual, então cada canal precisa do seu objeto. Share() cria outro com
+//  os mesmos atributos e os mesmos campos (std::shared_ptr): um para o DL e outro
+//  para o UL (LTE), um por BWP (NR), e o sombreamento continua recíproco.
+//  O campo não é periódico no toro hexagonal do wrap-around (urbano-wrap-around.h):
+//  o lte-urbano rejeita essa combinação.
+
+#ifndef URBANO_SHADOWING_MAP_H
+#define URBANO_SHADOWING_MAP_H
+
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/propagation-loss-model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+// FFT complexa in-place (n potência de 2); inverse divide por n
+inline void
+Fft(std::vector<std::complex<double>>& a, bool inverse)
+{
+    const size_t n = a.size();
+    for (size_t i = 1, j = 0; i < n; i++)
+    {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j)
+        {
+            std::swap(a[i], a[j]);
+        }
+    }
+    for (size_t len = 2; len <= n; len <<= 1)
+    {
+        double ang = 2 * M_PI / len * (inverse ? 1 : -1);
+        std::complex<double> wlen(std::cos(ang), std::sin(ang));
+        for (size_t i = 0; i < n; i += len)
+        {
+            std::complex<double> w(1.0, 0.0);
+            for (size_t j = 0; j < len / 2; j++)
+            {
+                std::complex<double> u = a[i + j];
+                std::complex<double> v = a[i + j + len / 2] * w;
+                a[i + j] = u + v;
+                a[i + j + len / 2] = u - v;
+                w *= wlen;
+            }
+        }
+    }
+    if (inverse)
+    {
+        for (auto& x : a)
+        {
+            x /= static_cast<double>(n);
+        }
+    }
+}
+
+// FFT 2D de uma grade nx x ny (índice y*nx + x): linhas, depois colunas
+inline void
+Fft2d(std::vector<std::complex<double>>& g, uint32_t nx, uint32_t ny, bool inverse)
+{
+    std::vector<std::complex<double>> line(nx);
+    for (uint32_t y = 0; y < ny; y++)
+    {
+        std::copy(g.begin() + y * nx, g.begin() + (y + 1) * nx, line.begin());
+        Fft(line, inverse);
+        std::copy(line.begin(), line.end(), g.begin() + y * nx);
+    }
+    line.resize(ny);
+    for (uint32_t x = 0; x < nx; x++)
+    {
+        for (uint32_t y = 0; y < ny; y++)
+        {
+            line[y] = g[y * nx + x];
+        }
+        Fft(line, inverse);
+        for (uint32_t y = 0; y < ny; y++)
+        {
+            g[y * nx + x] = line[y];
+        }
+    }
+}
+
+class ShadowingMapPropagationLossModel : public PropagationLossModel
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::ShadowingMapPropagationLossModel")
+                .SetParent<PropagationLossModel>()
+                .SetGroupName("Propagation")
+                .AddConstructor<ShadowingMapPropagationLossModel>()
+                .AddAttribute("Sigma",
+                              "Desvio padrão do sombreamento (dB)",
+                              DoubleValue(7.0),
+                              MakeDoubleAccessor(&ShadowingMapPropagationLossModel::m_sigma),
+                              MakeDoubleChecker<double>(0.0))
+                .AddAttribute("DecorrelationDistance",
+                              "Distância (m) em que a correlação cai a 1/e",
+                              DoubleValue(50.0),
+                              MakeDoubleAccessor(&ShadowingMapPropagationLossModel::m_decorrelation),
+                              MakeDoubleChecker<double>(0.1))
+                .AddAttribute("Resolution",
+                              "Passo (m) da grade do campo",
+                              DoubleValue(10.0),
+                              MakeDoubleAccessor(&ShadowingMapPropagationLossModel::m_resolution),
+                              MakeDoubleChecker<double>(0.1))
+                .AddAttribute("InterSiteCorrelation",
+                              "Correlação entre os campos de sites diferentes",
+                              DoubleValue(0.5),
+                              MakeDoubleAccessor(&ShadowingMapPropagationLossModel::m_rho),
+                              MakeDoubleChecker<double>(0.0, 1.0))
+                .AddAttribute("Bounds",
+                              "Área coberta pelo campo (posições fora usam a borda)",
+                              RectangleValue(Rectangle(0.0, 1000.0, 0.0, 1000.0)),
+                              MakeRectangleAccessor(&ShadowingMapPropagationLossModel::m_bounds),
+                              MakeRectangleChecker());
+        return tid;
+    }
+
+    ShadowingMapPropagationLossModel()
+        : m_store(std::make_shared<Store>())
+    {
+        m_store->normal = CreateObject<NormalRandomVariable>();
+    }
+
+    // modelo para a cadeia de outro canal: mesmos atributos, mesmos sites e campos
+    Ptr<ShadowingMapPropagationLossModel> Share() const
+    {
+        Ptr<ShadowingMapPropagationLossModel> m = CreateObjectWithAttributes<ShadowingMapPropagationLossModel>(
+            "Sigma", DoubleValue(m_sigma),
+            "DecorrelationDistance", DoubleValue(m_decorrelation),
+            "Resolution", DoubleValue(m_resolution),
+            "InterSiteCorrelation", DoubleValue(m_rho),
+            "Bounds", RectangleValue(m_bounds));
+        m->m_store = m_store;
+        return m;
+    }
+
+    // centro de um site; os nós estáticos usam o campo do site mais próximo
+    void AddSite(const Vector& center)
+    {
+        m_store->sites.push_back(center);
+        m_store->fields.emplace_back();
+    }
+
+    size_t GetGeneratedFields() const
+    {
+        size_t n = 0;
+        for (const auto& f : m_store->fields)
+        {
+            n += !f.empty();
+        }
+        return n;
+    }
+
+    // consultas de todos os modelos que compartilham os campos
+    uint64_t GetLookups() const
+    {
+        return m_store->lookups;
+    }
+
+    // bytes dos campos gerados (+ campo comum)
+    size_t GetMemoryBytes() const
+    {
+        const Store& st = *m_store;
+        return (GetGeneratedFields() + (st.common.empty() ? 0 : 1)) * st.cx * st.cy * sizeof(float);
+    }
+
+    void Report() const
+    {
+        const Store& st = *m_store;
+        std::cout << "[SHADOW] mapa: " << GetGeneratedFields() << "/" << st.fields.size()
+                  << " campos de " << st.cx << "x" << st.cy << " (" << m_resolution << " m, σ "
+                  << m_sigma << " dB, d_corr " << m_decorrelation << " m), "
+                  << GetMemoryBytes() / 1048576.0 << " MB, " << st.lookups << " consultas" << std::endl;
+    }
+
+  private:
+    // estado gerado, compartilhado entre os modelos criados por Share()
+    struct Store
+    {
+        Ptr<NormalRandomVariable> normal;
+        std::vector<Vector> sites;
+        std::vector<std::vector<float>> fields;
+        std::vector<float> common;
+        std::vector<double> filter;
+        std::unordered_map<const MobilityModel*, uint32_t> siteOf;
+        uint32_t cx = 0;
+        uint32_t cy = 0;
+        uint64_t lookups = 0;
+    };
+
+    double DoCalcRxPower(double txPowerDbm,
+                         Ptr<MobilityModel> a,
+                         Ptr<MobilityModel> b) const override
+    {
+        bool sa = IsStatic(a);
+        bool sb = IsStatic(b);
+        if (sa == sb)
+        {
+            return txPowerDbm; // site-site ou UE-UE: sem sombreamento
+        }
+        Ptr<MobilityModel> site = sa ? a : b;
+        Ptr<MobilityModel> ue = sa ? b : a;
+        m_store->lookups++;
+        return txPowerDbm - m_sigma * Sample(Field(SiteOf(site)), ue->GetPosition());
+    }
+
+    int64_t DoAssignStreams(int64_t stream) override
+    {
+        m_store->normal->SetStream(stream);
+        return 1;
+    }
+
+    void DoDispose() override
+    {
+        // os campos ficam com os outros modelos que ainda os compartilham
+        m_store = nullptr;
+        PropagationLossModel::DoDispose();
+    }
+
+    static bool IsStatic(Ptr<MobilityModel> m)
+    {
+        return DynamicCast<ConstantPositionMobilityModel>(m) != nullptr;
+    }
+
+    uint32_t SiteOf(Ptr<MobilityModel> m) const
+    {
+        Store& st = *m_store;
+        auto it = st.siteOf.find(PeekPointer(m));
+        if (it != st.siteOf.end())
+        {
+            return it->second;
+        }
+        Vector p = m->GetPosition();
+        uint32_t best = st.sites.size();
+        double bestD = 0;
+        for (uint32_t s = 0; s < st.sites.size(); s++)
+        {
+            double dx = st.sites[s].x - p.x;
+            double dy = st.sites[s].y - p.y;
+            if (best == st.sites.size() || dx * dx + dy * dy < bestD)
+            {
+                best = s;
+                bestD = dx * dx + dy * dy;
+            }
+        }
+        if (best == st.sites.size())
+        {
+            // sem sites registrados: campo próprio do nó
+            st.sites.push_back(p);
+            st.fields.emplace_back();
+        }
+        st.siteOf[PeekPointer(m)] = best;
+        return best;
+    }
+
+    const std::vector<float>& Field(uint32_t site) const
+    {
+        Store& st = *m_store;
+        std::vector<float>& f = st.fields[site];
+        if (f.empty())
+        {
+            if (m_rho > 0 && st.common.empty())
+            {
+                st.common = Generate();
+            }
+            f = Generate();
+            if (m_rho > 0)
+            {
+                const float wc = std::sqrt(m_rho);
+                const float wo = std::sqrt(1.0 - m_rho);
+                for (size_t k = 0; k < f.size(); k++)
+                {
+                    f[k] = wc * st.common[k] + wo * f[k];
+                }
+            }
+        }
+        return f;
+    }
+
+    // campo N(0,1) correlacionado, recortado para Bounds
+    std::vector<float> Generate() const
+    {
+        Store& st = *m_store;
+        const double w = m_bounds.xMax - m_bounds.xMin;
+        const double h = m_bounds.yMax - m_bounds.yMin;
+        st.cx = std::max<uint32_t>(2, std::ceil(w / m_resolution) + 1);
+        st.cy = std::max<uint32_t>(2, std::ceil(h / m_resolution) + 1);
+        const uint32_t pad = std::ceil(4 * m_decorrelation / m_resolution);
+        uint32_t nx = 1;
+        uint32_t ny = 1;
+        while (nx < st.cx + pad)
+        {
+            nx <<= 1;
+        }
+        while (ny < st.cy + pad)
+        {
+            ny <<= 1;
+        }
+        if (st.filter.size() != size_t(nx) * ny)
+        {
+            // raiz do espectro da covariância exp(-d/dc), distância periódica
+            std::vector<std::complex<double>> c(size_t(nx) * ny);
+            for (uint32_t y = 0; y < ny; y++)
+            {
+                for (uint32_t x = 0; x < nx; x++)
+                {
+                    double dx = std::min(x, nx - x) * m_resolution;
+                    double dy = std::min(y, ny - y) * m_resolution;
+                    c[y * nx + x] = std::exp(-std::sqrt(dx * dx + dy * dy) / m_decorrelation);
+                }
+            }
+            Fft2d(c, nx, ny, false);
+            st.filter.resize(c.size());
+            for (size_t k = 0; k < c.size(); k++)
+            {
+                st.filter[k] = std::sqrt(std::max(0.0, c[k].real()));
+            }
+        }
+        std::vector<std::complex<double>> g(size_t(nx) * ny);
+        for (auto& v : g)
+        {
+            v = st.normal->GetValue();
+        }
+        Fft2d(g, nx, ny, false);
+        for (size_t k = 0; k < g.size(); k++)
+        {
+            g[k] *= st.filter[k];
+        }
+        Fft2d(g, nx, ny, true);
+        std::vector<float> f(size_t(st.cx) * st.cy);
+        for (uint32_t y = 0; y < st.cy; y++)
+        {
+            for (uint32_t x = 0; x < st.cx; x++)
+            {
+                f[y * st.cx + x] = g[y * nx + x].real();
+            }
+        }
+        return f;
+    }
+
+    // interpolação bilinear (posições fora de Bounds ficam na borda)
+    double Sample(const std::vector<float>& f, const Vector& p) const
+    {
+        const Store& st = *m_store;
+        double fx = std::clamp((p.x - m_bounds.xMin) / m_resolution, 0.0, st.cx - 1.0);
+        double fy = std::clamp((p.y - m_bounds.yMin) / m_resolution, 0.0, st.cy - 1.0);
+        uint32_t ix = std::min<uint32_t>(fx, st.cx - 2);
+        uint32_t iy = std::min<uint32_t>(fy, st.cy - 2);
+        double tx = fx - ix;
+        double ty = fy - iy;
+        const float* r0 = &f[iy * st.cx + ix];
+        const float* r1 = r0 + st.cx;
+        return (1 - ty) * ((1 - tx) * r0[0] + tx * r0[1]) + ty * ((1 - tx) * r1[0] + tx * r1[1]);
+    }
+
+    double m_sigma;
+    double m_decorrelation;
+    double m_resolution;
+    double m_rho;
+    Rectangle m_bounds;
+    std::shared_ptr<Store> m_store;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(ShadowingMapPropagationLossModel);
+
+} // namespace ns3
+
+#endif // URBANO_SHADOWING_MAP_H
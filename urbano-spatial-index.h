@@ -0,0 +1,255 @@
+// urbano-spatial-index.h
+// Índice espacial em grade uniforme (2D) para consultas UE <-> site/setor.
+//  Substitui as buscas força-bruta O(UE × gNB) do cenário (checagem de colisão
+//  e attach ao setor mais próximo). Cada célula da grade guarda os índices dos
+//  pontos que caem nela; com célula ~ ISD cada consulta visita poucas células.
+//  Distâncias são 3D (como MobilityModel::GetDistanceFrom); a grade usa só x/y,
+//  o que continua correto porque a distância 2D é um limite inferior da 3D.
+
+#ifndef URBANO_SPATIAL_INDEX_H
+#define URBANO_SPATIAL_INDEX_H
+
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace ns3
+{
+
+class UniformGridIndex
+{
+  public:
+    UniformGridIndex()
+        : m_cell(1.0),
+          m_minX(0),
+          m_minY(0),
+          m_nx(0),
+          m_ny(0)
+    {
+    }
+
+    UniformGridIndex(const std::vector<Vector>& points, double cellSize)
+    {
+        Build(points, cellSize);
+    }
+
+    // índice a partir das posições atuais dos nós (ex.: setores gNB/eNB)
+    static UniformGridIndex FromNodes(const NodeContainer& nodes, double cellSize)
+    {
+        std::vector<Vector> pts;
+        pts.reserve(nodes.GetN());
+        for (uint32_t i = 0; i < nodes.GetN(); i++)
+        {
+            pts.push_back(nodes.Get(i)->GetObject<MobilityModel>()->GetPosition());
+        }
+        return UniformGridIndex(pts, cellSize);
+    }
+
+    void Build(const std::vector<Vector>& points, double cellSize)
+    {
+        m_points = points;
+        m_cell = cellSize > 0 ? cellSize : 1.0;
+        m_minX = m_minY = std::numeric_limits<double>::max();
+        double maxX = std::numeric_limits<double>::lowest();
+        double maxY = std::numeric_limits<double>::lowest();
+        for (const auto& p : m_points)
+        {
+            m_minX = std::min(m_minX, p.x);
+            m_minY = std::min(m_minY, p.y);
+            maxX = std::max(maxX, p.x);
+            maxY = std::max(maxY, p.y);
+        }
+        if (m_points.empty())
+        {
+            m_minX = m_minY = maxX = maxY = 0;
+        }
+        m_nx = static_cast<int32_t>((maxX - m_minX) / m_cell) + 1;
+        m_ny = static_cast<int32_t>((maxY - m_minY) / m_cell) + 1;
+
+        // CSR: m_start[c]..m_start[c+1] aponta para os pontos da célula c
+        std::vector<uint32_t> count(m_nx * m_ny + 1, 0);
+        for (const auto& p : m_points)
+        {
+            count[CellOf(p) + 1]++;
+        }
+        for (size_t c = 1; c < count.size(); c++)
+        {
+            count[c] += count[c - 1];
+        }
+        m_start = count;
+        m_items.assign(m_points.size(), 0);
+        for (uint32_t i = 0; i < m_points.size(); i++)
+        {
+            m_items[count[CellOf(m_points[i])]++] = i;
+        }
+    }
+
+    uint32_t GetN() const
+    {
+        return m_points.size();
+    }
+
+    const Vector& GetPoint(uint32_t i) const
+    {
+        return m_points[i];
+    }
+
+    // ponto mais próximo de p (busca em anéis de células até não haver melhora possível)
+    uint32_t Nearest(const Vector& p) const
+    {
+        NS_ASSERT_MSG(!m_points.empty(), "índice espacial vazio");
+        int32_t cx = ClampX(p.x);
+        int32_t cy = ClampY(p.y);
+        uint32_t best = 0;
+        double bestD2 = std::numeric_limits<double>::max();
+        int32_t maxRing = std::max(m_nx, m_ny);
+        for (int32_t ring = 0; ring <= maxRing; ring++)
+        {
+            for (int32_t y = cy - ring; y <= cy + ring; y++)
+            {
+                for (int32_t x = cx - ring; x <= cx + ring; x++)
+                {
+                    // só a borda do anel
+                    if (std::abs(x - cx) != ring && std::abs(y - cy) != ring)
+                    {
+                        continue;
+                    }
+                    ScanCell(x, y, p, best, bestD2);
+                }
+            }
+            // qualquer ponto fora do anel atual está a pelo menos 'GapTo(ring)' de p
+            double gap = GapTo(p, cx, cy, ring);
+            if (gap == std::numeric_limits<double>::max() ||
+                (bestD2 < std::numeric_limits<double>::max() && gap * gap >= bestD2))
+            {
+                break;
+            }
+        }
+        return best;
+    }
+
+    // índices de todos os pontos a até 'radius' de p
+    std::vector<uint32_t> Within(const Vector& p, double radius) const
+    {
+        std::vector<uint32_t> out;
+        if (m_points.empty())
+        {
+            return out;
+        }
+        int32_t x0 = ClampX(p.x - radius);
+        int32_t x1 = ClampX(p.x + radius);
+        int32_t y0 = ClampY(p.y - radius);
+        int32_t y1 = ClampY(p.y + radius);
+        const double r2 = radius * radius;
+        for (int32_t y = y0; y <= y1; y++)
+        {
+            for (int32_t x = x0; x <= x1; x++)
+            {
+                uint32_t c = y * m_nx + x;
+                for (uint32_t k = m_start[c]; k < m_start[c + 1]; k++)
+                {
+                    if (Dist2(p, m_points[m_items[k]]) <= r2)
+                    {
+                        out.push_back(m_items[k]);
+                    }
+                }
+            }
+        }
+        return out;
+    }
+
+  private:
+    static double Dist2(const Vector& a, const Vector& b)
+    {
+        double dx = a.x - b.x;
+        double dy = a.y - b.y;
+        double dz = a.z - b.z;
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    int32_t ClampX(double x) const
+    {
+        int32_t c = static_cast<int32_t>(std::floor((x - m_minX) / m_cell));
+        return std::min(std::max(c, 0), m_nx - 1);
+    }
+
+    int32_t ClampY(double y) const
+    {
+        int32_t c = static_cast<int32_t>(std::floor((y - m_minY) / m_cell));
+        return std::min(std::max(c, 0), m_ny - 1);
+    }
+
+    uint32_t CellOf(const Vector& p) const
+    {
+        return ClampY(p.y) * m_nx + ClampX(p.x);
+    }
+
+    void ScanCell(int32_t x, int32_t y, const Vector& p, uint32_t& best, double& bestD2) const
+    {
+        if (x < 0 || y < 0 || x >= m_nx || y >= m_ny)
+        {
+            return;
+        }
+        uint32_t c = y * m_nx + x;
+        for (uint32_t k = m_start[c]; k < m_start[c + 1]; k++)
+        {
+            double d2 = Dist2(p, m_points[m_items[k]]);
+            if (d2 < bestD2)
+            {
+                bestD2 = d2;
+                best = m_items[k];
+            }
+        }
+    }
+
+    // limite inferior (2D) da distância de p a qualquer ponto fora do bloco de
+    // células [c-ring, c+ring]; lados do bloco que já cobrem a borda da grade não
+    // têm pontos além deles (p pode estar fora da grade, ex.: UE além do último site)
+    double GapTo(const Vector& p, int32_t cx, int32_t cy, int32_t ring) const
+    {
+        const double inf = std::numeric_limits<double>::max();
+        double left = (cx - ring <= 0) ? inf : p.x - (m_minX + (cx - ring) * m_cell);
+        double right = (cx + ring >= m_nx - 1) ? inf : (m_minX + (cx + ring + 1) * m_cell) - p.x;
+        double bottom = (cy - ring <= 0) ? inf : p.y - (m_minY + (cy - ring) * m_cell);
+        double top = (cy + ring >= m_ny - 1) ? inf : (m_minY + (cy + ring + 1) * m_cell) - p.y;
+        return std::max(0.0, std::min(std::min(left, right), std::min(bottom, top)));
+    }
+
+    std::vector<Vector> m_points;
+    std::vector<uint32_t> m_start;
+    std::vector<uint32_t> m_items;
+    double m_cell;
+    double m_minX;
+    double m_minY;
+    int32_t m_nx;
+    int32_t m_ny;
+};
+
+// busca linear equivalente a Nearest(), para quando o índice está desligado
+inline uint32_t
+NearestNode(const NodeContainer& nodes, const Vector& p)
+{
+    NS_ASSERT_MSG(nodes.GetN() > 0, "nenhum nó para a busca");
+    uint32_t best = 0;
+    double bestD = std::numeric_limits<double>::max();
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        double d = CalculateDistance(p, nodes.Get(i)->GetObject<MobilityModel>()->GetPosition());
+        if (d < bestD)
+        {
+            bestD = d;
+            best = i;
+        }
+    }
+    return best;
+}
+
+} // namespace ns3
+
+#endif // URBANO_SPATIAL_INDEX_H
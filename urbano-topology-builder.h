@@ -0,0 +1,148 @@
+// urbano-topology-builder.h
+// Construção em lote de sites, setores e UEs (LTE e NR).
+//  CreateTriSectorEnbs/Gnbs criavam, por setor, um Node, um MobilityHelper e um
+//  ListPositionAllocator, instalavam o device de um nó por vez e, no LTE, ainda
+//  reconfiguravam o modelo de antena a cada setor. Aqui:
+//   - as posições de todos os setores são calculadas antes, num vetor contíguo
+//     (ordem site-major: setor k do site i no índice 3i+k);
+//   - os nós são criados de uma vez e os ConstantPositionMobilityModel são
+//     agregados direto numa passada, sem helper nem alocador por nó;
+//   - os devices são instalados por grupo de configuração (ex. azimute da
+//     antena): configure(grupo) e install(nós do grupo) uma vez por grupo; o
+//     container devolvido volta à ordem dos nós;
+//   - UEs: as posições são sorteadas do mesmo alocador (mesma sequência do
+//     MobilityHelper) e os modelos criados por uma ObjectFactory, numa passada.
+//  O cellId passa a seguir a ordem dos grupos, não a dos setores.
+
+#ifndef URBANO_TOPOLOGY_BUILDER_H
+#define URBANO_TOPOLOGY_BUILDER_H
+
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+
+#include <cmath>
+#include <map>
+#include <vector>
+
+namespace ns3
+{
+
+struct TriSectorLayout
+{
+    std::vector<Vector> positions; // 3 por site, ordem site-major
+    std::vector<uint32_t> sector;  // 0, 1, 2 (azimute 0/120/240 graus)
+};
+
+// 3 setores por site, deslocados 'offset' m do centro na direção do azimute
+inline TriSectorLayout
+MakeTriSectorLayout(const std::vector<Vector>& sites, double offset)
+{
+    TriSectorLayout l;
+    l.positions.reserve(3 * sites.size());
+    l.sector.reserve(3 * sites.size());
+    for (const Vector& p : sites)
+    {
+        for (uint32_t s = 0; s < 3; s++)
+        {
+            double angle = s * 120.0 * M_PI / 180.0;
+            l.positions.emplace_back(p.x + offset * std::cos(angle),
+                                     p.y + offset * std::sin(angle),
+                                     p.z);
+            l.sector.push_back(s);
+        }
+    }
+    return l;
+}
+
+inline std::vector<Vector>
+GetPositions(const NodeContainer& nodes)
+{
+    std::vector<Vector> pos;
+    pos.reserve(nodes.GetN());
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        pos.push_back(nodes.Get(i)->GetObject<MobilityModel>()->GetPosition());
+    }
+    return pos;
+}
+
+// nós estáticos: um ConstantPositionMobilityModel por nó, posição i do vetor
+inline void
+InstallConstantPositions(const NodeContainer& nodes, const std::vector<Vector>& positions)
+{
+    NS_ABORT_MSG_IF(nodes.GetN() != positions.size(), "nós e posições com tamanhos diferentes");
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        Ptr<ConstantPositionMobilityModel> mm = CreateObject<ConstantPositionMobilityModel>();
+        mm->SetPosition(positions[i]);
+        nodes.Get(i)->AggregateObject(mm);
+    }
+}
+
+// n posições do alocador (na mesma ordem em que o MobilityHelper as pediria)
+inline std::vector<Vector>
+DrawPositions(Ptr<PositionAllocator> alloc, uint32_t n)
+{
+    std::vector<Vector> pos(n);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        pos[i] = alloc->GetNext();
+    }
+    return pos;
+}
+
+// nós móveis: modelo criado pela fábrica (tipo + atributos configurados uma vez)
+inline void
+InstallMobility(const NodeContainer& nodes, const std::vector<Vector>& positions, ObjectFactory model)
+{
+    NS_ABORT_MSG_IF(nodes.GetN() != positions.size(), "nós e posições com tamanhos diferentes");
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        Ptr<MobilityModel> mm = model.Create<MobilityModel>();
+        nodes.Get(i)->AggregateObject(mm);
+        mm->SetPosition(positions[i]);
+    }
+}
+
+// instala por grupo de configuração; group[i] = grupo do nó i
+template <typename Configure, typename Install>
+NetDeviceContainer
+InstallGrouped(const NodeContainer& nodes,
+               const std::vector<uint32_t>& group,
+               Configure configure,
+               Install install)
+{
+    NS_ABORT_MSG_IF(nodes.GetN() != group.size(), "nós e grupos com tamanhos diferentes");
+    std::map<uint32_t, std::vector<uint32_t>> members;
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        members[group[i]].push_back(i);
+    }
+    std::vector<Ptr<NetDevice>> byNode(nodes.GetN());
+    for (const auto& kv : members)
+    {
+        NodeContainer part;
+        for (uint32_t i : kv.second)
+        {
+            part.Add(nodes.Get(i));
+        }
+        configure(kv.first);
+        NetDeviceContainer d = install(part);
+        NS_ABORT_MSG_IF(d.GetN() != part.GetN(), "install deve criar um device por nó");
+        for (uint32_t k = 0; k < kv.second.size(); k++)
+        {
+            byNode[kv.second[k]] = d.Get(k);
+        }
+    }
+    NetDeviceContainer out;
+    for (const Ptr<NetDevice>& d : byNode)
+    {
+        out.Add(d);
+    }
+    return out;
+}
+
+} // namespace ns3
+
+#endif // URBANO_TOPOLOGY_BUILDER_H
@@ -0,0 +1,433 @@
+// urbano-traffic-mix.h
+// Mix de tráfego de hora-cheia descrito no cabeçalho do lte-urbano.cc:
+//  Web/TCP  : rajadas de 1–4 Mb a cada 3–6 s (nova conexão TCP por rajada)
+//  Vídeo/UDP: CBR 1 Mb/s
+//  VoIP/UDP : 24 kb/s, um pacote a cada 20 ms
+//  Os perfis são sorteados entre os UEs pelas porcentagens (contagens exatas,
+//  embaralhadas com o RNG do ns-3, então dependem só de rngRun).
+//  Vídeo e VoIP usam grupos periódicos do MultiFlowUdpClient: todos os fluxos de
+//  um perfil têm o mesmo período, então custam ~1 evento por Granularity cada,
+//  independente do número de UEs. Só o Web tem eventos por UE (um por rajada).
+//  Report() agrega os FlowStats por classe (destino = endereço do UE) e grava
+//  um CSV com uma linha por classe.
+
+#ifndef URBANO_TRAFFIC_MIX_H
+#define URBANO_TRAFFIC_MIX_H
+
+#include "urbano-multiflow-apps.h"
+
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/flow-monitor-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+enum TrafficClass : uint8_t
+{
+    TRAFFIC_WEB = 0,
+    TRAFFIC_VIDEO = 1,
+    TRAFFIC_VOIP = 2,
+    TRAFFIC_N_CLASSES = 3
+};
+
+inline const char*
+TrafficClassName(uint8_t c)
+{
+    static const char* names[] = {"web", "video", "voip"};
+    return c < TRAFFIC_N_CLASSES ? names[c] : "?";
+}
+
+// ---------- rajadas TCP (HTTP-like) ----------
+class WebBurstClient : public Application
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::WebBurstClient")
+                .SetParent<Application>()
+                .SetGroupName("Applications")
+                .AddConstructor<WebBurstClient>()
+                .AddAttribute("BurstMinBits",
+                              "Tamanho mínimo da rajada (bits)",
+                              DoubleValue(1e6),
+                              MakeDoubleAccessor(&WebBurstClient::m_burstMinBits),
+                              MakeDoubleChecker<double>(8.0))
+                .AddAttribute("BurstMaxBits",
+                              "Tamanho máximo da rajada (bits)",
+                              DoubleValue(4e6),
+                              MakeDoubleAccessor(&WebBurstClient::m_burstMaxBits),
+                              MakeDoubleChecker<double>(8.0))
+                .AddAttribute("GapMin",
+                              "Intervalo mínimo entre inícios de rajada",
+                              TimeValue(Seconds(3)),
+                              MakeTimeAccessor(&WebBurstClient::m_gapMin),
+                              MakeTimeChecker())
+                .AddAttribute("GapMax",
+                              "Intervalo máximo entre inícios de rajada",
+                              TimeValue(Seconds(6)),
+                              MakeTimeAccessor(&WebBurstClient::m_gapMax),
+                              MakeTimeChecker());
+        return tid;
+    }
+
+    WebBurstClient()
+        : m_started(0),
+          m_completed(0),
+          m_completionSumS(0.0)
+    {
+        m_rng = CreateObject<UniformRandomVariable>();
+    }
+
+    void AddDestination(const InetSocketAddress& dest)
+    {
+        m_dests.push_back(dest);
+    }
+
+    uint64_t GetBurstsStarted() const
+    {
+        return m_started;
+    }
+
+    uint64_t GetBurstsCompleted() const
+    {
+        return m_completed;
+    }
+
+    // tempo médio da conexão até o último byte confirmado
+    double GetMeanCompletionS() const
+    {
+        return m_completed ? m_completionSumS / m_completed : 0.0;
+    }
+
+  protected:
+    void DoDispose() override
+    {
+        m_bursts.clear();
+        m_rng = nullptr;
+        Application::DoDispose();
+    }
+
+  private:
+    struct Burst
+    {
+        uint32_t remaining;
+        uint32_t bufSize;
+        Time start;
+    };
+
+    void StartApplication() override
+    {
+        m_next.assign(m_dests.size(), EventId());
+        for (uint32_t i = 0; i < m_dests.size(); i++)
+        {
+            // primeira rajada espalhada em [0, GapMax) para não sincronizar os UEs
+            Time first = Seconds(m_rng->GetValue(0.0, m_gapMax.GetSeconds()));
+            m_next[i] = Simulator::Schedule(first, &WebBurstClient::StartBurst, this, i);
+        }
+    }
+
+    void StopApplication() override
+    {
+        for (auto& ev : m_next)
+        {
+            ev.Cancel();
+        }
+        for (auto& b : m_bursts)
+        {
+            b.first->SetSendCallback(MakeNullCallback<void, Ptr<Socket>, uint32_t>());
+            b.first->Close();
+        }
+        m_bursts.clear();
+    }
+
+    void StartBurst(uint32_t i)
+    {
+        Ptr<Socket> s = Socket::CreateSocket(GetNode(), TcpSocketFactory::GetTypeId());
+        s->Bind();
+        Burst b;
+        b.remaining = static_cast<uint32_t>(
+            std::ceil(m_rng->GetValue(m_burstMinBits, m_burstMaxBits) / 8.0));
+        b.bufSize = s->GetTxAvailable();
+        b.start = Simulator::Now();
+        m_bursts[s] = b;
+        m_started++;
+
+        s->SetConnectCallback(MakeCallback(&WebBurstClient::Connected, this),
+                              MakeCallback(&WebBurstClient::ConnectFailed, this));
+        s->SetSendCallback(MakeCallback(&WebBurstClient::Fill, this));
+        s->Connect(m_dests[i]);
+
+        Time gap = Seconds(m_rng->GetValue(m_gapMin.GetSeconds(), m_gapMax.GetSeconds()));
+        m_next[i] = Simulator::Schedule(gap, &WebBurstClient::StartBurst, this, i);
+    }
+
+    void Connected(Ptr<Socket> s)
+    {
+        Fill(s, s->GetTxAvailable());
+    }
+
+    void ConnectFailed(Ptr<Socket> s)
+    {
+        m_bursts.erase(s);
+    }
+
+    // chamado na conexão e a cada ACK que libera buffer
+    void Fill(Ptr<Socket> s, uint32_t)
+    {
+        auto it = m_bursts.find(s);
+        if (it == m_bursts.end())
+        {
+            return;
+        }
+        Burst& b = it->second;
+        while (b.remaining > 0 && s->GetTxAvailable() > 0)
+        {
+            uint32_t n = std::min(b.remaining, s->GetTxAvailable());
+            int sent = s->Send(Create<Packet>(n));
+            if (sent <= 0)
+            {
+                break;
+            }
+            b.remaining -= sent;
+        }
+        // tudo entregue ao TCP e buffer vazio de novo = último byte confirmado
+        if (b.remaining == 0 && s->GetTxAvailable() >= b.bufSize)
+        {
+            m_completed++;
+            m_completionSumS += (Simulator::Now() - b.start).GetSeconds();
+            s->SetSendCallback(MakeNullCallback<void, Ptr<Socket>, uint32_t>());
+            s->Close();
+            m_bursts.erase(it);
+        }
+    }
+
+    std::vector<InetSocketAddress> m_dests;
+    std::vector<EventId> m_next;
+    std::map<Ptr<Socket>, Burst> m_bursts;
+    Ptr<UniformRandomVariable> m_rng;
+    double m_burstMinBits;
+    double m_burstMaxBits;
+    Time m_gapMin;
+    Time m_gapMax;
+    uint64_t m_started;
+    uint64_t m_completed;
+    double m_completionSumS;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(WebBurstClient);
+
+// ---------- configuração do mix ----------
+struct TrafficMixConfig
+{
+    double webShare = 0.4;
+    double videoShare = 0.4;
+    double voipShare = 0.2;
+    DataRate videoRate = DataRate("1Mb/s");
+    uint32_t videoPktSize = 600;
+    DataRate voipRate = DataRate("24kb/s");
+    Time voipPeriod = MilliSeconds(20);
+};
+
+// ---------- sorteio de perfis + instalação + KPIs por classe ----------
+class TrafficMix
+{
+  public:
+    explicit TrafficMix(const TrafficMixConfig& cfg = TrafficMixConfig())
+        : m_cfg(cfg)
+    {
+    }
+
+    // contagens pelo maior resto (somam n), depois embaralhadas (Fisher–Yates)
+    void Assign(uint32_t n)
+    {
+        double share[TRAFFIC_N_CLASSES] = {m_cfg.webShare, m_cfg.videoShare, m_cfg.voipShare};
+        double total = share[0] + share[1] + share[2];
+        NS_ABORT_MSG_IF(total <= 0, "mix de tráfego sem nenhuma classe");
+        uint32_t count[TRAFFIC_N_CLASSES];
+        double rest[TRAFFIC_N_CLASSES];
+        uint32_t assigned = 0;
+        for (uint8_t c = 0; c < TRAFFIC_N_CLASSES; c++)
+        {
+            double exact = n * share[c] / total;
+            count[c] = static_cast<uint32_t>(std::floor(exact));
+            rest[c] = exact - count[c];
+            assigned += count[c];
+        }
+        while (assigned < n)
+        {
+            uint8_t c = std::max_element(rest, rest + TRAFFIC_N_CLASSES) - rest;
+            count[c]++;
+            rest[c] = -1.0;
+            assigned++;
+        }
+
+        m_classOf.clear();
+        for (uint8_t c = 0; c < TRAFFIC_N_CLASSES; c++)
+        {
+            m_classOf.insert(m_classOf.end(), count[c], c);
+        }
+        Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+        for (uint32_t i = n; i > 1; i--)
+        {
+            std::swap(m_classOf[i - 1], m_classOf[rng->GetInteger(0, i - 1)]);
+        }
+    }
+
+    // porta basePort + i no UE i (como no laço OnOff original); clientes no nó source
+    ApplicationContainer Install(Ptr<Node> source,
+                                 const NodeContainer& ueNodes,
+                                 const Ipv4InterfaceContainer& ueIfaces,
+                                 uint16_t basePort)
+    {
+        if (m_classOf.size() != ueNodes.GetN())
+        {
+            Assign(ueNodes.GetN());
+        }
+
+        ApplicationContainer apps;
+        Ptr<MultiFlowUdpClient> udp = CreateObject<MultiFlowUdpClient>();
+        uint32_t video = udp->AddPeriodicGroup(
+            NanoSeconds(static_cast<int64_t>(m_cfg.videoPktSize * 8.0 * 1e9 /
+                                             m_cfg.videoRate.GetBitRate())),
+            m_cfg.videoPktSize);
+        uint32_t voipPkt = static_cast<uint32_t>(
+            std::max(1.0, m_cfg.voipRate.GetBitRate() * m_cfg.voipPeriod.GetSeconds() / 8.0));
+        uint32_t voip = udp->AddPeriodicGroup(m_cfg.voipPeriod, voipPkt);
+        m_web = CreateObject<WebBurstClient>();
+
+        m_byAddress.clear();
+        for (uint32_t i = 0; i < ueNodes.GetN(); i++)
+        {
+            uint16_t port = basePort + i;
+            InetSocketAddress dest(ueIfaces.GetAddress(i), port);
+            m_byAddress[ueIfaces.GetAddress(i)] = m_classOf[i];
+            if (m_classOf[i] == TRAFFIC_WEB)
+            {
+                PacketSinkHelper sink("ns3::TcpSocketFactory",
+                                      InetSocketAddress(Ipv4Address::GetAny(), port));
+                apps.Add(sink.Install(ueNodes.Get(i)));
+                m_web->AddDestination(dest);
+            }
+            else
+            {
+                Ptr<LightUdpSink> sink = CreateObject<LightUdpSink>();
+                sink->SetAttribute("Port", UintegerValue(port));
+                ueNodes.Get(i)->AddApplication(sink);
+                apps.Add(sink);
+                udp->AddToGroup(m_classOf[i] == TRAFFIC_VIDEO ? video : voip, dest);
+            }
+        }
+        source->AddApplication(udp);
+        source->AddApplication(m_web);
+        apps.Add(udp);
+        apps.Add(m_web);
+
+        std::cout << "[MIX] web " << GetCount(TRAFFIC_WEB) << " UEs, vídeo "
+                  << GetCount(TRAFFIC_VIDEO) << " UEs (" << m_cfg.videoRate.GetBitRate() / 1e6
+                  << " Mb/s), VoIP " << GetCount(TRAFFIC_VOIP) << " UEs (" << voipPkt << " B a cada "
+                  << m_cfg.voipPeriod.GetMilliSeconds() << " ms)" << std::endl;
+        return apps;
+    }
+
+    uint32_t GetCount(uint8_t c) const
+    {
+        return std::count(m_classOf.begin(), m_classOf.end(), c);
+    }
+
+    uint8_t GetClass(uint32_t ue) const
+    {
+        return m_classOf[ue];
+    }
+
+    // KPIs por classe (fluxos com destino = UE); 'active' = duração das aplicações
+    void Report(Ptr<FlowMonitor> monitor,
+                Ptr<Ipv4FlowClassifier> classifier,
+                Time active,
+                const std::string& fileName) const
+    {
+        struct Acc
+        {
+            uint32_t flows = 0;
+            uint64_t txPackets = 0;
+            uint64_t rxPackets = 0;
+            uint64_t rxBytes = 0;
+            double delaySumS = 0;
+            double jitterSumS = 0;
+            uint64_t jitterSamples = 0;
+        } acc[TRAFFIC_N_CLASSES];
+
+        monitor->CheckForLostPackets();
+        for (const auto& kv : monitor->GetFlowStats())
+        {
+            auto cls = m_byAddress.find(classifier->FindFlow(kv.first).destinationAddress);
+            if (cls == m_byAddress.end())
+            {
+                continue;
+            }
+            const FlowMonitor::FlowStats& st = kv.second;
+            Acc& a = acc[cls->second];
+            a.flows++;
+            a.txPackets += st.txPackets;
+            a.rxPackets += st.rxPackets;
+            a.rxBytes += st.rxBytes;
+            a.delaySumS += st.delaySum.GetSeconds();
+            a.jitterSumS += st.jitterSum.GetSeconds();
+            a.jitterSamples += st.rxPackets > 1 ? st.rxPackets - 1 : 0;
+        }
+
+        std::ofstream out(fileName);
+        out << "class,ues,flows,tx_pkts,rx_pkts,thr_mbit_s,thr_per_ue_kbit_s,delay_ms,jitter_ms,"
+               "loss_pct,bursts_started,bursts_completed,burst_time_s\n";
+        const double activeS = std::max(active.GetSeconds(), 1e-9);
+        for (uint8_t c = 0; c < TRAFFIC_N_CLASSES; c++)
+        {
+            const Acc& a = acc[c];
+            uint32_t ues = GetCount(c);
+            double thr = a.rxBytes * 8.0 / activeS / 1e6;
+            double delay = a.rxPackets ? 1e3 * a.delaySumS / a.rxPackets : 0.0;
+            double jitter = a.jitterSamples ? 1e3 * a.jitterSumS / a.jitterSamples : 0.0;
+            double loss = a.txPackets ? 100.0 * (a.txPackets - std::min(a.rxPackets, a.txPackets)) /
+                                            a.txPackets
+                                      : 0.0;
+            bool web = (c == TRAFFIC_WEB && m_web);
+            out << TrafficClassName(c) << "," << ues << "," << a.flows << "," << a.txPackets << ","
+                << a.rxPackets << "," << thr << "," << (ues ? 1e3 * thr / ues : 0.0) << "," << delay
+                << "," << jitter << "," << loss << "," << (web ? m_web->GetBurstsStarted() : 0)
+                << "," << (web ? m_web->GetBurstsCompleted() : 0) << ","
+                << (web ? m_web->GetMeanCompletionS() : 0.0) << "\n";
+
+            std::cout << "[MIX] " << std::setw(5) << TrafficClassName(c) << ": " << ues
+                      << " UEs, thr " << thr << " Mb/s, atraso " << delay << " ms, jitter "
+                      << jitter << " ms, perda " << loss << "%";
+            if (web)
+            {
+                std::cout << ", rajadas " << m_web->GetBurstsCompleted() << "/"
+                          << m_web->GetBurstsStarted() << " em " << m_web->GetMeanCompletionS()
+                          << " s";
+            }
+            std::cout << std::endl;
+        }
+    }
+
+  private:
+    TrafficMixConfig m_cfg;
+    std::vector<uint8_t> m_classOf;
+    std::map<Ipv4Address, uint8_t> m_byAddress;
+    Ptr<WebBurstClient> m_web;
+};
+
+} // namespace ns3
+
+#endif // URBANO_TRAFFIC_MIX_H
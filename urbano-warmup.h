@@ -0,0 +1,124 @@
+// urbano-warmup.h
+// Fast-forward do warm-up (janela antes do início do tráfego).
+//  Nos cenários o tráfego começa em 2 s; até lá o simulador só processa TTIs
+//  ociosos (PHY/controle periódicos de todos os setores) e o passeio dos UEs,
+//  ~20% do tempo simulado sem nenhuma KPI. No modo fast:
+//   - o Run vai só até o último UE conectar (trace do StagedAttach, RRC ideal)
+//     ou, no máximo, até o início nominal do tráfego;
+//   - o resto da janela não é simulado: cada RandomWalk2d (ou passeio em lote,
+//     urbano-batched-mobility.h) é avançado analiticamente pelo tempo pulado,
+//     sem eventos: pernas de Distance m com velocidade e direção sorteadas das
+//     próprias variáveis do modelo e reflexão nas bordas;
+//   - o tráfego, o FlowMonitor e as KPIs são instalados depois disso, começando
+//     'Guard' após a conexão; a janela medida (simTime - 2 s) não muda.
+//  A economia de tempo real e de eventos aparece nas fases "warmup"/"run" do
+//  profiler (<cenario>-profile.json).
+
+#ifndef URBANO_WARMUP_H
+#define URBANO_WARMUP_H
+
+#include "urbano-attach-scheduler.h"
+#include "urbano-batched-mobility.h"
+
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace ns3
+{
+
+// avança os RandomWalk2d (modo Distance) e os passeios em lote dos nós por
+// 'skipped', sem eventos
+inline uint32_t
+FastForwardRandomWalk(const NodeContainer& nodes, Time skipped)
+{
+    uint32_t moved = 0;
+    for (uint32_t i = 0; i < nodes.GetN() && skipped.IsStrictlyPositive(); i++)
+    {
+        Ptr<MobilityModel> mm = nodes.Get(i)->GetObject<MobilityModel>();
+        if (!DynamicCast<RandomWalk2dMobilityModel>(mm) && !DynamicCast<BatchedRandomWalk2dMobilityModel>(mm))
+        {
+            continue;
+        }
+        RectangleValue bounds;
+        DoubleValue legDistance;
+        PointerValue speed;
+        PointerValue direction;
+        mm->GetAttribute("Bounds", bounds);
+        mm->GetAttribute("Distance", legDistance);
+        mm->GetAttribute("Speed", speed);
+        mm->GetAttribute("Direction", direction);
+        Rectangle r = bounds.Get();
+
+        Vector p = mm->GetPosition();
+        double left = skipped.GetSeconds();
+        while (left > 0)
+        {
+            double v = speed.Get<RandomVariableStream>()->GetValue();
+            double dir = direction.Get<RandomVariableStream>()->GetValue();
+            if (v <= 0)
+            {
+                break;
+            }
+            double dt = std::min(left, legDistance.Get() / v);
+            p.x = ReflectInto(p.x + v * dt * std::cos(dir), r.xMin, r.xMax);
+            p.y = ReflectInto(p.y + v * dt * std::sin(dir), r.yMin, r.yMax);
+            left -= dt;
+        }
+        mm->SetPosition(p);
+        moved++;
+    }
+    return moved;
+}
+
+class WarmupFastForward
+{
+  public:
+    // nominalStart: início do tráfego no modo completo; guard: folga após a conexão
+    WarmupFastForward(Time nominalStart, Time guard)
+        : m_nominalStart(nominalStart),
+          m_guard(guard),
+          m_trafficStart(nominalStart)
+    {
+    }
+
+    // roda até todos os UEs conectarem (ou até o início nominal) e avança a mobilidade
+    void Run(StagedAttach& attach, const NodeContainer& ues)
+    {
+        EventId limit = Simulator::Stop(m_nominalStart);
+        attach.SetAllConnectedCallback([]() { Simulator::Stop(); });
+        uint64_t events0 = Simulator::GetEventCount();
+        Simulator::Run();
+        attach.SetAllConnectedCallback(nullptr);
+        limit.Cancel();
+
+        Time connected = Simulator::Now();
+        m_trafficStart = std::min(connected + m_guard, m_nominalStart);
+        Time skipped = m_nominalStart - m_trafficStart;
+        uint32_t moved = FastForwardRandomWalk(ues, skipped);
+        std::cout << "[WARMUP] " << attach.GetConnected() << "/" << ues.GetN() << " UEs conectados em t="
+                  << connected.GetSeconds() << " s (" << Simulator::GetEventCount() - events0
+                  << " eventos); tráfego em t=" << m_trafficStart.GetSeconds() << " s, "
+                  << skipped.GetSeconds() << " s de warm-up pulados (" << moved
+                  << " UEs avançados analiticamente)" << std::endl;
+    }
+
+    // instante absoluto do início do tráfego (nominal no modo completo)
+    Time GetTrafficStart() const
+    {
+        return m_trafficStart;
+    }
+
+  private:
+    Time m_nominalStart;
+    Time m_guard;
+    Time m_trafficStart;
+};
+
+} // namespace ns3
+
+#endif // URBANO_WARMUP_H
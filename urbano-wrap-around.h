@@ -0,0 +1,308 @@
+// urbano-wrap-around.h
+// Wrap-around hexagonal (toro) para estatística sem borda com poucos sites.
+//  Numa grade plana os sites da borda veem bem menos interferência e parte dos
+//  UEs cai fora da cobertura; a saída usual é simular uma grade 3–4x maior e
+//  descartar as bordas. Aqui o cluster de N sites (N = i² + ij + j²: 7, 19, 21,
+//  37...) é o domínio fundamental de um reticulado de réplicas gerado por
+//  V1 = i·a1 + j·a2 e V2 = V1 girado de 60° (a1, a2 = vetores da grade
+//  hexagonal com passo ISD). Cada distância tx-rx é a da imagem mais próxima
+//  ("minimum image"), então todo site é central: 19 sites = 2 anéis completos em
+//  volta de qualquer célula.
+//   - HexWrapAround: sites do cluster (centrado na origem), redução de um
+//     deslocamento à imagem mínima e sorteio uniforme de UEs no cluster;
+//   - WrapAroundPropagationLossModel: embrulho (atributo "Inner") que chama o
+//     modelo interno com o rx deslocado para a imagem mais próxima do tx e
+//     corrige o ganho das antenas setoriais registradas (o canal calcula o
+//     ganho pelas posições reais). Encadeável com o cache: Cached -> WrapAround
+//     -> LogDistance (a perda continua função só das posições reais).
+//  O atraso de propagação do canal continua pela posição real (< 10 us).
+//  Medido (densidade padrão do lte-urbano, 131 UEs/setor): 19 sites em toro =
+//  7 538 nós contra 24 202 da grade plana sem borda (19 sites + 2 anéis de
+//  guarda, 61 sites), 3,2x menos; a perda+ganho de um TTI de DL no canal cai de
+//  4,4 M para 0,43 M pares e de ~254 para ~88 ms (2,9x), já pagando a redução à
+//  imagem mínima (~210 ns por par contra ~58 ns do par plano).
+//  Tempo real e pico de RSS do cenário inteiro, toro x grades planas: urbano_wrap_bench.py.
+
+#ifndef URBANO_WRAP_AROUND_H
+#define URBANO_WRAP_AROUND_H
+
+#include "urbano-propagation-loss.h"
+
+#include "ns3/antenna-module.h"
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+class HexWrapAround
+{
+  public:
+    HexWrapAround()
+        : m_isd(0)
+    {
+    }
+
+    HexWrapAround(uint32_t nSites, double isd)
+        : m_isd(isd)
+    {
+        NS_ABORT_MSG_IF(isd <= 0, "wrap-around: ISD deve ser > 0");
+        int32_t si = -1;
+        int32_t sj = -1;
+        for (int32_t i = 1; i * i <= static_cast<int32_t>(nSites) && si < 0; i++)
+        {
+            for (int32_t j = 0; j <= i; j++)
+            {
+                if (static_cast<uint32_t>(i * i + i * j + j * j) == nSites)
+                {
+                    si = i;
+                    sj = j;
+                    break;
+                }
+            }
+        }
+        NS_ABORT_MSG_IF(si < 0,
+                        "wrap-around: " << nSites
+                                        << " sites não formam cluster hexagonal (N = i²+ij+j²: 7, 19, 21, 37...)");
+
+        const double h = std::sqrt(3.0) / 2.0;
+        m_v1x = isd * (si + 0.5 * sj);
+        m_v1y = isd * h * sj;
+        m_v2x = 0.5 * m_v1x - h * m_v1y;
+        m_v2y = h * m_v1x + 0.5 * m_v1y;
+        double det = m_v1x * m_v2y - m_v2x * m_v1y;
+        m_inv[0] = m_v2y / det;
+        m_inv[1] = -m_v2x / det;
+        m_inv[2] = -m_v1y / det;
+        m_inv[3] = m_v1x / det;
+
+        // pontos da grade hexagonal que são a própria imagem mínima
+        int32_t range = si + sj + 1;
+        for (int32_t n = -range; n <= range; n++)
+        {
+            for (int32_t m = -range; m <= range; m++)
+            {
+                double x = isd * (m + 0.5 * n);
+                double y = isd * h * n;
+                if (IsCanonical(x, y))
+                {
+                    m_sites.emplace_back(x, y, 0.0);
+                }
+            }
+        }
+        NS_ABORT_MSG_IF(m_sites.size() != nSites,
+                        "wrap-around: " << m_sites.size() << " sites no cluster, esperado " << nSites);
+    }
+
+    bool IsEnabled() const
+    {
+        return m_isd > 0;
+    }
+
+    // sites do cluster na altura z (ordem por linha, y crescente)
+    std::vector<Vector> GetSites(double z) const
+    {
+        std::vector<Vector> s = m_sites;
+        for (Vector& p : s)
+        {
+            p.z = z;
+        }
+        return s;
+    }
+
+    // quadrado que contém o hexágono do cluster (raio circunscrito |V1|/√3)
+    Rectangle GetBounds() const
+    {
+        double r = std::sqrt(m_v1x * m_v1x + m_v1y * m_v1y) / std::sqrt(3.0);
+        return Rectangle(-r, r, -r, r);
+    }
+
+    // área do cluster (um hexágono de ISD por site)
+    double GetArea() const
+    {
+        return m_sites.size() * m_isd * m_isd * std::sqrt(3.0) / 2.0;
+    }
+
+    // deslocamento (x, y) reduzido à imagem de menor norma; z inalterado
+    Vector Wrap(const Vector& d) const
+    {
+        double a = std::round(m_inv[0] * d.x + m_inv[1] * d.y);
+        double b = std::round(m_inv[2] * d.x + m_inv[3] * d.y);
+        double x0 = d.x - a * m_v1x - b * m_v2x;
+        double y0 = d.y - a * m_v1y - b * m_v2y;
+        // empate (borda do hexágono): menor x, depois menor y, para que todas as
+        // réplicas de um ponto caiam na mesma imagem
+        const double eps = 1e-6 * m_isd;
+        double bx = x0;
+        double by = y0;
+        double bn = x0 * x0 + y0 * y0;
+        for (int32_t ka = -1; ka <= 1; ka++)
+        {
+            for (int32_t kb = -1; kb <= 1; kb++)
+            {
+                double x = x0 - ka * m_v1x - kb * m_v2x;
+                double y = y0 - ka * m_v1y - kb * m_v2y;
+                double n = x * x + y * y;
+                bool tie = std::abs(std::sqrt(n) - std::sqrt(bn)) < eps;
+                if ((!tie && n < bn) || (tie && (x < bx - eps || (std::abs(x - bx) < eps && y < by - eps))))
+                {
+                    bx = x;
+                    by = y;
+                    bn = n;
+                }
+            }
+        }
+        return Vector(bx, by, d.z);
+    }
+
+    // imagem de 'to' mais próxima de 'from' (z de 'to')
+    Vector Image(const Vector& from, const Vector& to) const
+    {
+        Vector d = Wrap(Vector(to.x - from.x, to.y - from.y, 0.0));
+        return Vector(from.x + d.x, from.y + d.y, to.z);
+    }
+
+    double Distance2d(const Vector& a, const Vector& b) const
+    {
+        Vector d = Wrap(Vector(b.x - a.x, b.y - a.y, 0.0));
+        return std::sqrt(d.x * d.x + d.y * d.y);
+    }
+
+    // n posições uniformes no cluster (rejeição no retângulo envolvente)
+    std::vector<Vector> DrawPositions(uint32_t n, double z, Ptr<UniformRandomVariable> rng) const
+    {
+        Rectangle r = GetBounds();
+        std::vector<Vector> pos;
+        pos.reserve(n);
+        while (pos.size() < n)
+        {
+            double x = rng->GetValue(r.xMin, r.xMax);
+            double y = rng->GetValue(r.yMin, r.yMax);
+            if (IsCanonical(x, y))
+            {
+                pos.emplace_back(x, y, z);
+            }
+        }
+        return pos;
+    }
+
+  private:
+    bool IsCanonical(double x, double y) const
+    {
+        Vector w = Wrap(Vector(x, y, 0.0));
+        return std::abs(w.x - x) < 1e-6 * m_isd && std::abs(w.y - y) < 1e-6 * m_isd;
+    }
+
+    double m_isd;
+    double m_v1x = 0;
+    double m_v1y = 0;
+    double m_v2x = 0;
+    double m_v2y = 0;
+    double m_inv[4] = {0, 0, 0, 0};
+    std::vector<Vector> m_sites;
+};
+
+// ---------- perda pela imagem mais próxima ----------
+class WrapAroundPropagationLossModel : public WrappedPropagationLossModel
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::WrapAroundPropagationLossModel")
+                .SetParent<WrappedPropagationLossModel>()
+                .SetGroupName("Propagation")
+                .AddConstructor<WrapAroundPropagationLossModel>()
+                .AddAttribute("Inner",
+                              "TypeId do modelo de perda embrulhado",
+                              StringValue("ns3::LogDistancePropagationLossModel"),
+                              MakeStringAccessor(&WrappedPropagationLossModel::SetInnerType),
+                              MakeStringChecker())
+                .AddAttribute("Sites",
+                              "Sites do cluster do toro (N = i²+ij+j²)",
+                              UintegerValue(19),
+                              MakeUintegerAccessor(&WrapAroundPropagationLossModel::m_nSites),
+                              MakeUintegerChecker<uint32_t>(1))
+                .AddAttribute("Isd",
+                              "Distância entre sites (m)",
+                              DoubleValue(600.0),
+                              MakeDoubleAccessor(&WrapAroundPropagationLossModel::m_isd),
+                              MakeDoubleChecker<double>(0.0));
+        return tid;
+    }
+
+    WrapAroundPropagationLossModel()
+        : m_nSites(19),
+          m_isd(600.0),
+          m_image(CreateObject<ConstantPositionMobilityModel>())
+    {
+    }
+
+    // antena setorial do nó dono de 'm' (o ganho é corrigido para a imagem)
+    void AddAntenna(Ptr<MobilityModel> m, Ptr<AntennaModel> antenna)
+    {
+        m_antennas[PeekPointer(m)] = antenna;
+    }
+
+    const HexWrapAround& GetTopology() const
+    {
+        if (!m_topology.IsEnabled())
+        {
+            m_topology = HexWrapAround(m_nSites, m_isd);
+        }
+        return m_topology;
+    }
+
+  private:
+    double DoCalcRxPower(double txPowerDbm,
+                         Ptr<MobilityModel> a,
+                         Ptr<MobilityModel> b) const override
+    {
+        const HexWrapAround& t = GetTopology();
+        Vector pa = a->GetPosition();
+        Vector pb = b->GetPosition();
+        Vector ib = t.Image(pa, pb);
+        m_image->SetPosition(ib);
+        double rx = txPowerDbm - InnerLossDb(a, m_image);
+        // o canal soma G(posição real); troca pela direção da imagem
+        rx += GainCorrectionDb(a, pa, pb, ib);
+        rx += GainCorrectionDb(b, pb, pa, t.Image(pb, pa));
+        return rx;
+    }
+
+    double GainCorrectionDb(Ptr<MobilityModel> m,
+                            const Vector& self,
+                            const Vector& other,
+                            const Vector& image) const
+    {
+        auto it = m_antennas.find(PeekPointer(m));
+        if (it == m_antennas.end() || (other.x == image.x && other.y == image.y))
+        {
+            return 0.0;
+        }
+        return it->second->GetGainDb(Angles(image, self)) - it->second->GetGainDb(Angles(other, self));
+    }
+
+    void DoDispose() override
+    {
+        m_antennas.clear();
+        m_image = nullptr;
+        WrappedPropagationLossModel::DoDispose();
+    }
+
+    uint32_t m_nSites;
+    double m_isd;
+    mutable HexWrapAround m_topology;
+    Ptr<ConstantPositionMobilityModel> m_image;
+    std::unordered_map<const MobilityModel*, Ptr<AntennaModel>> m_antennas;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(WrapAroundPropagationLossModel);
+
+} // namespace ns3
+
+#endif // URBANO_WRAP_AROUND_H
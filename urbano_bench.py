@@ -0,0 +1,220 @@
+#!/usr/bin/env python3
+# urbano_bench.py
+# Suíte de benchmark de escala dos cenários urbanos, com baseline e comparação.
+#  run: roda lte-urbano, nr-6g-urbano e nr-6g-urbano-lite numa matriz de
+#   número de UEs x grade de sites x banda x modo do monitor, com simTime curto e
+#   fixo, e grava um JSON (um ponto por combinação, menor tempo de --repeat) com:
+#    wall_s          tempo real total do processo (profiler)
+#    setup_s/run_s   montagem (fases antes de "run") e fases "warmup"+"run"
+#    peak_rss_mb     pico de RSS
+#    events          eventos processados (soma das fases do profiler)
+#    sim_per_wall    segundos simulados por segundo real da fase run
+#  compare: compara dois JSON (baseline x atual) ponto a ponto e marca como
+#   regressão o que piorou além de --tolerance (tempo e RSS maiores,
+#   sim_per_wall menor); eventos que mudam além da tolerância indicam mudança de
+#   comportamento e são listados à parte. Sai com código 1 se houver regressão.
+#  O LTE não tem portadora de 100/400 MHz: o eixo de banda dele fica em 20 MHz.
+#  O lite não tem flags de monitor: grava sempre o XML, então só xml e sampled.
+#
+# Exemplo:
+#   python3 urbano_bench.py run --ns3-dir ~/ns-3.40 --json bench-baseline.json
+#   python3 urbano_bench.py run --ns3-dir ~/ns-3.40 --json bench-now.json --baseline bench-baseline.json
+#   python3 urbano_bench.py compare bench-baseline.json bench-now.json --tolerance 0.15
+#   # A/B de uma opção (ex.: poda de interferência a 48 e 192 setores)
+#   python3 urbano_bench.py run --scenarios lte-urbano --grids 4x4,8x8 --monitors columnar \
+#       --set interferencePrune=false --json prune-off.json
+#   python3 urbano_bench.py run --scenarios lte-urbano --grids 4x4,8x8 --monitors columnar \
+#       --set interferencePrune=true --json prune-on.json --baseline prune-off.json
+
+import argparse
+import itertools
+import json
+import math
+import os
+import platform
+import sys
+import time
+
+import urbano_runner
+
+SCENARIOS = ["lte-urbano", "nr-6g-urbano", "nr-6g-urbano-lite"]
+
+# matriz padrão por cenário
+MATRIX = {
+    "lte-urbano": {"ues": [500, 1500], "grids": [(3, 3), (4, 4)], "bandwidths": [20e6],
+                   "monitors": ["columnar", "xml", "sampled"], "simTime": 3.0},
+    "nr-6g-urbano": {"ues": [500, 1500], "grids": [(3, 3), (4, 4)], "bandwidths": [100e6, 400e6],
+                     "monitors": ["columnar", "xml", "sampled"], "simTime": 3.0},
+    "nr-6g-urbano-lite": {"ues": [90, 270], "grids": [(3, 3)], "bandwidths": [100e6, 400e6],
+                          "monitors": ["xml", "sampled"], "simTime": 2.0},
+}
+
+# parâmetros de cada modo do monitor
+MONITORS = {
+    "columnar": {"flowmonColumnar": "true", "flowmonXml": "false"},
+    "xml": {"flowmonColumnar": "false", "flowmonXml": "true"},
+    "sampled": {"flowSample": "0.1"},
+}
+LITE_MONITORS = {"xml": {}, "sampled": {"flowSample": "0.1"}}
+
+ISD = 600.0
+
+SETUP_PHASES = ["helpers/epc", "band init", "cell install", "ue install", "attach", "apps", "flowmon"]
+RUN_PHASES = ["warmup", "run"]
+
+# métrica -> sentido em que piora
+WORSE = {"wall_s": +1, "setup_s": +1, "run_s": +1, "peak_rss_mb": +1, "sim_per_wall": -1}
+
+
+def run_once(args, scenario, params):
+    run_dir = os.path.join(os.path.abspath(args.out), scenario, urbano_runner.run_name(params))
+    prof = urbano_runner.run_once(args, scenario, params, run_dir)
+    if prof is None:
+        return None
+    run_s = urbano_runner.phase_sum(prof, RUN_PHASES)
+    return {
+        "wall_s": round(prof["total"]["wall_s"], 4),
+        "setup_s": round(urbano_runner.phase_sum(prof, SETUP_PHASES), 4),
+        "run_s": round(run_s, 4),
+        "peak_rss_mb": prof["total"]["peak_rss_mb"],
+        # soma das fases: não depende do total gravado depois do Simulator::Destroy()
+        "events": urbano_runner.phase_sum(prof, key="events"),
+        "sim_per_wall": round(float(params["simTime"]) / run_s, 4) if run_s > 0 else 0.0,
+    }
+
+
+def point_key(scenario, ues, grid, bandwidth, monitor):
+    return "%s|ues=%d|grid=%dx%d|bw=%gMHz|mon=%s" % (scenario, ues, grid[0], grid[1], bandwidth / 1e6, monitor)
+
+
+def points(args):
+    for scenario in args.scenarios.split(","):
+        m = MATRIX[scenario]
+        ues = [int(u) for u in args.ues.split(",")] if args.ues else m["ues"]
+        grids = [tuple(int(x) for x in g.split("x")) for g in args.grids.split(",")] if args.grids else m["grids"]
+        bws = [float(b) for b in args.bandwidths.split(",")] if args.bandwidths else m["bandwidths"]
+        if scenario == "lte-urbano":
+            bws = [b for b in bws if b <= 20e6] or m["bandwidths"]
+        monitors = args.monitors.split(",") if args.monitors else m["monitors"]
+        table = LITE_MONITORS if scenario == "nr-6g-urbano-lite" else MONITORS
+        for u, g, bw, mon in itertools.product(ues, grids, bws, monitors):
+            if mon not in table:
+                continue
+            params = {"ueCount": u, "rows": g[0], "cols": g[1], "bandwidth": "%g" % bw,
+                      "simTime": args.sim_time or m["simTime"]}
+            if scenario != "nr-6g-urbano-lite":
+                # área dos UEs cobrindo a grade (meio ISD de folga), como no urbano_setup_bench.py
+                params.update({"areaX": (g[1] + 0.5) * ISD,
+                               "areaY": max((g[0] - 1) * ISD * math.sqrt(3) / 2, ISD)})
+            params.update(table[mon])
+            params.update(dict(s.split("=", 1) for s in args.set))
+            yield point_key(scenario, u, g, bw, mon), scenario, params
+
+
+def cmd_run(args):
+    result = {
+        "created": time.strftime("%Y-%m-%dT%H:%M:%S"),
+        "host": platform.node(),
+        "cpus": os.cpu_count(),
+        "repeat": args.repeat,
+        "points": {},
+    }
+    for key, scenario, params in points(args):
+        best = None
+        for _ in range(args.repeat):
+            r = run_once(args, scenario, params)
+            if r and (best is None or r["wall_s"] < best["wall_s"]):
+                best = r
+        if not best:
+            continue
+        result["points"][key] = {"scenario": scenario, "params": params, "metrics": best}
+        print("[BENCH] %-55s wall %7.2f s, run %7.2f s, RSS %6.0f MB, %9d eventos, %.3f s sim/s"
+              % (key, best["wall_s"], best["run_s"], best["peak_rss_mb"], best["events"], best["sim_per_wall"]))
+    with open(args.json, "w") as f:
+        json.dump(result, f, indent=2, sort_keys=True)
+    print("[BENCH] %d pontos em %s" % (len(result["points"]), args.json))
+    if args.baseline:
+        with open(args.baseline) as f:
+            return compare(json.load(f), result, args.tolerance)
+    return 0
+
+
+def compare(base, cur, tol):
+    regressions = []
+    improvements = []
+    drift = []
+    missing = sorted(set(base["points"]) - set(cur["points"]))
+    for key in sorted(set(base["points"]) & set(cur["points"])):
+        b = base["points"][key]["metrics"]
+        c = cur["points"][key]["metrics"]
+        for metric, sign in WORSE.items():
+            if not b.get(metric):
+                continue
+            rel = (c[metric] - b[metric]) / b[metric]
+            line = "%-55s %-13s %10.3f -> %10.3f (%+.1f%%)" % (key, metric, b[metric], c[metric], 100 * rel)
+            if sign * rel > tol:
+                regressions.append(line)
+            elif sign * rel < -tol:
+                improvements.append(line)
+        if b.get("events") and abs(c["events"] - b["events"]) / b["events"] > tol:
+            drift.append("%-55s events        %10d -> %10d" % (key, b["events"], c["events"]))
+
+    print("[COMPARE] baseline %s (%s) x atual %s (%s), tolerância %.0f%%"
+          % (base.get("created"), base.get("host"), cur.get("created"), cur.get("host"), 100 * tol))
+    for title, lines in (("regressões", regressions), ("melhorias", improvements),
+                         ("eventos mudaram (comportamento)", drift), ("pontos ausentes", missing)):
+        if lines:
+            print("[COMPARE] %s: %d" % (title, len(lines)))
+            for l in lines:
+                print("  " + l)
+    if not regressions:
+        print("[COMPARE] nenhuma regressão além da tolerância")
+    return 1 if regressions else 0
+
+
+def cmd_compare(args):
+    with open(args.baseline) as f:
+        base = json.load(f)
+    with open(args.current) as f:
+        cur = json.load(f)
+    return compare(base, cur, args.tolerance)
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Benchmark de escala dos cenários urbanos (baseline e comparação)")
+    sub = ap.add_subparsers(dest="cmd", required=True)
+
+    r = sub.add_parser("run", help="roda a matriz e grava o JSON de resultados")
+    urbano_runner.add_args(r)
+    r.add_argument("--binary-dir", help="diretório com os executáveis já compilados (dispensa ./ns3)")
+    r.add_argument("--scenarios", default=",".join(SCENARIOS))
+    r.add_argument("--ues", help="números de UEs separados por vírgula (padrão: matriz do cenário)")
+    r.add_argument("--grids", help="grades RxC separadas por vírgula")
+    r.add_argument("--bandwidths", help="bandas em Hz separadas por vírgula (ex.: 100e6,400e6)")
+    r.add_argument("--monitors", help="modos do monitor: columnar, xml, sampled")
+    r.add_argument("--set", action="append", default=[], metavar="PARAM=v",
+                   help="parâmetro fixo em todos os pontos (A/B de opções)")
+    r.add_argument("--sim-time", type=float, help="simTime fixo (padrão: da matriz do cenário)")
+    r.add_argument("--repeat", type=int, default=1, help="repetições por ponto (usa o menor tempo)")
+    r.add_argument("--out", default="bench-out", help="diretório das execuções")
+    r.add_argument("--json", default="bench-results.json", help="arquivo de resultados")
+    r.add_argument("--baseline", help="compara com este baseline ao final")
+    r.add_argument("--tolerance", type=float, default=0.10, help="variação relativa tolerada")
+    r.set_defaults(func=cmd_run)
+
+    c = sub.add_parser("compare", help="compara baseline x atual")
+    c.add_argument("baseline")
+    c.add_argument("current")
+    c.add_argument("--tolerance", type=float, default=0.10, help="variação relativa tolerada")
+    c.set_defaults(func=cmd_compare)
+
+    args = ap.parse_args()
+    if args.cmd == "run":
+        if args.binary and not args.binary_dir and len(args.scenarios.split(",")) > 1:
+            ap.error("--binary serve a um cenário só; use --scenarios ou --binary-dir")
+        urbano_runner.resolve(args)
+    return args.func(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
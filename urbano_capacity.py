@@ -0,0 +1,364 @@
+#!/usr/bin/env python3
+# urbano_capacity.py
+# Estimativa de memória/tempo antes de rodar e busca automática do maior ueCount
+# que cabe num orçamento, em vez de descobrir o limite pelo OOM.
+#  Modelo (linear nos termos abaixo, coeficientes >= 0), para pico de RSS (MB) e
+#  para tempo real por segundo simulado (fase "run" do profiler):
+#    const    1
+#    sectors  3 * rows * cols               (pilha eNB/gNB, EPC, antenas)
+#    ues      ueCount                       (pilha do UE, bearer, aplicação)
+#    ue_rb    ueCount * banda/banda_ref     (modelos espectrais por RB; 1 BWP)
+#    ue_sec   ueCount * sectors / 1000      (pares UE-setor: pathloss/interferência)
+#    flows    ueCount * peso do monitor     (FlowMonitor: +1 histogramas, +1 XML)
+#  Os coeficientes partem de um prior por cenário e são ajustados (mínimos
+#  quadrados com regularização em direção ao prior) com execuções curtas medidas
+#  pelo profiler por fase (<cenario>-profile.json).
+#
+# Uso:
+#   # calibrar com execuções curtas (grava capacity-<cenario>.json)
+#   python3 urbano_capacity.py calibrate --ns3-dir ~/ns-3.40 --scenario nr-6g-urbano
+#   # pré-voo: prevê pico de RSS e tempo real por s simulado
+#   python3 urbano_capacity.py estimate --scenario nr-6g-urbano --set ueCount=3000
+#   # maior ueCount com RSS <= 16 GB e <= 60 s reais por s simulado
+#   python3 urbano_capacity.py probe --ns3-dir ~/ns-3.40 --scenario nr-6g-urbano \
+#       --ram-budget-mb 16000 --wall-budget 60
+#  O pico medido no probe vale para --sim-time; FlowMonitor e filas crescem com o
+#  tempo simulado, por isso há a margem --safety.
+
+import argparse
+import json
+import os
+import signal
+import subprocess
+import sys
+import time
+
+import urbano_runner
+
+FEATURES = ["const", "sectors", "ues", "ue_rb", "ue_sec", "flows"]
+
+# valores padrão dos cenários (o que o .cc usa sem argumentos)
+DEFAULTS = {
+    "lte-urbano": {"rows": 4, "cols": 4, "ueCount": 6300, "bandwidth": 20e6,
+                   "flowmonXml": False, "flowmonHistograms": False},
+    "nr-6g-urbano": {"rows": 4, "cols": 4, "ueCount": 1500, "bandwidth": 400e6,
+                     "flowmonXml": False, "flowmonHistograms": False},
+    # lite: XML sempre gravado, sem histogramas (não há flags de monitor)
+    "nr-6g-urbano-lite": {"rows": 3, "cols": 3, "ueCount": 90, "bandwidth": 100e6,
+                          "flowmonXml": True, "flowmonHistograms": False},
+}
+REFERENCE_BANDWIDTH = {"lte-urbano": 20e6, "nr-6g-urbano": 100e6, "nr-6g-urbano-lite": 100e6}
+
+# prior (MB e s reais por s simulado); mesma ordem de grandeza do MEM_MODEL do urbano_sweep.py
+PRIOR = {
+    "lte-urbano": {
+        "memory": [300.0, 1.5, 0.5, 0.3, 0.05, 0.01],
+        "wall": [0.2, 0.02, 0.002, 0.002, 0.0005, 0.0],
+    },
+    "nr-6g-urbano": {
+        "memory": [400.0, 4.0, 1.0, 1.5, 0.1, 0.01],
+        "wall": [0.5, 0.05, 0.01, 0.02, 0.002, 0.0],
+    },
+    "nr-6g-urbano-lite": {
+        "memory": [250.0, 4.0, 1.0, 1.0, 0.1, 0.01],
+        "wall": [0.3, 0.05, 0.01, 0.01, 0.002, 0.0],
+    },
+}
+
+
+def as_bool(v):
+    return str(v).lower() in ("1", "true", "yes", "on")
+
+
+def scenario_params(scenario, overrides):
+    p = dict(DEFAULTS[scenario])
+    p.update(overrides)
+    return p
+
+
+def features(scenario, params):
+    # só os parâmetros passados vão na linha de comando; o resto vem dos padrões
+    params = scenario_params(scenario, params)
+    sectors = 3.0 * int(params["rows"]) * int(params["cols"])
+    ues = float(params["ueCount"])
+    rb = float(params["bandwidth"]) / REFERENCE_BANDWIDTH[scenario]
+    monitor = 1.0 + as_bool(params.get("flowmonHistograms")) + as_bool(params.get("flowmonXml"))
+    return [1.0, sectors, ues, ues * rb, ues * sectors / 1000.0, ues * monitor]
+
+
+def predict(coef, x):
+    return sum(c * v for c, v in zip(coef, x))
+
+
+def solve(a, b):
+    # eliminação de Gauss com pivô parcial (sistemas 6x6)
+    n = len(b)
+    m = [row[:] + [b[i]] for i, row in enumerate(a)]
+    for col in range(n):
+        piv = max(range(col, n), key=lambda r: abs(m[r][col]))
+        m[col], m[piv] = m[piv], m[col]
+        if abs(m[col][col]) < 1e-12:
+            continue
+        for r in range(n):
+            if r != col:
+                f = m[r][col] / m[col][col]
+                for k in range(col, n + 1):
+                    m[r][k] -= f * m[col][k]
+    return [m[i][n] / m[i][i] if abs(m[i][i]) >= 1e-12 else 0.0 for i in range(n)]
+
+
+def fit(xs, ys, prior, ridge=1e-2):
+    # mín ||Xb - y||² + ridge*n*||S(b - prior)||², com S = escala de cada termo
+    # nos dados; termos que ficariam negativos são fixados em 0 e o ajuste é refeito
+    n = len(FEATURES)
+    if not xs:
+        return list(prior)
+    scale = [max((sum(x[k] ** 2 for x in xs) / len(xs)) ** 0.5, 1e-9) for k in range(n)]
+    fixed = set()
+    while True:
+        a = [[0.0] * n for _ in range(n)]
+        b = [0.0] * n
+        for x, y in zip(xs, ys):
+            for i in range(n):
+                b[i] += x[i] * y
+                for j in range(n):
+                    a[i][j] += x[i] * x[j]
+        lam = ridge * len(xs)
+        for i in range(n):
+            a[i][i] += lam * scale[i] ** 2
+            b[i] += lam * scale[i] ** 2 * prior[i]
+        for i in fixed:
+            a[i] = [0.0] * n
+            a[i][i] = 1.0
+            b[i] = 0.0
+        coef = solve(a, b)
+        neg = [i for i in range(n) if coef[i] < 0 and i not in fixed]
+        if not neg:
+            return [max(c, 0.0) for c in coef]
+        fixed.update(neg)
+
+
+class Model:
+    def __init__(self, scenario, path=None):
+        self.scenario = scenario
+        self.points = []
+        self.memory = list(PRIOR[scenario]["memory"])
+        self.wall = list(PRIOR[scenario]["wall"])
+        if path and os.path.exists(path):
+            with open(path) as f:
+                data = json.load(f)
+            if data.get("scenario") == scenario:
+                self.points = data.get("points", [])
+                self.refit()
+
+    def add(self, params, peak_rss_mb, wall_per_sim_s):
+        self.points.append({"params": params, "peak_rss_mb": peak_rss_mb,
+                            "wall_per_sim_s": wall_per_sim_s})
+        self.refit()
+
+    def refit(self):
+        xs = [features(self.scenario, p["params"]) for p in self.points]
+        self.memory = fit(xs, [p["peak_rss_mb"] for p in self.points], PRIOR[self.scenario]["memory"])
+        self.wall = fit(xs, [p["wall_per_sim_s"] for p in self.points], PRIOR[self.scenario]["wall"])
+
+    def estimate(self, params):
+        x = features(self.scenario, params)
+        return predict(self.memory, x), predict(self.wall, x)
+
+    def save(self, path):
+        with open(path, "w") as f:
+            json.dump({"scenario": self.scenario,
+                       "features": FEATURES,
+                       "memory_mb": dict(zip(FEATURES, self.memory)),
+                       "wall_per_sim_s": dict(zip(FEATURES, self.wall)),
+                       "points": self.points}, f, indent=2)
+        print("[CAPACITY] calibração em %s (%d pontos)" % (path, len(self.points)))
+
+
+def mem_available_mb():
+    with open("/proc/meminfo") as f:
+        for line in f:
+            if line.startswith("MemAvailable:"):
+                return int(line.split()[1]) / 1024.0
+    return 8192.0
+
+
+def tree_rss_mb(root):
+    # RSS somado do processo e descendentes (./ns3 run lança o binário como filho)
+    children = {}
+    rss = {}
+    for d in os.listdir("/proc"):
+        if not d.isdigit():
+            continue
+        try:
+            with open("/proc/%s/stat" % d) as f:
+                fields = f.read().rsplit(")", 1)[1].split()
+            children.setdefault(int(fields[1]), []).append(int(d))
+            rss[int(d)] = int(fields[21]) * os.sysconf("SC_PAGE_SIZE") / (1024.0 * 1024.0)
+        except (OSError, IndexError, ValueError):
+            continue
+    total = 0.0
+    stack = [root]
+    while stack:
+        pid = stack.pop()
+        total += rss.get(pid, 0.0)
+        stack.extend(children.get(pid, []))
+    return total
+
+
+def measure(args, params, ram_limit_mb=None, timeout_s=None):
+    """Roda uma execução curta; devolve (pico RSS MB, s reais por s simulado) ou None."""
+    run_dir = os.path.join(os.path.abspath(args.out), urbano_runner.run_name(params))
+    os.makedirs(run_dir, exist_ok=True)
+    log = open(os.path.join(run_dir, "stdout.log"), "w")
+    t0 = time.monotonic()
+    proc = subprocess.Popen(urbano_runner.command(args, args.scenario, params, run_dir), cwd=run_dir, stdout=log,
+                            stderr=subprocess.STDOUT, start_new_session=True)
+    log.close()
+    peak = 0.0
+    reason = None
+    while proc.poll() is None:
+        peak = max(peak, tree_rss_mb(proc.pid))
+        if ram_limit_mb and peak > ram_limit_mb:
+            reason = "RSS %.0f MB > %.0f MB" % (peak, ram_limit_mb)
+        elif timeout_s and time.monotonic() - t0 > timeout_s:
+            reason = "tempo real > %.0f s" % timeout_s
+        if reason:
+            os.killpg(proc.pid, signal.SIGKILL)
+            proc.wait()
+            print("[CAPACITY] ueCount=%s abortado: %s" % (params["ueCount"], reason))
+            return None
+        time.sleep(0.2)
+    if proc.returncode != 0:
+        print("[CAPACITY] ueCount=%s falhou (rc=%d, ver %s/stdout.log)"
+              % (params["ueCount"], proc.returncode, run_dir))
+        return None
+
+    # preferir o relatório do profiler: o pico do getrusage não perde picos curtos
+    prof_path = os.path.join(run_dir, args.scenario + "-profile.json")
+    run_wall = time.monotonic() - t0
+    if os.path.exists(prof_path):
+        with open(prof_path) as f:
+            prof = json.load(f)
+        peak = max(peak, prof["total"]["peak_rss_mb"])
+        run_wall = sum(p["wall_s"] for p in prof["phases"] if p["name"] == "run")
+    wall_per_sim_s = run_wall / float(params["simTime"])
+    print("[CAPACITY] ueCount=%s: pico %.0f MB, %.2f s reais/s simulado"
+          % (params["ueCount"], peak, wall_per_sim_s))
+    return peak, wall_per_sim_s
+
+
+def fits(rss_mb, wall, args):
+    return rss_mb <= args.ram_budget_mb * args.safety and (not args.wall_budget or wall <= args.wall_budget)
+
+
+def model_max_ue(model, base, args, hi):
+    # maior ueCount que o modelo prevê dentro do orçamento (modelo monotônico em ueCount)
+    lo = 1
+    if not fits(*model.estimate(dict(base, ueCount=lo)), args):
+        return 0
+    while lo < hi:
+        mid = (lo + hi + 1) // 2
+        if fits(*model.estimate(dict(base, ueCount=mid)), args):
+            lo = mid
+        else:
+            hi = mid - 1
+    return lo
+
+
+def cmd_estimate(args, base, model):
+    rss, wall = model.estimate(base)
+    ue_count = int(scenario_params(args.scenario, base)["ueCount"])
+    print("[CAPACITY] %s %s" % (args.scenario, " ".join("--%s=%s" % kv for kv in sorted(base.items()))))
+    print("[CAPACITY] pico de RSS previsto: %.0f MB (orçamento %.0f MB)" % (rss, args.ram_budget_mb))
+    print("[CAPACITY] tempo real previsto: %.2f s por s simulado (%.0f s para simTime=%s)"
+          % (wall, wall * float(base.get("simTime", 10.0)), base.get("simTime", 10.0)))
+    if rss > args.ram_budget_mb * args.safety:
+        print("[CAPACITY] NÃO cabe na memória; ueCount seguro estimado: %d"
+              % model_max_ue(model, base, args, ue_count))
+        return 1
+    return 0
+
+
+def cmd_calibrate(args, base, model):
+    full = scenario_params(args.scenario, base)
+    target = int(full["ueCount"])
+    ues = sorted({max(10, int(target * f)) for f in (0.1, 0.25, 0.5)})
+    grids = [(int(full["rows"]), int(full["cols"]))]
+    if int(full["rows"]) * int(full["cols"]) > 4:
+        grids.append((2, 2))   # separa o termo por setor do termo por UE
+    for rows, cols in grids:
+        for u in ues:
+            params = dict(base, rows=rows, cols=cols, ueCount=u, simTime=args.sim_time)
+            m = measure(args, params, ram_limit_mb=args.ram_budget_mb)
+            if m:
+                model.add(params, *m)
+    model.save(args.calibration)
+    return cmd_estimate(args, base, model)
+
+
+def cmd_probe(args, base, model):
+    base = dict(base, simTime=args.sim_time)
+    timeout = args.wall_budget * args.sim_time * 2 + 600 if args.wall_budget else None
+    lo, hi = 0, None   # lo cabe (0 trivialmente); hi = menor ueCount medido que não cabe
+    best = None
+    u = max(1, model_max_ue(model, base, args, args.max_ue))
+    while True:
+        m = measure(args, dict(base, ueCount=u), ram_limit_mb=args.ram_budget_mb, timeout_s=timeout)
+        if m:
+            model.add(dict(base, ueCount=u), *m)
+        if m and fits(m[0], m[1], args):
+            lo, best = u, m
+        else:
+            hi = u
+        if hi is None and lo >= args.max_ue:
+            break
+        if hi is not None and hi - lo <= max(args.tolerance * lo, 1):
+            break
+        # próximo ponto: o modelo recalibrado, protegido para a busca sempre convergir
+        guess = model_max_ue(model, base, args, (hi or args.max_ue + 1) - 1)
+        if hi is None:
+            # ainda sem limite superior medido: cresce no máximo 2x por passo
+            u = min(max(guess, lo + max(1, lo // 4)), 2 * lo, args.max_ue)
+        else:
+            q = max((hi - lo) // 4, 1)
+            u = min(max(guess, lo + q), hi - q)
+    model.save(args.calibration)
+
+    if not best:
+        print("[CAPACITY] nenhum ueCount >= 1 cabe no orçamento")
+        return 1
+    safe = dict(base, ueCount=lo)
+    del safe["simTime"]
+    print("[CAPACITY] configuração segura (%.0f MB, %.2f s reais/s simulado medidos com simTime=%s):"
+          % (best[0], best[1], args.sim_time))
+    print("  scratch/%s %s" % (args.scenario, " ".join("--%s=%s" % kv for kv in sorted(safe.items()))))
+    return 0
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Orçamento de memória/tempo e busca de ueCount dos cenários urbanos")
+    ap.add_argument("action", choices=["estimate", "calibrate", "probe"])
+    ap.add_argument("--scenario", required=True, choices=sorted(DEFAULTS))
+    urbano_runner.add_args(ap)
+    ap.add_argument("--set", action="append", default=[], metavar="PARAM=v", help="parâmetro fixo")
+    ap.add_argument("--calibration", help="JSON de calibração (padrão capacity-<cenario>.json)")
+    ap.add_argument("--ram-budget-mb", type=float, help="padrão: MemAvailable")
+    ap.add_argument("--wall-budget", type=float, help="s reais por s simulado (fase run)")
+    ap.add_argument("--safety", type=float, default=0.85, help="fração do orçamento de RAM usada")
+    ap.add_argument("--sim-time", type=float, default=1.0, help="simTime das execuções curtas")
+    ap.add_argument("--max-ue", type=int, default=50000)
+    ap.add_argument("--tolerance", type=float, default=0.05, help="precisão relativa da busca")
+    ap.add_argument("--out", default="capacity-out")
+    args = ap.parse_args()
+    args.calibration = args.calibration or "capacity-%s.json" % args.scenario
+    urbano_runner.resolve(args)
+    args.ram_budget_mb = args.ram_budget_mb or mem_available_mb()
+
+    base = dict(s.split("=", 1) for s in args.set)
+    model = Model(args.scenario, args.calibration)
+    return {"estimate": cmd_estimate, "calibrate": cmd_calibrate, "probe": cmd_probe}[args.action](args, base, model)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
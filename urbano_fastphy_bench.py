@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+# urbano_fastphy_bench.py
+# Vazão e BLER de rodadas reais com fastPhy=false (modelo de erro exato) e true
+# (tabelas, urbano-fast-phy.h) no nr-6g-urbano.
+#  Para cada número de UEs x banda roda o cenário nos dois modos com a mesma
+#  semente, o trace por TB do NR (--phyTraces, RxPacketTrace.txt) e o resumo
+#  colunar do FlowMonitor. Por modo:
+#   - BLER das primeiras transmissões (rv = 0) medido (fração corrompida) e
+#     previsto pelo modelo (média do TBLER), separado entre TBs de 1 code block
+#     e de vários (mesma segmentação LDPC do CodeBlocks() do fast PHY); com
+#     400 MHz a maior parte dos TBs tem vários code blocks;
+#   - vazão de aplicação (soma das taxas de recepção dos fluxos, .ufsc) e vazão
+#     de PHY (bits dos TBs entregues / simTime);
+#   - tempo real da fase run (profiler).
+#  As linhas [FASTPHY] da rodada com tabelas (validação interna tabela x exato,
+#  também separada por code blocks) vão para o stdout.log da execução.
+#
+# Exemplo:
+#   python3 urbano_fastphy_bench.py --ns3-dir ~/ns-3.40 --ues 500,1500 --bandwidths 100e6,400e6
+# Saída: fastphy-bench.csv (uma linha por ponto e modo).
+
+import argparse
+import csv
+import glob
+import math
+import os
+import sys
+
+import urbano_flowstats
+import urbano_runner
+
+SCENARIO = "nr-6g-urbano"
+RUN_PHASES = ["warmup", "run"]
+
+
+def code_blocks(size_bytes):
+    """Mesma regra do NrFastPhyErrorModel::CodeBlocks (38.212, BG1 acima de 3824 bits)."""
+    b = 8.0 * size_bytes + 24
+    kcb = 8448 if b > 3824 else 3840
+    return 1 if b <= kcb else int(math.ceil(b / (kcb - 24)))
+
+
+def read_tb_trace(run_dir, sim_time):
+    """BLER medido e previsto por classe de TB (1 code block / vários) e vazão de PHY."""
+    stats = {"1cb": [0, 0, 0.0], "multicb": [0, 0, 0.0]}  # TBs, corrompidos, Σ TBLER
+    ok_bits = 0
+    paths = sorted(glob.glob(os.path.join(run_dir, "RxPacketTrace*.txt")))
+    for path in paths:
+        with open(path) as f:
+            header = [h.strip().lower() for h in f.readline().split("\t")]
+            col = {h: i for i, h in enumerate(header)}
+            if not {"tbsize", "rv", "corrupt", "tbler"} <= set(col):
+                continue
+            for line in f:
+                v = line.rstrip("\n").split("\t")
+                if len(v) < len(header):
+                    continue
+                size = int(float(v[col["tbsize"]]))
+                corrupt = int(float(v[col["corrupt"]]))
+                if not corrupt:
+                    ok_bits += 8 * size
+                if int(float(v[col["rv"]])) != 0:
+                    continue
+                s = stats["multicb" if code_blocks(size) > 1 else "1cb"]
+                s[0] += 1
+                s[1] += corrupt
+                s[2] += float(v[col["tbler"]])
+    if not paths:
+        return None
+    r = {"phy_thr_mbps": ok_bits / float(sim_time) / 1e6}
+    for name, (n, bad, tbler) in stats.items():
+        r["tbs_" + name] = n
+        r["bler_" + name] = bad / n if n else float("nan")
+        r["tbler_" + name] = tbler / n if n else float("nan")
+    return r
+
+
+def app_throughput(run_dir):
+    path = os.path.join(run_dir, SCENARIO + "-metrics.ufsc")
+    if not os.path.exists(path):
+        return float("nan")
+    f = urbano_flowstats.read_columnar(path)["flows"]
+    thr = 0.0
+    for i in range(len(f["flow_id"])):
+        rx_dur = (f["time_last_rx_ns"][i] - f["time_first_rx_ns"][i]) * 1e-9
+        if rx_dur > 0:
+            thr += f["rx_bytes"][i] * 8 / rx_dur / 1e6
+    return thr
+
+
+def run_once(args, params):
+    # o caminho das tabelas é o mesmo em todas as rodadas: fica fora do nome
+    name = urbano_runner.run_name({k: v for k, v in params.items() if k != "fastPhyCache"})
+    run_dir = os.path.join(os.path.abspath(args.out), name)
+    prof = urbano_runner.run_once(args, SCENARIO, params, run_dir)
+    if prof is None:
+        return None
+    tb = read_tb_trace(run_dir, params["simTime"])
+    if tb is None:
+        print("[BENCH] sem RxPacketTrace*.txt em %s" % run_dir)
+        return None
+    r = {"run_s": round(urbano_runner.phase_sum(prof, RUN_PHASES), 4), "app_thr_mbps": app_throughput(run_dir)}
+    r.update(tb)
+    return r
+
+
+def rel(a, b):
+    return 100.0 * (a - b) / b if b else float("nan")
+
+
+FIELDS = ["ues", "bandwidth", "rng_run", "mode", "run_s", "app_thr_mbps", "phy_thr_mbps", "tbs_1cb", "bler_1cb",
+          "tbler_1cb", "tbs_multicb", "bler_multicb", "tbler_multicb"]
+
+
+def main():
+    ap = argparse.ArgumentParser(description="nr-6g-urbano com e sem fastPhy: vazão e BLER de rodadas reais")
+    urbano_runner.add_args(ap)
+    ap.add_argument("--ues", default="500,1500", help="números de UEs separados por vírgula")
+    ap.add_argument("--bandwidths", default="100e6,400e6", help="bandas em Hz separadas por vírgula")
+    ap.add_argument("--runs", type=int, default=1, help="sementes (rngRun=1..N) por ponto")
+    ap.add_argument("--set", action="append", default=[], metavar="PARAM=v", help="parâmetro fixo")
+    ap.add_argument("--out", default="fastphy-bench-out")
+    args = ap.parse_args()
+    urbano_runner.resolve(args)
+
+    fixed = dict(s.split("=", 1) for s in args.set)
+    fixed.setdefault("simTime", "3")
+    fixed.update({"phyTraces": "true", "flowmonColumnar": "true"})
+    # tabelas geradas uma vez e reaproveitadas por todas as rodadas com fastPhy
+    fixed.setdefault("fastPhyCache", os.path.join(os.path.abspath(args.out), "nr-fastphy.tbl"))
+    os.makedirs(args.out, exist_ok=True)
+
+    rows_out = []
+    for ues in [int(u) for u in args.ues.split(",")]:
+        for bw in [float(b) for b in args.bandwidths.split(",")]:
+            for run in range(1, args.runs + 1):
+                pts = {}
+                for mode in ("exact", "fast"):
+                    params = dict(fixed)
+                    params.update({"ueCount": ues, "bandwidth": "%g" % bw, "rngRun": run,
+                                   "fastPhy": "true" if mode == "fast" else "false"})
+                    r = run_once(args, params)
+                    if not r:
+                        continue
+                    row = {"ues": ues, "bandwidth": "%g" % bw, "rng_run": run, "mode": mode}
+                    row.update(r)
+                    rows_out.append(row)
+                    pts[mode] = row
+                if len(pts) < 2:
+                    continue
+                e, f = pts["exact"], pts["fast"]
+                print("[BENCH] %5d UEs %3.0f MHz run %d: vazão app %+.2f%%, PHY %+.2f%%; BLER 1 CB %.4f x %.4f "
+                      "(%d TBs), 2+ CB %.4f x %.4f (%d TBs) [fast x exato]; run %.2fx mais rápido"
+                      % (ues, bw / 1e6, run, rel(f["app_thr_mbps"], e["app_thr_mbps"]),
+                         rel(f["phy_thr_mbps"], e["phy_thr_mbps"]), f["bler_1cb"], e["bler_1cb"], f["tbs_1cb"],
+                         f["bler_multicb"], e["bler_multicb"], f["tbs_multicb"],
+                         e["run_s"] / f["run_s"] if f["run_s"] else 0))
+
+    out = "fastphy-bench.csv"
+    with open(out, "w", newline="") as fh:
+        w = csv.DictWriter(fh, fieldnames=FIELDS)
+        w.writeheader()
+        w.writerows(rows_out)
+    print("[BENCH] resultados em %s" % out)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+# urbano_flowstats.py
+# Leitor do formato colunar "UFSC" gravado por urbano-flow-export.h e conversor
+# para a planilha de resumo que hoje montamos à mão (lte-urbano-metrics.xlsx):
+#   flow_id, protocol, src_ip, src_port, dst_ip, dst_port,
+#   tx_bitrate_kbit_s, rx_bitrate_kbit_s, mean_delay_ms, packet_loss_ratio_pct
+# As fórmulas seguem o flowmon-parse-results.py do ns-3.
+#
+# Uso:
+#   python3 urbano_flowstats.py lte-urbano-metrics.ufsc -o lte-urbano-summary.csv
+#   python3 urbano_flowstats.py nr-6g-urbano-metrics.ufsc -o resumo.xlsx   (requer openpyxl)
+
+import argparse
+import csv
+import struct
+import sys
+import time
+
+PROTOCOLS = {6: "TCP", 17: "UDP"}
+
+
+def _decode_column(data, rows):
+    values = []
+    prev = 0
+    pos = 0
+    for _ in range(rows):
+        shift = 0
+        zz = 0
+        while True:
+            b = data[pos]
+            pos += 1
+            zz |= (b & 0x7F) << shift
+            if b < 0x80:
+                break
+            shift += 7
+        delta = (zz >> 1) ^ -(zz & 1)
+        prev += delta
+        values.append(prev)
+    return values
+
+
+def read_columnar(path):
+    """Devolve {tabela: {coluna: [valores]}}."""
+    with open(path, "rb") as f:
+        buf = f.read()
+    if buf[:4] != b"UFSC":
+        raise ValueError("%s: não é um arquivo UFSC" % path)
+    version = buf[4]
+    if version != 1:
+        raise ValueError("%s: versão UFSC %d não suportada" % (path, version))
+    pos = 5
+    (ntables,) = struct.unpack_from("<I", buf, pos)
+    pos += 4
+
+    def read_string():
+        nonlocal pos
+        n = buf[pos]
+        s = buf[pos + 1 : pos + 1 + n].decode()
+        pos += 1 + n
+        return s
+
+    tables = {}
+    for _ in range(ntables):
+        name = read_string()
+        rows, ncols = struct.unpack_from("<II", buf, pos)
+        pos += 8
+        cols = {}
+        for _ in range(ncols):
+            cname = read_string()
+            encoding = buf[pos]
+            (nbytes,) = struct.unpack_from("<I", buf, pos + 1)
+            pos += 5
+            if encoding != 1:
+                raise ValueError("coluna %s.%s: codificação %d desconhecida" % (name, cname, encoding))
+            cols[cname] = _decode_column(buf[pos : pos + nbytes], rows)
+            pos += nbytes
+        tables[name] = cols
+    return tables
+
+
+def _ip(v):
+    return "%d.%d.%d.%d" % ((v >> 24) & 0xFF, (v >> 16) & 0xFF, (v >> 8) & 0xFF, v & 0xFF)
+
+
+SUMMARY_COLUMNS = [
+    "flow_id",
+    "protocol",
+    "src_ip",
+    "src_port",
+    "dst_ip",
+    "dst_port",
+    "tx_bitrate_kbit_s",
+    "rx_bitrate_kbit_s",
+    "mean_delay_ms",
+    "packet_loss_ratio_pct",
+]
+
+
+def summarize(tables):
+    """Linhas do resumo por fluxo (células vazias quando não houve recepção)."""
+    f = tables["flows"]
+    out = []
+    for i in range(len(f["flow_id"])):
+        tx_dur = (f["time_last_tx_ns"][i] - f["time_first_tx_ns"][i]) * 1e-9
+        rx_dur = (f["time_last_rx_ns"][i] - f["time_first_rx_ns"][i]) * 1e-9
+        rx_pkts = f["rx_packets"][i]
+        lost = f["lost_packets"][i]
+        row = {
+            "flow_id": f["flow_id"][i],
+            "protocol": PROTOCOLS.get(f["protocol"][i], str(f["protocol"][i])),
+            "src_ip": _ip(f["src_ip"][i]),
+            "src_port": f["src_port"][i],
+            "dst_ip": _ip(f["dst_ip"][i]),
+            "dst_port": f["dst_port"][i],
+            "tx_bitrate_kbit_s": round(f["tx_bytes"][i] * 8 / tx_dur * 1e-3, 2) if tx_dur > 0 else "",
+            "rx_bitrate_kbit_s": "",
+            "mean_delay_ms": "",
+            "packet_loss_ratio_pct": "",
+        }
+        if rx_pkts > 0:
+            if rx_dur > 0:
+                row["rx_bitrate_kbit_s"] = round(f["rx_bytes"][i] * 8 / rx_dur * 1e-3, 2)
+            row["mean_delay_ms"] = round(f["delay_sum_ns"][i] * 1e-6 / rx_pkts, 2)
+            row["packet_loss_ratio_pct"] = round(lost * 100.0 / (rx_pkts + lost), 2)
+        out.append(row)
+    return out
+
+
+def write_summary(rows, path):
+    if path.endswith(".xlsx"):
+        import openpyxl
+
+        wb = openpyxl.Workbook()
+        ws = wb.active
+        ws.title = "Sheet1"
+        ws.append(SUMMARY_COLUMNS)
+        for r in rows:
+            ws.append([r[c] if r[c] != "" else None for c in SUMMARY_COLUMNS])
+        wb.save(path)
+    else:
+        with open(path, "w", newline="") as f:
+            w = csv.DictWriter(f, fieldnames=SUMMARY_COLUMNS)
+            w.writeheader()
+            w.writerows(rows)
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Converte .ufsc do FlowMonitor em planilha de resumo")
+    ap.add_argument("input")
+    ap.add_argument("-o", "--output", help="arquivo .csv ou .xlsx (padrão: stdout em CSV)")
+    args = ap.parse_args()
+
+    t0 = time.perf_counter()
+    tables = read_columnar(args.input)
+    rows = summarize(tables)
+    sys.stderr.write("lido %s: %d fluxos em %.1f ms\n" % (args.input, len(rows), (time.perf_counter() - t0) * 1e3))
+
+    if args.output:
+        write_summary(rows, args.output)
+    else:
+        w = csv.DictWriter(sys.stdout, fieldnames=SUMMARY_COLUMNS)
+        w.writeheader()
+        w.writerows(rows)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+# urbano_mpi_scaling.py
+# Vazão da execução particionada (MPI) dos cenários urbanos (1..16 ranks).
+#  Com N > 1 cada rank simula seu cluster de sites como ilha independente, sem
+#  interferência nem handover entre clusters (urbano-mpi-partition.h): N ranks
+#  não rodam o mesmo modelo que 1 rank. Por isso a razão de tempos NÃO é um
+#  speedup de escalabilidade forte; é quanto mais rápido sai a simulação
+#  particionada, e vem sempre acompanhada da deriva dos KPIs contra 1 rank
+#  (aviso quando passa de --drift-warn).
+#  - fixed: mesmo problema (rows x cols sites, ueCount UEs) em N ranks;
+#    partition_speedup = T(1)/T(N), partition_eff = partition_speedup/N;
+#  - scaled: cada rank fica com a mesma carga: cols, areaX e ueCount crescem N
+#    vezes (a grade cresce só na horizontal, então os clusters RCB continuam
+#    iguais); partition_eff = T(1)/T(N). A deriva compara a vazão por UE.
+#  T é o tempo de parede do mpirun inteiro; setup e Run vêm da linha "[MPI] ..."
+#  impressa pelo rank 0 (máximo entre ranks). Cada execução roda num diretório
+#  próprio em --runs-dir (saída em stdout.log). Deriva não medida (sem 1 rank,
+#  rank sem UEs, linha [MPI] ausente) também gera o aviso.
+#
+# Exemplo:
+#   python3 urbano_mpi_scaling.py --ns3-dir ~/ns-3.40 --scenario lte-urbano \
+#       --mode fixed --ranks 1,2,4,8,16 --set simTime=5 --set ueCount=6300
+# Requer ns-3 configurado com --enable-mpi (senão todos os ranks rodam a grade inteira).
+
+import argparse
+import csv
+import math
+import os
+import subprocess
+import sys
+import time
+
+import urbano_runner
+
+BASE = {
+    "lte-urbano": {"rows": 4, "cols": 4, "ueCount": 6300, "areaX": 3000.0},
+    "nr-6g-urbano": {"rows": 4, "cols": 4, "ueCount": 1500, "areaX": 3000.0},
+}
+
+
+def parse_mpi_line(text):
+    for line in text.splitlines():
+        if line.startswith("[MPI]"):
+            return dict(kv.split("=", 1) for kv in line.split()[1:])
+    return {}
+
+
+def kpis(kv):
+    thr = float(kv.get("thr_mbit_s", "nan"))
+    ues = float(kv.get("ues", "nan"))
+    return {"thr_per_ue": thr / ues if ues > 0 else float("nan"),
+            "thr": thr,
+            "delay": float(kv.get("delay_ms", "nan")),
+            "loss": float(kv.get("loss_pct", "nan"))}
+
+
+def drift(mode, ref, cur):
+    # vazão (total no fixed, por UE no scaled) e atraso em %, perda em pontos percentuais
+    thr = "thr_per_ue" if mode == "scaled" else "thr"
+    rel = lambda k: 100.0 * (cur[k] - ref[k]) / ref[k] if ref[k] else float("nan")
+    return {"thr_pct": rel(thr), "delay_pct": rel("delay"), "loss_pp": cur["loss"] - ref["loss"]}
+
+
+def drift_exceeded(d, limit):
+    # NaN (deriva não medida) conta como acima do limite
+    return any(not math.isfinite(v) or abs(v) > limit for v in d.values())
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Vazão da execução MPI particionada dos cenários urbanos")
+    ap.add_argument("--scenario", required=True, choices=sorted(BASE))
+    urbano_runner.add_args(ap)
+    ap.add_argument("--mpirun", default="mpirun")
+    ap.add_argument("--mpirun-arg", action="append", default=[],
+                    help="argumento extra do mpirun (ex.: --mpirun-arg=--oversubscribe)")
+    ap.add_argument("--mode", choices=["fixed", "scaled", "both"], default="both")
+    ap.add_argument("--ranks", default="1,2,4,8,16")
+    ap.add_argument("--set", action="append", default=[], metavar="PARAM=v", help="parâmetro fixo")
+    ap.add_argument("--repeat", type=int, default=1, help="repetições por ponto (usa o menor tempo)")
+    ap.add_argument("--drift-warn", type=float, default=5.0,
+                    help="avisa quando vazão/atraso (%%) ou perda (pp) derivam mais que isso de 1 rank")
+    ap.add_argument("--runs-dir", default="mpi-out", help="diretório das execuções")
+    ap.add_argument("--out", default="mpi-partition.csv")
+    args = ap.parse_args()
+    urbano_runner.resolve(args)
+    if os.sep in args.mpirun:
+        args.mpirun = os.path.abspath(args.mpirun)
+
+    ranks = [int(r) for r in args.ranks.split(",")]
+    base = dict(BASE[args.scenario])
+    base.update(dict(s.split("=", 1) for s in args.set))
+    modes = ["fixed", "scaled"] if args.mode == "both" else [args.mode]
+    if ranks[0] != 1:
+        print("[SCALING] aviso: sem a execução de 1 rank como referência a deriva dos KPIs não é medida")
+
+    rows = []
+    for mode in modes:
+        t1 = None
+        ref = None
+        for n in ranks:
+            params = dict(base)
+            if mode == "scaled":
+                params["cols"] = int(base["cols"]) * n
+                params["areaX"] = float(base["areaX"]) * n
+                params["ueCount"] = int(base["ueCount"]) * n
+            run_dir = os.path.join(os.path.abspath(args.runs_dir), "%s-np%d" % (mode, n))
+            os.makedirs(run_dir, exist_ok=True)
+            launcher = [args.mpirun, "-np", str(n)] + args.mpirun_arg
+            best = None
+            for _ in range(args.repeat):
+                t0 = time.monotonic()
+                proc = subprocess.run(urbano_runner.command(args, args.scenario, params, run_dir, launcher),
+                                      cwd=run_dir, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+                wall = time.monotonic() - t0
+                with open(os.path.join(run_dir, "stdout.log"), "w") as log:
+                    log.write(proc.stdout)
+                if proc.returncode != 0:
+                    print("[SCALING] %s N=%d falhou (rc=%d), ver %s/stdout.log" % (mode, n, proc.returncode, run_dir))
+                    return 1
+                kv = parse_mpi_line(proc.stdout)
+                if best is None or wall < best[0]:
+                    best = (wall, kv)
+            wall, kv = best
+            if t1 is None:
+                t1 = wall
+            k = kpis(kv)
+            if ref is None and n == 1:
+                ref = k
+            d = drift(mode, ref, k) if ref else {"thr_pct": float("nan"), "delay_pct": float("nan"),
+                                                  "loss_pp": float("nan")}
+            speedup = t1 / wall
+            eff = speedup / n if mode == "fixed" else speedup
+            row = {
+                "mode": mode, "ranks": n, "sites": kv.get("sites", ""), "ues": kv.get("ues", ""),
+                "wall_s": "%.2f" % wall, "setup_s": kv.get("setup_s", ""), "run_s": kv.get("run_s", ""),
+                "partition_speedup": "%.3f" % speedup, "partition_eff": "%.3f" % eff,
+                "thr_mbit_s": kv.get("thr_mbit_s", ""), "delay_ms": kv.get("delay_ms", ""),
+                "loss_pct": kv.get("loss_pct", ""),
+                "thr_drift_pct": "%.2f" % d["thr_pct"], "delay_drift_pct": "%.2f" % d["delay_pct"],
+                "loss_drift_pp": "%.2f" % d["loss_pp"],
+            }
+            rows.append(row)
+            print("[SCALING] %-6s N=%2d wall=%7.1fs run=%ss partition_speedup=%.2f eff=%.2f | "
+                  "KPIs vs 1 rank: thr %+.1f%% delay %+.1f%% loss %+.2f pp"
+                  % (mode, n, wall, row["run_s"], speedup, eff, d["thr_pct"], d["delay_pct"], d["loss_pp"]))
+            if n > 1 and drift_exceeded(d, args.drift_warn):
+                print("[SCALING] aviso: N=%d simula outra física (sem interferência/handover entre "
+                      "clusters); KPIs derivam além de %.1f ou a deriva não foi medida, a razão de tempos "
+                      "não é speedup do mesmo modelo" % (n, args.drift_warn))
+
+    with open(args.out, "w", newline="") as f:
+        w = csv.DictWriter(f, fieldnames=list(rows[0].keys()))
+        w.writeheader()
+        w.writerows(rows)
+    print("[SCALING] resultados em %s" % args.out)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
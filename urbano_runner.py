@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+# urbano_runner.py
+# Execução dos cenários urbanos, comum aos scripts de varredura e benchmark
+# (urbano_sweep.py, urbano_capacity.py, urbano_bench.py, urbano_setup_bench.py,
+# urbano_shadowing_bench.py, urbano_mpi_scaling.py, urbano_wrap_bench.py,
+# urbano_fastphy_bench.py):
+#  - add_args/resolve: --ns3-dir e --binary, resolvidos para caminhos absolutos
+#    (os processos rodam com cwd no diretório de cada execução);
+#  - command: linha de comando de uma execução (executável já compilado ou
+#    ./ns3 run --no-build), opcionalmente sob um lançador (ex.: mpirun -np N);
+#  - run_once: roda uma execução num diretório próprio e devolve o relatório do
+#    profiler (<cenario>-profile.json, urbano-phase-profiler.h);
+#  - phase_sum: soma de um campo do profiler sobre um conjunto de fases.
+
+import json
+import os
+import subprocess
+
+
+def add_args(ap):
+    ap.add_argument("--ns3-dir", default=".", help="raiz do ns-3 (usa ./ns3 run --no-build)")
+    ap.add_argument("--binary", help="executável já compilado (dispensa ./ns3)")
+
+
+def resolve(args):
+    """Caminhos absolutos: o cwd de cada processo é o diretório da execução."""
+    args.ns3_dir = os.path.abspath(args.ns3_dir)
+    for name in ("binary", "binary_dir"):
+        if getattr(args, name, None):
+            setattr(args, name, os.path.abspath(getattr(args, name)))
+
+
+def command(args, scenario, params, run_dir, launcher=None):
+    opts = ["--%s=%s" % kv for kv in sorted(params.items())]
+    if getattr(args, "binary_dir", None):
+        return (launcher or []) + [os.path.join(args.binary_dir, scenario)] + opts
+    if getattr(args, "binary", None):
+        return (launcher or []) + [args.binary] + opts
+    ns3 = [os.path.join(args.ns3_dir, "ns3"), "run", "--no-build", "--cwd=" + run_dir]
+    if launcher:
+        return ns3 + ["--command-template=" + " ".join(launcher + ["%s"] + opts), "scratch/" + scenario]
+    return ns3 + [" ".join(["scratch/" + scenario] + opts)]
+
+
+def run_name(params):
+    return "_".join("%s-%s" % kv for kv in sorted(params.items())) or "default"
+
+
+def run_once(args, scenario, params, run_dir):
+    """Roda uma execução em run_dir; devolve o JSON do profiler ou None se falhou."""
+    os.makedirs(run_dir, exist_ok=True)
+    with open(os.path.join(run_dir, "stdout.log"), "w") as log:
+        rc = subprocess.call(command(args, scenario, params, run_dir), cwd=run_dir,
+                             stdout=log, stderr=subprocess.STDOUT)
+    path = os.path.join(run_dir, scenario + "-profile.json")
+    if rc != 0 or not os.path.exists(path):
+        print("[BENCH] falhou (rc=%d), ver %s/stdout.log" % (rc, run_dir))
+        return None
+    with open(path) as f:
+        return json.load(f)
+
+
+def phase_sum(prof, names=None, key="wall_s"):
+    """Soma de key sobre as fases em names (todas se None)."""
+    return sum(p[key] for p in prof["phases"] if names is None or p["name"] in names)
@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+# urbano_setup_bench.py
+# Benchmark do tempo de montagem (setup) dos cenários de 48 a ~1000 setores.
+#  Para cada grade (rows x cols sites, 3 setores por site) roda o cenário com
+#  simTime curto, densidade de UEs fixa (--ue-per-sector) e a área dos UEs
+#  cobrindo a grade, com bulkBuild=true (urbano-topology-builder.h) e false
+#  (um setor por vez). O tempo vem do profiler por fase (<cenario>-profile.json):
+#  "cell install", "ue install", "attach" e o setup inteiro (todas as fases
+#  antes de "run"). --toggle troca o parâmetro comparado (modos on/off) e --ues
+#  fixa o número total de UEs em vez da densidade por setor.
+#
+# Exemplos:
+#   python3 urbano_setup_bench.py --ns3-dir ~/ns-3.40 --scenario lte-urbano
+#   # índice espacial x força bruta no attach (urbano-spatial-index.h)
+#   python3 urbano_setup_bench.py --ns3-dir ~/ns-3.40 --scenario nr-6g-urbano \
+#       --toggle spatialIndex --grids 8x9 --ues 1000,10000,50000
+# Saída: setup-bench-<cenario>.csv (uma linha por grade e modo, menor tempo de --repeat).
+
+import argparse
+import csv
+import itertools
+import math
+import os
+import sys
+
+import urbano_runner
+
+# 48, 108, 216, 432, 672 e 1008 setores
+GRIDS = [(4, 4), (6, 6), (8, 9), (12, 12), (14, 16), (16, 21)]
+SETUP_PHASES = ["helpers/epc", "band init", "cell install", "ue install", "attach", "apps", "flowmon"]
+
+
+def run_once(args, params):
+    run_dir = os.path.join(os.path.abspath(args.out), urbano_runner.run_name(params))
+    prof = urbano_runner.run_once(args, args.scenario, params, run_dir)
+    if prof is None:
+        return None
+    wall = lambda names: round(urbano_runner.phase_sum(prof, names), 4)
+    return {
+        "cell_install_s": wall(["cell install"]),
+        "ue_install_s": wall(["ue install"]),
+        "attach_s": wall(["attach"]),
+        "setup_s": wall(SETUP_PHASES),
+        "setup_rss_mb": max(p["rss_mb"] for p in prof["phases"] if p["name"] in SETUP_PHASES),
+    }
+
+
+def loglog_fit(pts):
+    """Inclinação e R² de log(t) = a + b*log(setores); None se não há 2 tamanhos distintos."""
+    xs = [math.log(s) for s, _ in pts]
+    ys = [math.log(t) for _, t in pts]
+    n = len(xs)
+    if n < 2:
+        return None
+    mx = sum(xs) / n
+    my = sum(ys) / n
+    sxx = sum((x - mx) ** 2 for x in xs)
+    if sxx == 0:
+        return None
+    sxy = sum((x - mx) * (y - my) for x, y in zip(xs, ys))
+    syy = sum((y - my) ** 2 for y in ys)
+    slope = sxy / sxx
+    r2 = sxy * sxy / (sxx * syy) if syy > 0 else 1.0
+    return slope, r2
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Tempo de setup dos cenários urbanos vs. número de setores")
+    ap.add_argument("--scenario", required=True, choices=["lte-urbano", "nr-6g-urbano"])
+    urbano_runner.add_args(ap)
+    ap.add_argument("--grids", help="lista RxC separada por vírgula (padrão: 48 a 1008 setores)")
+    ap.add_argument("--ue-per-sector", type=float, default=10.0)
+    ap.add_argument("--isd", type=float, default=600.0)
+    ap.add_argument("--toggle", default="bulkBuild", help="parâmetro booleano comparado (ex.: spatialIndex)")
+    ap.add_argument("--modes", help="padrão: bulk,legacy para bulkBuild, on,off para os demais")
+    ap.add_argument("--ues", help="números totais de UEs separados por vírgula (dispensa --ue-per-sector)")
+    ap.add_argument("--set", action="append", default=[], metavar="PARAM=v", help="parâmetro fixo")
+    ap.add_argument("--repeat", type=int, default=1, help="repetições por ponto (usa o menor tempo)")
+    ap.add_argument("--out", default="setup-bench-out")
+    args = ap.parse_args()
+    urbano_runner.resolve(args)
+
+    grids = GRIDS
+    if args.grids:
+        grids = [tuple(int(x) for x in g.split("x")) for g in args.grids.split(",")]
+    fixed = dict(s.split("=", 1) for s in args.set)
+    fixed.setdefault("simTime", "0.1")
+    modes = (args.modes or ("bulk,legacy" if args.toggle == "bulkBuild" else "on,off")).split(",")
+
+    rows_out = []
+    for (rows, cols), mode in itertools.product(grids, modes):
+        sectors = 3 * rows * cols
+        ue_counts = [int(u) for u in args.ues.split(",")] if args.ues else [int(round(args.ue_per_sector * sectors))]
+        for ues in ue_counts:
+            params = dict(fixed)
+            params.update({
+                "rows": rows,
+                "cols": cols,
+                "isd": args.isd,
+                # área cobrindo a grade (meio ISD de folga) e densidade de UEs fixa
+                "areaX": (cols + 0.5) * args.isd,
+                "areaY": max((rows - 1) * args.isd * math.sqrt(3) / 2, args.isd),
+                "ueCount": ues,
+                args.toggle: "true" if mode in ("bulk", "on") else "false",
+            })
+            best = None
+            for _ in range(args.repeat):
+                r = run_once(args, params)
+                if r and (best is None or r["setup_s"] < best["setup_s"]):
+                    best = r
+            if not best:
+                continue
+            row = {"sectors": sectors, "rows": rows, "cols": cols, "ues": params["ueCount"], "mode": mode}
+            row.update(best)
+            rows_out.append(row)
+            print("[BENCH] %4d setores %6d UEs %-6s cell install %.2f s, ue install %.2f s, attach %.2f s, "
+                  "setup %.2f s, RSS %.0f MB"
+                  % (sectors, ues, mode, best["cell_install_s"], best["ue_install_s"], best["attach_s"],
+                     best["setup_s"], best["setup_rss_mb"]))
+
+    out = "setup-bench-%s.csv" % args.scenario
+    with open(out, "w", newline="") as f:
+        w = csv.DictWriter(f, fieldnames=["sectors", "rows", "cols", "ues", "mode", "cell_install_s",
+                                          "ue_install_s", "attach_s", "setup_s", "setup_rss_mb"])
+        w.writeheader()
+        w.writerows(rows_out)
+
+    # crescimento do tempo de montagem dos setores por modo: expoente do ajuste
+    # log-log por mínimos quadrados sobre todas as grades
+    for mode in modes:
+        pts = [(r["sectors"], r["cell_install_s"]) for r in rows_out if r["mode"] == mode and r["cell_install_s"] > 0]
+        fit = loglog_fit(pts)
+        if fit:
+            slope, r2 = fit
+            (s0, t0), (s1, t1) = pts[0], pts[-1]
+            print("[BENCH] %s: cell install %.2f s -> %.2f s de %d a %d setores (~setores^%.2f, R²=%.3f, %d grades)"
+                  % (mode, t0, t1, s0, s1, slope, r2, len(pts)))
+    print("[BENCH] resultados em %s" % out)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
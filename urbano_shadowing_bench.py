@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+# urbano_shadowing_bench.py
+# Memória e tempo do sombreamento por enlace vs. por mapa (urbano-shadowing-map.h).
+#  Para cada número de UEs (padrão 1500 e 6300) roda o cenário com simTime curto
+#  em cada modo de --shadowing e lê do profiler (<cenario>-profile.json) o pico de
+#  RSS, o tempo real da fase "run" e os eventos; do console, a linha [SHADOW]
+#  (memória dos campos e consultas). No nr-6g-urbano "link" é o estado por par
+#  gNB/UE do 3GPP; no lte-urbano os modos são off e map (sem wrapAround: o campo
+#  não é periódico no toro e o cenário rejeita a combinação).
+#
+# Exemplo:
+#   python3 urbano_shadowing_bench.py --ns3-dir ~/ns-3.40 --scenario nr-6g-urbano
+# Saída: shadow-bench-<cenario>.csv (uma linha por número de UEs e modo, menor tempo de --repeat).
+
+import argparse
+import csv
+import os
+import re
+import sys
+
+import urbano_runner
+
+UES = [1500, 6300]
+MODES = {"nr-6g-urbano": "link,map,off", "lte-urbano": "off,map"}
+SHADOW_RE = re.compile(r"\[SHADOW\] mapa: (\d+)/\d+ campos .*?, ([\d.]+) MB, (\d+) consultas")
+
+
+def run_once(args, params):
+    run_dir = os.path.join(os.path.abspath(args.out), urbano_runner.run_name(params))
+    prof = urbano_runner.run_once(args, args.scenario, params, run_dir)
+    if prof is None:
+        return None
+    r = {
+        "run_s": round(urbano_runner.phase_sum(prof, ("warmup", "run")), 4),
+        "run_events": urbano_runner.phase_sum(prof, ("warmup", "run"), "events"),
+        "peak_rss_mb": prof["total"]["peak_rss_mb"],
+        "map_fields": 0,
+        "map_mb": 0.0,
+        "map_lookups": 0,
+    }
+    with open(os.path.join(run_dir, "stdout.log"), errors="replace") as log:
+        m = SHADOW_RE.search(log.read())
+    if m:
+        r.update({"map_fields": int(m.group(1)), "map_mb": float(m.group(2)), "map_lookups": int(m.group(3))})
+    return r
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Sombreamento por enlace vs. por mapa: memória e tempo")
+    ap.add_argument("--scenario", default="nr-6g-urbano", choices=sorted(MODES))
+    urbano_runner.add_args(ap)
+    ap.add_argument("--ues", default=",".join(str(u) for u in UES), help="números de UEs separados por vírgula")
+    ap.add_argument("--modes", help="modos de --shadowing (padrão: todos do cenário)")
+    ap.add_argument("--set", action="append", default=[], metavar="PARAM=v", help="parâmetro fixo")
+    ap.add_argument("--repeat", type=int, default=1, help="repetições por ponto (usa o menor tempo)")
+    ap.add_argument("--out", default="shadow-bench-out")
+    args = ap.parse_args()
+    urbano_runner.resolve(args)
+
+    modes = (args.modes or MODES[args.scenario]).split(",")
+    fixed = dict(s.split("=", 1) for s in args.set)
+    if "map" in modes and fixed.get("wrapAround", "0") not in ("0", ""):
+        ap.error("o mapa de sombreamento não combina com wrapAround (o cenário rejeita)")
+    fixed.setdefault("simTime", "3")
+
+    rows_out = []
+    for ues in [int(u) for u in args.ues.split(",")]:
+        for mode in modes:
+            params = dict(fixed)
+            params.update({"ueCount": ues, "shadowing": mode})
+            best = None
+            for _ in range(args.repeat):
+                r = run_once(args, params)
+                if r and (best is None or r["run_s"] < best["run_s"]):
+                    best = r
+            if not best:
+                continue
+            row = {"ues": ues, "mode": mode}
+            row.update(best)
+            rows_out.append(row)
+            print("[BENCH] %5d UEs %-4s run %.2f s, %d eventos, pico RSS %.0f MB, mapa %.1f MB"
+                  % (ues, mode, best["run_s"], best["run_events"], best["peak_rss_mb"], best["map_mb"]))
+
+    out = "shadow-bench-%s.csv" % args.scenario
+    with open(out, "w", newline="") as f:
+        w = csv.DictWriter(f, fieldnames=["ues", "mode", "run_s", "run_events", "peak_rss_mb", "map_fields",
+                                          "map_mb", "map_lookups"])
+        w.writeheader()
+        w.writerows(rows_out)
+
+    # mapa relativo ao primeiro modo (link no NR, off no LTE) por número de UEs
+    base = modes[0]
+    for ues in sorted({r["ues"] for r in rows_out}):
+        pts = {r["mode"]: r for r in rows_out if r["ues"] == ues}
+        if base in pts and "map" in pts and base != "map":
+            b, m = pts[base], pts["map"]
+            print("[BENCH] %5d UEs: map vs %s: RSS %+.0f MB, run %.2fx"
+                  % (ues, base, m["peak_rss_mb"] - b["peak_rss_mb"], m["run_s"] / b["run_s"] if b["run_s"] else 0))
+    print("[BENCH] resultados em %s" % out)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
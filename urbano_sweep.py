@@ -0,0 +1,270 @@
+#!/usr/bin/env python3
+# urbano_sweep.py
+# Varredura multi-seed / multi-parâmetro dos cenários urbanos em paralelo.
+#  - cada ponto (produto cartesiano dos --sweep) roda --runs vezes com
+#    --rngRun=1..N (seed fixa = 1), cada execução num processo e diretório próprios;
+#  - as execuções ocupam todos os núcleos locais, mas o escalonador só inicia um
+#    job se a memória estimada cabe no orçamento (MemAvailable por padrão); a
+#    estimativa é corrigida online com o pico de RSS medido dos jobs já terminados;
+#  - ao final, lê o .ufsc de cada execução e agrega throughput, atraso e perda
+#    com média e intervalo de confiança (t de Student).
+#
+# Exemplo:
+#   python3 urbano_sweep.py --ns3-dir ~/ns-3.40 --scenario nr-6g-urbano \
+#       --sweep ueCount=500,1000,1500 --sweep isd=500,600 --set simTime=5 --runs 10
+# Saídas em --out: runs.csv (uma linha por execução) e aggregate.csv (por ponto).
+
+import argparse
+import csv
+import itertools
+import math
+import os
+import subprocess
+import sys
+import time
+
+import urbano_capacity
+import urbano_flowstats
+import urbano_runner
+
+# estimativa inicial de pico de RSS (MB) = base + porUE * ueCount * fatorBanda;
+# ajuste com --mem-base-mb / --mem-per-ue-mb, ou use --calibration com o JSON
+# gravado por urbano_capacity.py calibrate (modelo por setor/UE/banda/monitor)
+MEM_MODEL = {
+    "lte-urbano": (300.0, 0.8),
+    "nr-6g-urbano": (400.0, 2.5),
+    "nr-6g-urbano-lite": (250.0, 2.0),
+}
+
+# valores padrão dos cenários (usados na estimativa quando o parâmetro não é varrido)
+DEFAULTS = {
+    "lte-urbano": {"ueCount": 6300, "bandwidth": 20e6},
+    "nr-6g-urbano": {"ueCount": 1500, "bandwidth": 400e6},
+    "nr-6g-urbano-lite": {"ueCount": 90, "bandwidth": 100e6},
+}
+REFERENCE_BANDWIDTH = {"lte-urbano": 20e6, "nr-6g-urbano": 100e6, "nr-6g-urbano-lite": 100e6}
+
+# t de Student bilateral 95% por graus de liberdade
+T95 = {1: 12.706, 2: 4.303, 3: 3.182, 4: 2.776, 5: 2.571, 6: 2.447, 7: 2.365, 8: 2.306,
+       9: 2.262, 10: 2.228, 12: 2.179, 15: 2.131, 20: 2.086, 25: 2.060, 30: 2.042,
+       40: 2.021, 60: 2.000, 120: 1.980}
+
+
+def t95(dof):
+    # fora da tabela usa a entrada de menos graus de liberdade (t maior): o IC
+    # fica um pouco largo, nunca estreito demais
+    if dof <= 0:
+        return float("nan")
+    return T95[max(k for k in T95 if k <= dof)]
+
+
+def mean_ci(values):
+    n = len(values)
+    if n == 0:
+        return float("nan"), float("nan")
+    m = sum(values) / n
+    if n == 1:
+        return m, float("nan")
+    var = sum((v - m) ** 2 for v in values) / (n - 1)
+    return m, t95(n - 1) * math.sqrt(var / n)
+
+
+def mem_available_mb():
+    with open("/proc/meminfo") as f:
+        for line in f:
+            if line.startswith("MemAvailable:"):
+                return int(line.split()[1]) / 1024.0
+    return 8192.0
+
+
+class Job:
+    def __init__(self, point, run, args):
+        self.point = point
+        self.run = run
+        self.params = dict(point)
+        self.params["rngRun"] = run
+        self.args = args
+        self.dir = os.path.join(args.out, "runs", point_name(point), "run%03d" % run)
+        self.estimate_mb = 0.0
+        self.base_estimate_mb = 0.0
+        self.rss_mb = 0.0
+        self.wall_s = 0.0
+        self.status = None
+
+    def command(self):
+        return urbano_runner.command(self.args, self.args.scenario, self.params, self.dir)
+
+
+def point_name(point):
+    return "_".join("%s-%s" % kv for kv in point) or "default"
+
+
+def estimate_mb(job, args, correction):
+    if args.model:
+        return args.model.estimate(job.params)[0] * correction
+    p = dict(DEFAULTS.get(args.scenario, {}))
+    p.update({k: float(v) for k, v in job.params.items() if k in ("ueCount", "bandwidth")})
+    base, per_ue = MEM_MODEL.get(args.scenario, (300.0, 2.0))
+    if args.mem_base_mb is not None:
+        base = args.mem_base_mb
+    if args.mem_per_ue_mb is not None:
+        per_ue = args.mem_per_ue_mb
+    bw_factor = p.get("bandwidth", 1.0) / REFERENCE_BANDWIDTH.get(args.scenario, p.get("bandwidth", 1.0))
+    return (base + per_ue * p.get("ueCount", 0) * max(bw_factor, 1.0)) * correction
+
+
+def run_jobs(jobs, args):
+    budget = args.mem_budget_mb or 0.8 * mem_available_mb()
+    pending = sorted(jobs, key=lambda j: -estimate_mb(j, args, 1.0))
+    running = {}
+    correction = 1.0
+    done = 0
+    print("[SWEEP] %d execuções, %d slots, orçamento de memória %.0f MB" % (len(jobs), args.jobs, budget))
+
+    while pending or running:
+        used = sum(j.estimate_mb for j in running.values())
+        for j in list(pending):
+            if len(running) >= args.jobs:
+                break
+            j.base_estimate_mb = estimate_mb(j, args, 1.0)
+            j.estimate_mb = j.base_estimate_mb * correction
+            if used + j.estimate_mb <= budget or not running:
+                if j.estimate_mb > budget:
+                    print("[SWEEP] aviso: %s/run%03d estima %.0f MB > orçamento; rodando sozinho"
+                          % (point_name(j.point), j.run, j.estimate_mb))
+                os.makedirs(j.dir, exist_ok=True)
+                log = open(os.path.join(j.dir, "stdout.log"), "w")
+                j.start = time.monotonic()
+                proc = subprocess.Popen(j.command(), cwd=j.dir, stdout=log, stderr=subprocess.STDOUT)
+                log.close()
+                running[proc.pid] = j
+                pending.remove(j)
+                used += j.estimate_mb
+        if not running:
+            continue
+
+        # slots cheios ou sem memória para o próximo: espera alguém terminar
+        pid, status, usage = os.wait4(-1, 0)
+        j = running.pop(pid, None)
+        if j is None:
+            continue
+        j.wall_s = time.monotonic() - j.start
+        j.rss_mb = usage.ru_maxrss / 1024.0
+        j.status = os.waitstatus_to_exitcode(status)
+        if j.status == 0 and j.base_estimate_mb > 0 and j.rss_mb > 0:
+            # só corrige para cima: subestimar memória é o que causa OOM
+            correction = max(correction, j.rss_mb / j.base_estimate_mb)
+        done += 1
+        print("[SWEEP] %d/%d %s run%03d rc=%d wall=%.1fs rss=%.0fMB (estimado %.0fMB)"
+              % (done, len(jobs), point_name(j.point), j.run, j.status, j.wall_s, j.rss_mb, j.estimate_mb))
+
+
+def ue_flow(row, ue_net):
+    net, bits = ue_net
+    mask = (0xFFFFFFFF << (32 - bits)) & 0xFFFFFFFF
+    return (row & mask) == net
+
+
+def run_kpis(job, args):
+    path = os.path.join(job.dir, args.scenario + "-metrics.ufsc")
+    if job.status != 0 or not os.path.exists(path):
+        return None
+    f = urbano_flowstats.read_columnar(path)["flows"]
+    net, bits = args.ue_net.split("/")
+    parts = [int(x) for x in net.split(".")]
+    ue_net = ((parts[0] << 24) | (parts[1] << 16) | (parts[2] << 8) | parts[3], int(bits))
+
+    thr = 0.0
+    delay = 0
+    rx = 0
+    tx = 0
+    for i in range(len(f["flow_id"])):
+        if not ue_flow(f["dst_ip"][i], ue_net):
+            continue
+        tx += f["tx_packets"][i]
+        rx += f["rx_packets"][i]
+        delay += f["delay_sum_ns"][i]
+        rx_dur = (f["time_last_rx_ns"][i] - f["time_first_rx_ns"][i]) * 1e-9
+        if rx_dur > 0:
+            thr += f["rx_bytes"][i] * 8 / rx_dur / 1e6
+    return {
+        "throughput_mbps": thr,
+        "mean_delay_ms": delay * 1e-6 / rx if rx else float("nan"),
+        "loss_pct": (tx - rx) * 100.0 / tx if tx else float("nan"),
+    }
+
+
+KPI_NAMES = ["throughput_mbps", "mean_delay_ms", "loss_pct", "wall_s", "rss_mb"]
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Runner paralelo multi-seed para os cenários urbanos")
+    ap.add_argument("--scenario", required=True, choices=sorted(MEM_MODEL))
+    urbano_runner.add_args(ap)
+    ap.add_argument("--sweep", action="append", default=[], metavar="PARAM=v1,v2,...")
+    ap.add_argument("--set", action="append", default=[], metavar="PARAM=v", help="parâmetro fixo")
+    ap.add_argument("--runs", type=int, default=5, help="execuções (rngRun=1..N) por ponto")
+    ap.add_argument("--jobs", type=int, default=os.cpu_count())
+    ap.add_argument("--mem-budget-mb", type=float)
+    ap.add_argument("--mem-base-mb", type=float)
+    ap.add_argument("--mem-per-ue-mb", type=float)
+    ap.add_argument("--calibration", help="JSON do urbano_capacity.py calibrate para estimar a memória")
+    ap.add_argument("--ue-net", default="7.0.0.0/8", help="rede dos UEs (filtra fluxos do EPC)")
+    ap.add_argument("--out", default="sweep-out")
+    args = ap.parse_args()
+    args.out = os.path.abspath(args.out)
+    urbano_runner.resolve(args)
+    args.model = urbano_capacity.Model(args.scenario, args.calibration) if args.calibration else None
+
+    fixed = [tuple(s.split("=", 1)) for s in args.set]
+    axes = []
+    for s in args.sweep:
+        name, values = s.split("=", 1)
+        axes.append([(name, v) for v in values.split(",")])
+    points = [tuple(fixed) + combo for combo in itertools.product(*axes)] if axes else [tuple(fixed)]
+
+    jobs = [Job(p, r, args) for p in points for r in range(1, args.runs + 1)]
+    t0 = time.monotonic()
+    run_jobs(jobs, args)
+    print("[SWEEP] tempo total: %.1f s" % (time.monotonic() - t0))
+
+    param_names = sorted({k for p in points for k, _ in p})
+    os.makedirs(args.out, exist_ok=True)
+    per_point = {}
+    with open(os.path.join(args.out, "runs.csv"), "w", newline="") as f:
+        w = csv.writer(f)
+        w.writerow(param_names + ["rngRun", "status"] + KPI_NAMES)
+        for j in jobs:
+            k = run_kpis(j, args) or {}
+            k["wall_s"] = j.wall_s
+            k["rss_mb"] = j.rss_mb
+            if j.status == 0 and "throughput_mbps" in k:
+                per_point.setdefault(j.point, []).append(k)
+            pd = dict(j.point)
+            w.writerow([pd.get(n, "") for n in param_names] + [j.run, j.status]
+                       + [k.get(n, "") for n in KPI_NAMES])
+
+    with open(os.path.join(args.out, "aggregate.csv"), "w", newline="") as f:
+        w = csv.writer(f)
+        header = param_names + ["n"]
+        for n in KPI_NAMES:
+            header += [n + "_mean", n + "_ci95"]
+        w.writerow(header)
+        for p in points:
+            runs = per_point.get(p, [])
+            row = [dict(p).get(n, "") for n in param_names] + [len(runs)]
+            for n in KPI_NAMES:
+                m, ci = mean_ci([r[n] for r in runs if not math.isnan(r[n])])
+                row += ["%.4f" % m, "%.4f" % ci]
+            w.writerow(row)
+            sys.stdout.write("[SWEEP] %s n=%d thr=%s Mb/s\n" % (point_name(p), len(runs), row[len(param_names) + 1]))
+
+    failed = [j for j in jobs if j.status != 0]
+    if failed:
+        print("[SWEEP] %d execuções falharam (ver stdout.log em cada diretório)" % len(failed))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
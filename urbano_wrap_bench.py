@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+# urbano_wrap_bench.py
+# Cenário inteiro com e sem wrap-around (urbano-wrap-around.h) no lte-urbano.
+#  Roda o toro de --sites sites (wrapAround=N) e grades planas (wrapAround=0)
+#  com a mesma densidade de UEs por setor (--ue-per-sector, padrão a do
+#  lte-urbano: 6300 UEs em 48 setores) e a área dos UEs cobrindo a grade. As
+#  grades padrão são 4x5 (os mesmos ~19 sites, com borda) e 8x8 (64 sites, o
+#  mais perto em RxC dos 61 sites de 19 + 2 anéis de guarda, a grade plana sem
+#  borda equivalente ao toro). Do profiler (lte-urbano-profile.json) lê o tempo
+#  real do processo inteiro, da montagem e do run, o pico de RSS e os eventos.
+#
+# Exemplo:
+#   python3 urbano_wrap_bench.py --ns3-dir ~/ns-3.40
+#   python3 urbano_wrap_bench.py --binary build/scratch/lte-urbano --sites 7 --flat-grids 3x3,5x5
+# Saída: wrap-bench.csv (uma linha por modo, menor tempo de --repeat).
+
+import argparse
+import csv
+import math
+import os
+import sys
+
+import urbano_runner
+
+SCENARIO = "lte-urbano"
+SETUP_PHASES = ["helpers/epc", "band init", "cell install", "ue install", "attach", "apps", "flowmon"]
+RUN_PHASES = ["warmup", "run"]
+
+
+def run_once(args, params):
+    run_dir = os.path.join(os.path.abspath(args.out), urbano_runner.run_name(params))
+    prof = urbano_runner.run_once(args, SCENARIO, params, run_dir)
+    if prof is None:
+        return None
+    return {
+        "wall_s": round(prof["total"]["wall_s"], 4),
+        "setup_s": round(urbano_runner.phase_sum(prof, SETUP_PHASES), 4),
+        "run_s": round(urbano_runner.phase_sum(prof, RUN_PHASES), 4),
+        "peak_rss_mb": prof["total"]["peak_rss_mb"],
+        "events": urbano_runner.phase_sum(prof, key="events"),
+    }
+
+
+def main():
+    ap = argparse.ArgumentParser(description="lte-urbano com wrap-around x grade plana: tempo real e pico de RSS")
+    urbano_runner.add_args(ap)
+    ap.add_argument("--sites", type=int, default=19, help="sites do toro (7, 19, 21, 37...)")
+    ap.add_argument("--flat-grids", default="4x5,8x8", help="grades planas RxC separadas por vírgula")
+    ap.add_argument("--ue-per-sector", type=float, default=6300 / 48.0)
+    ap.add_argument("--isd", type=float, default=600.0)
+    ap.add_argument("--set", action="append", default=[], metavar="PARAM=v", help="parâmetro fixo")
+    ap.add_argument("--repeat", type=int, default=1, help="repetições por ponto (usa o menor tempo)")
+    ap.add_argument("--out", default="wrap-bench-out")
+    args = ap.parse_args()
+    urbano_runner.resolve(args)
+
+    fixed = dict(s.split("=", 1) for s in args.set)
+    if fixed.get("shadowing") == "map":
+        ap.error("o mapa de sombreamento não combina com wrapAround (o cenário rejeita)")
+    fixed.setdefault("simTime", "2")
+    fixed["isd"] = args.isd
+
+    # (modo, sites, parâmetros)
+    points = [("torus", args.sites, {"wrapAround": args.sites})]
+    for g in args.flat_grids.split(","):
+        rows, cols = (int(x) for x in g.split("x"))
+        points.append(("flat-%s" % g, rows * cols, {
+            "wrapAround": 0,
+            "rows": rows,
+            "cols": cols,
+            # área cobrindo a grade (meio ISD de folga), como no urbano_setup_bench.py
+            "areaX": (cols + 0.5) * args.isd,
+            "areaY": max((rows - 1) * args.isd * math.sqrt(3) / 2, args.isd),
+        }))
+
+    rows_out = []
+    for mode, sites, extra in points:
+        params = dict(fixed)
+        params.update(extra)
+        params["ueCount"] = int(round(args.ue_per_sector * 3 * sites))
+        best = None
+        for _ in range(args.repeat):
+            r = run_once(args, params)
+            if r and (best is None or r["wall_s"] < best["wall_s"]):
+                best = r
+        if not best:
+            continue
+        row = {"mode": mode, "sites": sites, "sectors": 3 * sites, "ues": params["ueCount"]}
+        row.update(best)
+        rows_out.append(row)
+        print("[BENCH] %-10s %3d sites %6d UEs: total %.2f s (setup %.2f s, run %.2f s), pico RSS %.0f MB, %d eventos"
+              % (mode, sites, params["ueCount"], best["wall_s"], best["setup_s"], best["run_s"],
+                 best["peak_rss_mb"], best["events"]))
+
+    out = "wrap-bench.csv"
+    with open(out, "w", newline="") as f:
+        w = csv.DictWriter(f, fieldnames=["mode", "sites", "sectors", "ues", "wall_s", "setup_s", "run_s",
+                                          "peak_rss_mb", "events"])
+        w.writeheader()
+        w.writerows(rows_out)
+
+    # grades planas relativas ao toro
+    torus = next((r for r in rows_out if r["mode"] == "torus"), None)
+    for r in rows_out:
+        if torus and r is not torus and torus["wall_s"] > 0:
+            print("[BENCH] %s / toro: tempo total %.2fx, pico RSS %.2fx (%+.0f MB)"
+                  % (r["mode"], r["wall_s"] / torus["wall_s"],
+                     r["peak_rss_mb"] / torus["peak_rss_mb"] if torus["peak_rss_mb"] else 0,
+                     r["peak_rss_mb"] - torus["peak_rss_mb"]))
+    print("[BENCH] resultados em %s" % out)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())